@@ -4,6 +4,7 @@
 #include "ErrorHandler.h"
 #include "Stream.h"
 #include "GameStructs.h"
+#include "TexturePack.h"
 
 void ASyncRequest_Free(struct AsyncRequest* request) {
 	Mem_Free(&request->ResultData);
@@ -76,13 +77,15 @@ bool ManageCookies;
 bool KeepAlive;
 /* TODO: Connection pooling */
 
-static void AsyncDownloader_Add(String* url, bool priority, String* id, UInt8 type, DateTime* lastModified, String* etag, String* data) {
+static void AsyncDownloader_Add(String* url, bool priority, String* id, UInt8 type, DateTime* lastModified, String* etag, String* data, Int32 maxAge, bool cached) {
 	Mutex_Lock(async_pendingMutex);
 	{
 		struct AsyncRequest req = { 0 };
 		String reqUrl = String_FromEmptyArray(req.URL); String_Set(&reqUrl, url);
 		String reqID  = String_FromEmptyArray(req.ID);  String_Set(&reqID, id);
 		req.RequestType = type;
+		req.Cached      = cached;
+		req.MaxAge      = maxAge;
 
 		Platform_Log2("Adding %s (type %b)", &reqUrl, &type);
 
@@ -105,35 +108,52 @@ static void AsyncDownloader_Add(String* url, bool priority, String* id, UInt8 ty
 	Waitable_Signal(async_waitable);
 }
 
-void AsyncDownloader_GetSkin(STRING_PURE String* id, STRING_PURE String* skinName) {
-	UChar urlBuffer[String_BufferSize(STRING_SIZE)];
-	String url = String_InitAndClearArray(urlBuffer);
+/* Cache lookups use the texture cache's lists, which must only be accessed on the main thread */
+static void AsyncDownloader_AddCached(String* url, bool priority, String* id, UInt8 type) {
+	UInt8 etagBuffer[String_BufferSize(STRING_SIZE)];
+	String etag = String_InitAndClearArray(etagBuffer);
+	DateTime lastModified = { 0 };
+	Int32 maxAge = -1;
+
+	if (TextureCache_HasUrl(url)) {
+		TextureCache_GetLastModified(url, &lastModified);
+		TextureCache_GetETag(url, &etag);
+		maxAge = TextureCache_GetMaxAge(url);
+	}
+	AsyncDownloader_Add(url, priority, id, type, &lastModified, &etag, NULL, maxAge, true);
+}
 
+static void AsyncDownloader_MakeSkinUrl(STRING_TRANSIENT String* url, STRING_PURE String* skinName) {
 	if (Utils_IsUrlPrefix(skinName, 0)) {
-		String_Set(&url, skinName);
+		String_Set(url, skinName);
 	} else {
-		String_AppendString(&url, &async_skinServer);
-		String_AppendColorless(&url, skinName);
-		String_AppendConst(&url, ".png");
+		String_AppendString(url, &async_skinServer);
+		String_AppendColorless(url, skinName);
+		String_AppendConst(url, ".png");
 	}
+}
 
-	AsyncDownloader_Add(&url, false, id, REQUEST_TYPE_DATA, NULL, NULL, NULL);
+void AsyncDownloader_GetSkin(STRING_PURE String* id, STRING_PURE String* skinName) {
+	UChar urlBuffer[String_BufferSize(STRING_SIZE)];
+	String url = String_InitAndClearArray(urlBuffer);
+	AsyncDownloader_MakeSkinUrl(&url, skinName);
+	AsyncDownloader_AddCached(&url, false, id, REQUEST_TYPE_IMAGE);
 }
 
 void AsyncDownloader_GetData(STRING_PURE String* url, bool priority, STRING_PURE String* id) {
-	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_DATA, NULL, NULL, NULL);
+	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_DATA, NULL, NULL, NULL, -1, false);
 }
 
 void AsyncDownloader_GetContentLength(STRING_PURE String* url, bool priority, STRING_PURE String* id) {
-	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_CONTENT_LENGTH, NULL, NULL, NULL);
+	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_CONTENT_LENGTH, NULL, NULL, NULL, -1, false);
 }
 
 void AsyncDownloader_PostString(STRING_PURE String* url, bool priority, STRING_PURE String* id, STRING_PURE String* contents) {
-	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_DATA, NULL, NULL, contents);
+	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_DATA, NULL, NULL, contents, -1, false);
 }
 
 void AsyncDownloader_GetDataEx(STRING_PURE String* url, bool priority, STRING_PURE String* id, DateTime* lastModified, STRING_PURE String* etag) {
-	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_DATA, lastModified, etag, NULL);
+	AsyncDownloader_Add(url, priority, id, REQUEST_TYPE_DATA, lastModified, etag, NULL, -1, false);
 }
 
 void AsyncDownloader_PurgeOldEntriesTask(struct ScheduledTask* task) {
@@ -174,6 +194,18 @@ bool AsyncDownloader_Get(STRING_PURE String* id, struct AsyncRequest* item) {
 		if (success) AsyncRequestList_RemoveAt(&async_processed, i);
 	}
 	Mutex_Unlock(async_processedMutex);
+
+	/* Data itself was already written to the cache by the worker thread */
+	if (success && item->Cached && item->StatusCode == 200) {
+		String url  = String_FromRawArray(item->URL);
+		String etag = String_FromRawArray(item->Etag);
+		TextureCache_AddETag(&url, &etag);
+		TextureCache_AddLastModified(&url, &item->LastModified);
+	}
+	if (success && item->Cached && (item->StatusCode == 200 || item->StatusCode == 304)) {
+		String url = String_FromRawArray(item->URL);
+		TextureCache_AddMaxAge(&url, item->MaxAge);
+	}
 	return success;
 }
 
@@ -229,6 +261,92 @@ static void AsyncDownloader_ProcessRequest(struct AsyncRequest* request) {
 	request->ResultSize = size;
 }
 
+/* Cached data is served without contacting the server at all until it is older than its max-age, */
+/* or this many seconds when the server didn't give one */
+#define ASYNC_CACHE_DEFAULT_AGE (5 * 60)
+
+Int32 AsyncDownloader_ParseMaxAge(STRING_PURE String* cacheControl) {
+	String noCache = String_FromConst("no-cache");
+	String noStore = String_FromConst("no-store");
+	if (String_ContainsString(cacheControl, &noCache) || String_ContainsString(cacheControl, &noStore)) return 0;
+
+	String maxAge = String_FromConst("max-age=");
+	Int32 i = String_IndexOfString(cacheControl, &maxAge);
+	if (i == -1) return -1;
+
+	String value = String_UNSAFE_SubstringAt(cacheControl, i + maxAge.length);
+	Int32 end = String_IndexOf(&value, ',', 0);
+	if (end >= 0) value.length = end;
+	String_UNSAFE_TrimEnd(&value);
+
+	Int32 seconds;
+	return Convert_TryParseInt32(&value, &seconds) && seconds >= 0 ? seconds : -1;
+}
+
+static bool AsyncDownloader_ServeFresh(struct AsyncRequest* request) {
+	String url = String_FromRawArray(request->URL);
+	Int32 maxAge = request->MaxAge >= 0 ? request->MaxAge : ASYNC_CACHE_DEFAULT_AGE;
+	if (!TextureCache_IsFresh(&url, maxAge * 1000LL)) return false;
+
+	ReturnCode res = TextureCache_LoadData(&url, &request->ResultData, &request->ResultSize);
+	if (res) { Platform_Log2("Error %i when reading cache for %s", &res, &url); return false; }
+	/* Treated the same as the server replying that the data wasn't modified */
+	request->StatusCode = 304;
+	return true;
+}
+
+static void AsyncDownloader_UpdateCache(struct AsyncRequest* request) {
+	String url = String_FromRawArray(request->URL);
+	ReturnCode res;
+
+	if (request->ResultData) {
+		res = TextureCache_SaveData(&url, request->ResultData, request->ResultSize);
+		if (res) Platform_Log2("Error %i when caching %s", &res, &url);
+	} else if (request->StatusCode == 304 || request->StatusCode == 0) {
+		/* Not modified, or no network access - serve from the cache instead */
+		res = TextureCache_LoadData(&url, &request->ResultData, &request->ResultSize);
+		if (res && res != ReturnCode_FileNotFound) Platform_Log2("Error %i when reading cache for %s", &res, &url);
+
+		/* Server confirmed the data is still current, so rewrite it to make it fresh again */
+		if (!res && request->StatusCode == 304) {
+			res = TextureCache_SaveData(&url, request->ResultData, request->ResultSize);
+			if (res) Platform_Log2("Error %i when caching %s", &res, &url);
+		}
+	}
+}
+
+static void AsyncDownloader_DecodeImage(struct AsyncRequest* request) {
+	if (!request->ResultData) return;
+	request->DataHash = Utils_CRC32(request->ResultData, request->ResultSize);
+
+	struct Stream mem; struct Bitmap bmp;
+	Stream_ReadonlyMemory(&mem, request->ResultData, request->ResultSize);
+	request->ImageResult = Bitmap_DecodePng(&bmp, &mem);
+	if (request->ImageResult) { Mem_Free(&bmp.Scan0); return; }
+
+	request->ImageWidth  = bmp.Width;
+	request->ImageHeight = bmp.Height;
+	Bitmap_EnsurePow2(&bmp);
+
+	Mem_Free(&request->ResultData);
+	request->Image      = bmp;
+	request->ResultData = bmp.Scan0;
+	request->ResultSize = Bitmap_DataSize(bmp.Width, bmp.Height);
+}
+
+bool AsyncDownloader_GetCachedSkin(STRING_PURE String* skinName, struct AsyncRequest* item) {
+	Mem_Set(item, 0, sizeof(struct AsyncRequest));
+	String url = String_InitAndClearArray(item->URL);
+	AsyncDownloader_MakeSkinUrl(&url, skinName);
+	item->RequestType = REQUEST_TYPE_IMAGE;
+	item->Cached      = true;
+
+	ReturnCode res = TextureCache_LoadData(&url, &item->ResultData, &item->ResultSize);
+	if (res) return false;
+	AsyncDownloader_DecodeImage(item);
+	return true;
+}
+
 static void AsyncDownloader_CompleteResult(struct AsyncRequest* request) {
 	DateTime_CurrentUTC(&request->TimeDownloaded);
 	Mutex_Lock(async_processedMutex);
@@ -279,7 +397,14 @@ static void AsyncDownloader_WorkerFunc(void) {
 			Mutex_Unlock(async_curRequestMutex);
 
 			Platform_LogConst("Doing it");
-			AsyncDownloader_ProcessRequest(&request);
+			if (!request.Cached || !AsyncDownloader_ServeFresh(&request)) {
+				AsyncDownloader_ProcessRequest(&request);
+				if (request.Cached) AsyncDownloader_UpdateCache(&request);
+			}
+			/* decode here, so the main thread doesn't stall when lots of skins arrive at once */
+			if (request.RequestType == REQUEST_TYPE_IMAGE) {
+				AsyncDownloader_DecodeImage(&request);
+			}
 			AsyncDownloader_CompleteResult(&request);
 
 			Mutex_Lock(async_curRequestMutex);
@@ -320,8 +445,7 @@ static void AsyncDownloader_Reset(void) {
 static void AsyncDownloader_Free(void) {
 	async_terminate = true;
 	AsyncDownloader_Reset();
-	Thread_Join(async_workerThread);
-	Thread_FreeHandle(async_workerThread);
+	Thread_JoinAndFree(async_workerThread);
 
 	AsyncRequestList_Free(&async_pending);
 	AsyncRequestList_Free(&async_processed);
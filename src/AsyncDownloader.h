@@ -9,7 +9,8 @@
 struct IGameComponent;
 struct ScheduledTask;
 
-enum REQUEST_TYPE { REQUEST_TYPE_DATA, REQUEST_TYPE_CONTENT_LENGTH };
+/* REQUEST_TYPE_IMAGE downloads a PNG, which is then decoded on the worker thread. */
+enum REQUEST_TYPE { REQUEST_TYPE_DATA, REQUEST_TYPE_CONTENT_LENGTH, REQUEST_TYPE_IMAGE };
 enum ASYNC_PROGRESS {
 	ASYNC_PROGRESS_NOTHING = -3,
 	ASYNC_PROGRESS_MAKING_REQUEST = -2,
@@ -30,11 +31,22 @@ struct AsyncRequest {
 	DateTime LastModified;   /* Time item cached at (if at all) */
 	UInt8 Etag[String_BufferSize(STRING_SIZE)]; /* ETag of cached item (if any) */
 	UInt8 RequestType;
+	bool Cached; /* Whether the response is stored in and revalidated against the texture cache */
+	Int32 MaxAge; /* Seconds the response can be used for without revalidating, from Cache-Control (-1 if not given) */
+
+	/* Decoded image padded to power-of-2 size, for image requests. Its pixels are ResultData. */
+	struct Bitmap Image;
+	UInt16 ImageWidth, ImageHeight; /* Size of image before it was padded */
+	ReturnCode ImageResult;         /* Non-zero if decoding failed, in which case ResultData is the raw data */
+	UInt32 DataHash;                /* CRC32 of the downloaded data */
 };
 
 void ASyncRequest_Free(struct AsyncRequest* request);
 
 void AsyncDownloader_MakeComponent(struct IGameComponent* comp);
+/* The skin is kept in the texture cache. Cached skins are returned without contacting the server for as long as
+   Cache-Control: max-age allowed (or a few minutes if not given). Older skins are revalidated with a conditional
+   request, and are returned when the server replies with 304, or when the server can't be reached at all. */
 void AsyncDownloader_GetSkin(STRING_PURE String* id, STRING_PURE String* skinName);
 void AsyncDownloader_GetData(STRING_PURE String* url, bool priority, STRING_PURE String* id);
 void AsyncDownloader_GetContentLength(STRING_PURE String* url, bool priority, STRING_PURE String* id);
@@ -43,6 +55,11 @@ void AsyncDownloader_GetContentLength(STRING_PURE String* url, bool priority, ST
 void AsyncDownloader_GetDataEx(STRING_PURE String* url, bool priority, STRING_PURE String* id, DateTime* lastModified, STRING_PURE String* etag);
 
 bool AsyncDownloader_Get(STRING_PURE String* id, struct AsyncRequest* item);
+/* Loads and decodes the given skin from the texture cache only, without any network access. Returns false if
+   the skin isn't cached. Unlike AsyncDownloader_Get, item must be freed with ASyncRequest_Free afterwards. */
+bool AsyncDownloader_GetCachedSkin(STRING_PURE String* skinName, struct AsyncRequest* item);
 bool AsyncDownloader_GetCurrent(struct AsyncRequest* request, Int32* progress);
+/* Returns the max-age in seconds given by the value of a Cache-Control header, or -1 if not given. */
+Int32 AsyncDownloader_ParseMaxAge(STRING_PURE String* cacheControl);
 void AsyncDownloader_PurgeOldEntriesTask(struct ScheduledTask* task);
 #endif
@@ -428,8 +428,7 @@ static void Music_Free(void) {
 	Waitable_Signal(music_waitable);
 	if (music_out == -1) return;
 
-	Thread_Join(music_thread);
-	Thread_FreeHandle(music_thread);
+	Thread_JoinAndFree(music_thread);
 	Audio_Free(music_out);
 	music_out = -1;
 	music_thread = NULL;
@@ -35,6 +35,24 @@ void Bitmap_AllocateClearedPow2(struct Bitmap* bmp, Int32 width, Int32 height) {
 	bmp->Scan0 = Mem_AllocCleared(width * height, BITMAP_SIZEOF_PIXEL, "bitmap data");
 }
 
+void Bitmap_EnsurePow2(struct Bitmap* bmp) {
+	Int32 width  = Math_NextPowOf2(bmp->Width);
+	Int32 height = Math_NextPowOf2(bmp->Height);
+	if (width == bmp->Width && height == bmp->Height) return;
+
+	struct Bitmap scaled; Bitmap_Allocate(&scaled, width, height);
+	Int32 y;
+	UInt32 stride = (UInt32)(bmp->Width) * BITMAP_SIZEOF_PIXEL;
+	for (y = 0; y < bmp->Height; y++) {
+		UInt32* src = Bitmap_GetRow(bmp, y);
+		UInt32* dst = Bitmap_GetRow(&scaled, y);
+		Mem_Copy(dst, src, stride);
+	}
+
+	Mem_Free(&bmp->Scan0);
+	*bmp = scaled;
+}
+
 
 /*########################################################################################################################*
 *------------------------------------------------------PNG decoder--------------------------------------------------------*
@@ -19,6 +19,8 @@ void Bitmap_CopyBlock(Int32 srcX, Int32 srcY, Int32 dstX, Int32 dstY, struct Bit
 void Bitmap_Allocate(struct Bitmap* bmp, Int32 width, Int32 height);
 /* Allocates a power-of-2 sized bitmap larger or equal to to the given size, and clears it to 0. You are responsible for freeing its memory! */
 void Bitmap_AllocateClearedPow2(struct Bitmap* bmp, Int32 width, Int32 height);
+/* Copies the bitmap into the top left of a new power-of-2 sized bitmap, if it isn't already power-of-2 sized. */
+void Bitmap_EnsurePow2(struct Bitmap* bmp);
 
 bool Bitmap_DetectPng(UInt8* data, UInt32 len);
 /*
@@ -12,6 +12,8 @@
 #include "Game.h"
 #include "ErrorHandler.h"
 #include "Vectors.h"
+#include "Utils.h"
+#include "ServerConnection.h"
 
 /* Data for a resizable queue, used for liquid physic tick entries. */
 struct TickQueue {
@@ -87,35 +89,193 @@ PhysicsHandler Physics_OnDelete[BLOCK_COUNT];
 Random physics_rnd;
 Int32 physics_tickCount;
 Int32 physics_maxWaterX, physics_maxWaterY, physics_maxWaterZ;
-struct TickQueue physics_lavaQ, physics_waterQ;
 
-#define physics_tickMask 0xF8000000UL
-#define physics_posMask 0x07FFFFFFUL
-#define physics_tickShift 27
-#define physics_defLavaTick (30UL << physics_tickShift)
-#define physics_defWaterTick (5UL << physics_tickShift)
+/* Liquid ticks are kept in a timing wheel of queues, indexed by the liquid tick they are due on. */
+/* That way an item is only touched once it is due, instead of being cycled through a queue every tick. */
+/* NOTE: Wheel must be larger than the longest delay + 1, so that items never wrap around into the current slot. */
+#define PHYSICS_WHEEL_SIZE 64
+#define PHYSICS_WHEEL_MASK (PHYSICS_WHEEL_SIZE - 1)
+struct TickQueue physics_lavaQ[PHYSICS_WHEEL_SIZE], physics_waterQ[PHYSICS_WHEEL_SIZE];
+UInt32 physics_liquidTick;
+
+#define physics_lavaDelay 30
+#define physics_waterDelay 5
+
+/* Items are processed on the (delay + 1)th liquid tick after being scheduled */
+static void Physics_Schedule(struct TickQueue* wheel, Int32 index, UInt32 delay) {
+	TickQueue_Enqueue(&wheel[(physics_liquidTick + delay + 1) & PHYSICS_WHEEL_MASK], (UInt32)index);
+}
+
+/* When physics runs on its own thread, it works on its own copy of the map. That way the main thread can */
+/* keep reading World_Blocks (e.g. to build chunks) while physics runs, and physics never touches the lazily */
+/* calculated lighting heightmap. Changes are applied to World_Blocks on the main thread in Physics_Sync, and */
+/* changes made by the main thread are mirrored into the copy. Lighting for the copy is worked out from the copy. */
+BlockID* physics_blocks; /* World_Blocks, or the copy of it when physics runs on its own thread */
+BlockID* physics_copy;
+Int16* physics_lightHeights;
+#define Physics_GetBlock(x, y, z) physics_blocks[World_Pack(x, y, z)]
+
+/* Number of blocks in each chunk of the map that have a random tick handler */
+UInt16* physics_chunkTickables;
+/* Number of chunks with any such blocks in each layer of chunks. Random ticks for a chunk are picked from the */
+/* indices between its lowest and highest corner, which all lie within its layer of chunks. So when no chunk in */
+/* the layer has any such blocks, the random ticks for the whole layer are drawn without looking up any blocks. */
+/* (The random numbers are still drawn, so the same blocks get ticked as when every tick is looked up) */
+Int32* physics_liveChunks;
+Int32 physics_chunksX, physics_chunksZ;
+#define Physics_ChunkIndex(x, y, z) ((((y) >> CHUNK_SHIFT) * physics_chunksZ + ((z) >> CHUNK_SHIFT)) * physics_chunksX + ((x) >> CHUNK_SHIFT))
+
+static void Physics_CountChunks(void) {
+	Mem_Free(&physics_chunkTickables);
+	Mem_Free(&physics_liveChunks);
+	if (!World_Blocks) return;
+	physics_chunksX = (World_Width  + CHUNK_MAX) >> CHUNK_SHIFT;
+	physics_chunksZ = (World_Length + CHUNK_MAX) >> CHUNK_SHIFT;
+	Int32 chunksY   = (World_Height + CHUNK_MAX) >> CHUNK_SHIFT;
+	physics_chunkTickables = Mem_AllocCleared(physics_chunksX * chunksY * physics_chunksZ, sizeof(UInt16), "physics chunk counts");
+	physics_liveChunks = Mem_AllocCleared(chunksY, sizeof(Int32), "physics live chunks");
+
+	Int32 i = 0, x, y, z;
+	for (y = 0; y < World_Height; y++) {
+		for (z = 0; z < World_Length; z++) {
+			for (x = 0; x < World_Width; x++, i++) {
+				if (Physics_OnRandomTick[World_Blocks[i]]) physics_chunkTickables[Physics_ChunkIndex(x, y, z)]++;
+			}
+		}
+	}
+
+	Int32 chunksPerLayer = physics_chunksX * physics_chunksZ;
+	for (i = 0; i < chunksPerLayer * chunksY; i++) {
+		if (physics_chunkTickables[i]) physics_liveChunks[i / chunksPerLayer]++;
+	}
+}
+
+static void Physics_CountChange(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockID block) {
+	if (!physics_chunkTickables) return;
+	Int32 chunk = Physics_ChunkIndex(x, y, z);
+
+	if (Physics_OnRandomTick[oldBlock]) {
+		physics_chunkTickables[chunk]--;
+		if (!physics_chunkTickables[chunk]) physics_liveChunks[y >> CHUNK_SHIFT]--;
+	}
+	if (Physics_OnRandomTick[block]) {
+		if (!physics_chunkTickables[chunk]) physics_liveChunks[y >> CHUNK_SHIFT]++;
+		physics_chunkTickables[chunk]++;
+	}
+}
+
+void Physics_OnBlockChanged(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockID block) {
+	Physics_CountChange(x, y, z, oldBlock, block);
+	if (!physics_copy) return;
+	physics_copy[World_Pack(x, y, z)] = block;
+	physics_lightHeights[z * World_Width + x] = Int16_MaxValue;
+}
+
+/* Block changes made by the physics thread, which are applied on the main thread in Physics_Sync */
+struct PhysicsChange { Int32 Index; BlockID OldBlock, Block; };
+struct PhysicsChange* physics_changes;
+UInt32 physics_changesCount, physics_changesCapacity;
+bool physics_threadRunning;
+/* Scheduler state, see Physics_Update */
+Real64 physics_accumulator, physics_rateElapsed;
+Int32 physics_budgetMicros, physics_rateTicks, physics_asyncTicks;
+bool physics_async, physics_benchmarking;
+void* physics_thread;
+void* physics_asyncStart;
+void* physics_asyncDone;
+volatile bool physics_asyncQuit;
+/* Whether a block has changed since sponge checks for water were done, in a way that might change their results */
+bool physics_evalStale;
+
+static void Physics_UpdateBlock(Int32 x, Int32 y, Int32 z, BlockID block) {
+	Int32 index = World_Pack(x, y, z);
+	BlockID oldBlock = physics_blocks[index];
+	if (oldBlock == BLOCK_SPONGE || block == BLOCK_SPONGE || Block_Collide[block] == COLLIDE_GAS) physics_evalStale = true;
+
+	/* Benchmark map is not the real world, so the rest of the game must not be told about changes to it */
+	if (physics_benchmarking) { physics_blocks[index] = block; return; }
+	if (!physics_threadRunning) { Game_UpdateBlock(x, y, z, block); return; }
+
+	physics_copy[index] = block;
+	physics_lightHeights[z * World_Width + x] = Int16_MaxValue;
+	Physics_CountChange(x, y, z, oldBlock, block);
+
+	if (physics_changesCount == physics_changesCapacity) {
+		UInt32 capacity = max(256, physics_changesCapacity * 2);
+		if (physics_changes) {
+			physics_changes = Mem_Realloc(physics_changes, capacity, sizeof(struct PhysicsChange), "physics changes");
+		} else {
+			physics_changes = Mem_Alloc(capacity, sizeof(struct PhysicsChange), "physics changes");
+		}
+		physics_changesCapacity = capacity;
+	}
+
+	struct PhysicsChange* change = &physics_changes[physics_changesCount++];
+	change->Index = index; change->OldBlock = oldBlock; change->Block = block;
+}
+
+/* Same as Lighting_IsLit, but using the copy of the map when physics runs on its own thread */
+static bool Physics_IsLit(Int32 x, Int32 y, Int32 z) {
+	if (!physics_copy) return Lighting_IsLit(x, y, z);
+	Int32 i = z * World_Width + x, height = physics_lightHeights[i];
+	if (height != Int16_MaxValue) return y > height;
+
+	Int32 yy, index = World_Pack(x, World_MaxY, z);
+	height = -10;
+	for (yy = World_MaxY; yy >= 0; yy--, index -= World_OneY) {
+		BlockID block = physics_copy[index];
+		if (!Block_BlocksLight[block]) continue;
+		height = yy - ((Block_LightOffset[block] >> FACE_YMAX) & 1); break;
+	}
+	physics_lightHeights[i] = height;
+	return y > height;
+}
+
+static void Physics_FreeCopy(void) {
+	Mem_Free(&physics_copy);
+	Mem_Free(&physics_lightHeights);
+	physics_blocks = World_Blocks;
+}
+
+static void Physics_MakeCopy(void) {
+	physics_copy = Mem_Alloc(World_BlocksSize, sizeof(BlockID), "physics map copy");
+	Mem_Copy(physics_copy, World_Blocks, World_BlocksSize * sizeof(BlockID));
+	physics_blocks = physics_copy;
+
+	Int32 i, columns = World_Width * World_Length;
+	physics_lightHeights = Mem_Alloc(columns, sizeof(Int16), "physics light heights");
+	for (i = 0; i < columns; i++) { physics_lightHeights[i] = Int16_MaxValue; }
+}
 
 static void Physics_OnNewMapLoaded(void* obj) {
-	TickQueue_Clear(&physics_lavaQ);
-	TickQueue_Clear(&physics_waterQ);
+	Physics_Sync();
+	Int32 i;
+	for (i = 0; i < PHYSICS_WHEEL_SIZE; i++) {
+		TickQueue_Clear(&physics_lavaQ[i]);
+		TickQueue_Clear(&physics_waterQ[i]);
+	}
+	Physics_CountChunks();
+	Physics_FreeCopy();
+	if (physics_async && World_Blocks && ServerConnection_IsSinglePlayer) Physics_MakeCopy();
 
 	physics_maxWaterX = World_MaxX - 2;
 	physics_maxWaterY = World_MaxY - 2;
 	physics_maxWaterZ = World_MaxZ - 2;
 
 	Tree_Width = World_Width; Tree_Height = World_Height; Tree_Length = World_Length;
-	Tree_Blocks = World_Blocks;
+	Tree_Blocks = physics_blocks;
 	Random_InitFromCurrentTime(&physics_rnd);
 	Tree_Rnd = &physics_rnd;
 }
 
 void Physics_SetEnabled(bool enabled) {
+	Physics_Sync();
 	Physics_Enabled = enabled;
 	Physics_OnNewMapLoaded(NULL);
 }
 
 static void Physics_Activate(Int32 index) {
-	BlockID block = World_Blocks[index];
+	BlockID block = physics_blocks[index];
 	PhysicsHandler activate = Physics_OnActivate[block];
 	if (activate) activate(index, block);
 }
@@ -140,11 +300,12 @@ static bool Physics_IsEdgeWater(Int32 x, Int32 y, Int32 z) {
 
 static void Physics_BlockChanged(void* obj, Vector3I p, BlockID oldBlock, BlockID block) {
 	if (!Physics_Enabled) return;
+	Physics_Sync();
 	Int32 index = World_Pack(p.X, p.Y, p.Z);
 
 	if (block == BLOCK_AIR && Physics_IsEdgeWater(p.X, p.Y, p.Z)) {
 		block = BLOCK_STILL_WATER;
-		Game_UpdateBlock(p.X, p.Y, p.Z, BLOCK_STILL_WATER);
+		Physics_UpdateBlock(p.X, p.Y, p.Z, BLOCK_STILL_WATER);
 	}
 
 	if (block == BLOCK_AIR) {
@@ -161,6 +322,8 @@ static void Physics_TickRandomBlocks(void) {
 	Int32 x, y, z;
 	for (y = 0; y < World_Height; y += CHUNK_SIZE) {
 		Int32 y2 = min(y + CHUNK_MAX, World_MaxY);
+		bool live = physics_liveChunks[y >> CHUNK_SHIFT] != 0;
+
 		for (z = 0; z < World_Length; z += CHUNK_SIZE) {
 			Int32 z2 = min(z + CHUNK_MAX, World_MaxZ);
 			for (x = 0; x < World_Width; x += CHUNK_SIZE) {
@@ -170,19 +333,25 @@ static void Physics_TickRandomBlocks(void) {
 
 				/* Inlined 3 random ticks for this chunk */
 				Int32 index = Random_Range(&physics_rnd, lo, hi);
-				BlockID block = World_Blocks[index];
-				PhysicsHandler tick = Physics_OnRandomTick[block];
-				if (tick) tick(index, block);
+				if (live) {
+					BlockID block = physics_blocks[index];
+					PhysicsHandler tick = Physics_OnRandomTick[block];
+					if (tick) tick(index, block);
+				}
 
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World_Blocks[index];
-				tick = Physics_OnRandomTick[block];
-				if (tick) tick(index, block);
+				if (live) {
+					BlockID block = physics_blocks[index];
+					PhysicsHandler tick = Physics_OnRandomTick[block];
+					if (tick) tick(index, block);
+				}
 
 				index = Random_Range(&physics_rnd, lo, hi);
-				block = World_Blocks[index];
-				tick = Physics_OnRandomTick[block];
-				if (tick) tick(index, block);
+				if (live) {
+					BlockID block = physics_blocks[index];
+					PhysicsHandler tick = Physics_OnRandomTick[block];
+					if (tick) tick(index, block);
+				}
 			}
 		}
 	}
@@ -194,7 +363,7 @@ static void Physics_DoFalling(Int32 index, BlockID block) {
 	/* Find lowest block can fall into */
 	while (index >= World_OneY) {
 		index -= World_OneY;
-		BlockID other = World_Blocks[index];
+		BlockID other = physics_blocks[index];
 		if (other == BLOCK_AIR || (other >= BLOCK_WATER && other <= BLOCK_STILL_LAVA))
 			found = index;
 		else
@@ -204,38 +373,24 @@ static void Physics_DoFalling(Int32 index, BlockID block) {
 
 	Int32 x, y, z;
 	World_Unpack(found, x, y, z);
-	Game_UpdateBlock(x, y, z, block);
+	Physics_UpdateBlock(x, y, z, block);
 
 	World_Unpack(start, x, y, z);
-	Game_UpdateBlock(x, y, z, BLOCK_AIR);
+	Physics_UpdateBlock(x, y, z, BLOCK_AIR);
 	Physics_ActivateNeighbours(x, y, z, start);
 }
 
-static bool Physics_CheckItem(struct TickQueue* queue, Int32* posIndex) {
-	UInt32 packed = TickQueue_Dequeue(queue);
-	Int32 tickDelay = (Int32)((packed & physics_tickMask) >> physics_tickShift);
-	*posIndex = (Int32)(packed & physics_posMask);
-
-	if (tickDelay > 0) {
-		tickDelay--;
-		UInt32 item = (UInt32)(*posIndex) | ((UInt32)tickDelay << physics_tickShift);
-		TickQueue_Enqueue(queue, item);
-		return false;
-	}
-	return true;
-}
-
 
 static void Physics_HandleSapling(Int32 index, BlockID block) {
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
 
 	BlockID below = BLOCK_AIR;
-	if (y > 0) below = World_Blocks[index - World_OneY];
+	if (y > 0) below = physics_blocks[index - World_OneY];
 	if (below != BLOCK_GRASS) return;
 
 	Int32 treeHeight = 5 + Random_Next(&physics_rnd, 3);
-	Game_UpdateBlock(x, y, z, BLOCK_AIR);
+	Physics_UpdateBlock(x, y, z, BLOCK_AIR);
 
 	if (TreeGen_CanGrow(x, y, z, treeHeight)) {
 		Vector3I coords[Tree_BufferCount];
@@ -244,10 +399,10 @@ static void Physics_HandleSapling(Int32 index, BlockID block) {
 
 		Int32 m;
 		for (m = 0; m < count; m++) {
-			Game_UpdateBlock(coords[m].X, coords[m].Y, coords[m].Z, blocks[m]);
+			Physics_UpdateBlock(coords[m].X, coords[m].Y, coords[m].Z, blocks[m]);
 		}
 	} else {
-		Game_UpdateBlock(x, y, z, BLOCK_SAPLING);
+		Physics_UpdateBlock(x, y, z, BLOCK_SAPLING);
 	}
 }
 
@@ -255,8 +410,8 @@ static void Physics_HandleDirt(Int32 index, BlockID block) {
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
 
-	if (Lighting_IsLit(x, y, z)) {
-		Game_UpdateBlock(x, y, z, BLOCK_GRASS);
+	if (Physics_IsLit(x, y, z)) {
+		Physics_UpdateBlock(x, y, z, BLOCK_GRASS);
 	}
 }
 
@@ -264,8 +419,8 @@ static void Physics_HandleGrass(Int32 index, BlockID block) {
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
 
-	if (!Lighting_IsLit(x, y, z)) {
-		Game_UpdateBlock(x, y, z, BLOCK_DIRT);
+	if (!Physics_IsLit(x, y, z)) {
+		Physics_UpdateBlock(x, y, z, BLOCK_DIRT);
 	}
 }
 
@@ -273,16 +428,16 @@ static void Physics_HandleFlower(Int32 index, BlockID block) {
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
 
-	if (!Lighting_IsLit(x, y, z)) {
-		Game_UpdateBlock(x, y, z, BLOCK_AIR);
+	if (!Physics_IsLit(x, y, z)) {
+		Physics_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
 		return;
 	}
 
 	BlockID below = BLOCK_DIRT;
-	if (y > 0) below = World_Blocks[index - World_OneY];
+	if (y > 0) below = physics_blocks[index - World_OneY];
 	if (!(below == BLOCK_DIRT || below == BLOCK_GRASS)) {
-		Game_UpdateBlock(x, y, z, BLOCK_AIR);
+		Physics_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
 	}
 }
@@ -291,32 +446,32 @@ static void Physics_HandleMushroom(Int32 index, BlockID block) {
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
 
-	if (Lighting_IsLit(x, y, z)) {
-		Game_UpdateBlock(x, y, z, BLOCK_AIR);
+	if (Physics_IsLit(x, y, z)) {
+		Physics_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
 		return;
 	}
 
 	BlockID below = BLOCK_STONE;
-	if (y > 0) below = World_Blocks[index - World_OneY];
+	if (y > 0) below = physics_blocks[index - World_OneY];
 	if (!(below == BLOCK_STONE || below == BLOCK_COBBLE)) {
-		Game_UpdateBlock(x, y, z, BLOCK_AIR);
+		Physics_UpdateBlock(x, y, z, BLOCK_AIR);
 		Physics_ActivateNeighbours(x, y, z, index);
 	}
 }
 
 
 static void Physics_PlaceLava(Int32 index, BlockID block) {
-	TickQueue_Enqueue(&physics_lavaQ, physics_defLavaTick | (UInt32)index);
+	Physics_Schedule(physics_lavaQ, index, physics_lavaDelay);
 }
 
 static void Physics_PropagateLava(Int32 posIndex, Int32 x, Int32 y, Int32 z) {
-	BlockID block = World_Blocks[posIndex];
+	BlockID block = physics_blocks[posIndex];
 	if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
-		Game_UpdateBlock(x, y, z, BLOCK_STONE);
+		Physics_UpdateBlock(x, y, z, BLOCK_STONE);
 	} else if (Block_Collide[block] == COLLIDE_GAS) {
-		TickQueue_Enqueue(&physics_lavaQ, physics_defLavaTick | (UInt32)posIndex);
-		Game_UpdateBlock(x, y, z, BLOCK_LAVA);
+		Physics_Schedule(physics_lavaQ, posIndex, physics_lavaDelay);
+		Physics_UpdateBlock(x, y, z, BLOCK_LAVA);
 	}
 }
 
@@ -332,61 +487,219 @@ static void Physics_ActivateLava(Int32 index, BlockID block) {
 }
 
 static void Physics_TickLava(void) {
-	Int32 i, count = physics_lavaQ.Size;
+	struct TickQueue* queue = &physics_lavaQ[physics_liquidTick & PHYSICS_WHEEL_MASK];
+	Int32 i, count = queue->Size;
 	for (i = 0; i < count; i++) {
-		Int32 index;
-		if (Physics_CheckItem(&physics_lavaQ, &index)) {
-			BlockID block = World_Blocks[index];
-			if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
-			Physics_ActivateLava(index, block);
-		}
+		Int32 index = (Int32)TickQueue_Dequeue(queue);
+		BlockID block = physics_blocks[index];
+		if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
+		Physics_ActivateLava(index, block);
 	}
 }
 
 
 static void Physics_PlaceWater(Int32 index, BlockID block) {
-	TickQueue_Enqueue(&physics_waterQ, physics_defWaterTick | (UInt32)index);
+	Physics_Schedule(physics_waterQ, index, physics_waterDelay);
 }
 
-static void Physics_PropagateWater(Int32 posIndex, Int32 x, Int32 y, Int32 z) {
-	BlockID block = World_Blocks[posIndex];
-	if (block == BLOCK_LAVA || block == BLOCK_STILL_LAVA) {
-		Game_UpdateBlock(x, y, z, BLOCK_STONE);
-	} else if (Block_Collide[block] == COLLIDE_GAS && block != BLOCK_ROPE) {
-		/* Sponge check */
-		Int32 xx, yy, zz;
-		for (yy = (y < 2 ? 0 : y - 2); yy <= (y > physics_maxWaterY ? World_MaxY : y + 2); yy++) {
-			for (zz = (z < 2 ? 0 : z - 2); zz <= (z > physics_maxWaterZ ? World_MaxZ : z + 2); zz++) {
-				for (xx = (x < 2 ? 0 : x - 2); xx <= (x > physics_maxWaterX ? World_MaxX : x + 2); xx++) {
-					block = World_GetBlock(xx, yy, zz);
-					if (block == BLOCK_SPONGE) return;
-				}
+static bool Physics_SpongeNear(Int32 x, Int32 y, Int32 z) {
+	Int32 xx, yy, zz;
+	for (yy = (y < 2 ? 0 : y - 2); yy <= (y > physics_maxWaterY ? World_MaxY : y + 2); yy++) {
+		for (zz = (z < 2 ? 0 : z - 2); zz <= (z > physics_maxWaterZ ? World_MaxZ : z + 2); zz++) {
+			for (xx = (x < 2 ? 0 : x - 2); xx <= (x > physics_maxWaterX ? World_MaxX : x + 2); xx++) {
+				if (Physics_GetBlock(xx, yy, zz) == BLOCK_SPONGE) return true;
 			}
 		}
+	}
+	return false;
+}
 
-		TickQueue_Enqueue(&physics_waterQ, physics_defWaterTick | (UInt32)posIndex);
-		Game_UpdateBlock(x, y, z, BLOCK_WATER);
+#define Physics_CanFlowWater(block) (Block_Collide[block] == COLLIDE_GAS && block != BLOCK_ROPE)
+#define Physics_CheckSponge(posIndex, x, y, z, bit) \
+if (Physics_CanFlowWater(physics_blocks[posIndex]) && Physics_SpongeNear(x, y, z)) sponged |= bit;
+
+/* Returns bitmask of which neighbours water can't flow into due to a nearby sponge. */
+/* Only reads the world, so is safe to call from multiple threads at once. */
+static UInt8 Physics_CheckWaterSponges(Int32 index) {
+	Int32 x, y, z;
+	World_Unpack(index, x, y, z);
+	UInt8 sponged = 0;
+
+	if (x > 0)          { Physics_CheckSponge(index - 1,           x - 1, y,     z,     0x01); }
+	if (x < World_MaxX) { Physics_CheckSponge(index + 1,           x + 1, y,     z,     0x02); }
+	if (z > 0)          { Physics_CheckSponge(index - World_Width, x,     y,     z - 1, 0x04); }
+	if (z < World_MaxZ) { Physics_CheckSponge(index + World_Width, x,     y,     z + 1, 0x08); }
+	if (y > 0)          { Physics_CheckSponge(index - World_OneY,  x,     y - 1, z,     0x10); }
+	return sponged;
+}
+
+static void Physics_PropagateWater(Int32 posIndex, Int32 x, Int32 y, Int32 z, bool sponged) {
+	BlockID block = physics_blocks[posIndex];
+	if (block == BLOCK_LAVA || block == BLOCK_STILL_LAVA) {
+		Physics_UpdateBlock(x, y, z, BLOCK_STONE);
+	} else if (Physics_CanFlowWater(block) && !sponged) {
+		Physics_Schedule(physics_waterQ, posIndex, physics_waterDelay);
+		Physics_UpdateBlock(x, y, z, BLOCK_WATER);
 	}
 }
 
-static void Physics_ActivateWater(Int32 index, BlockID block) {
+static void Physics_SpreadWater(Int32 index, UInt8 sponged) {
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
 
-	if (x > 0)          Physics_PropagateWater(index - 1,           x - 1, y,     z);
-	if (x < World_MaxX) Physics_PropagateWater(index + 1,           x + 1, y,     z);
-	if (z > 0)          Physics_PropagateWater(index - World_Width, x,     y,     z - 1);
-	if (z < World_MaxZ) Physics_PropagateWater(index + World_Width, x,     y,     z + 1);
-	if (y > 0)          Physics_PropagateWater(index - World_OneY,  x,     y - 1, z);
+	if (x > 0)          Physics_PropagateWater(index - 1,           x - 1, y,     z,     sponged & 0x01);
+	if (x < World_MaxX) Physics_PropagateWater(index + 1,           x + 1, y,     z,     sponged & 0x02);
+	if (z > 0)          Physics_PropagateWater(index - World_Width, x,     y,     z - 1, sponged & 0x04);
+	if (z < World_MaxZ) Physics_PropagateWater(index + World_Width, x,     y,     z + 1, sponged & 0x08);
+	if (y > 0)          Physics_PropagateWater(index - World_OneY,  x,     y - 1, z,     sponged & 0x10);
+}
+
+static void Physics_ActivateWater(Int32 index, BlockID block) {
+	Physics_SpreadWater(index, Physics_CheckWaterSponges(index));
+}
+
+/* Sponge checks are the bulk of the cost of spreading water. For large floods, they are done up front by */
+/* a pool of worker threads, then water is spread on the main thread in the usual queue order. Items are */
+/* sorted by region of the map (16 block thick slabs of chunks), so each thread mostly reads nearby blocks. */
+/* Liquid ticks can only turn blocks into water, lava or stone, which never makes a check give a different */
+/* result. But if a block does change in a way that could (see Physics_UpdateBlock), the remaining water */
+/* in that tick is checked again on the main thread. So the world always ends up identical to serial ticks. */
+#define PHYSICS_MAX_THREADS 4
+#define PHYSICS_PARALLEL_MIN 2048
+#define PHYSICS_UNCHECKED 0xFF
+Int32 physics_threads;
+struct TickQueue* physics_evalQueue;
+UInt8* physics_sponged;     /* Sponge check result for each item, by position in the queue */
+UInt32* physics_evalOrder;  /* Positions in the queue of each item, sorted by region */
+UInt32 physics_evalCapacity, physics_evalCount;
+Int32* physics_regionStarts;
+Int32 physics_regionsCapacity;
+void* physics_workers[PHYSICS_MAX_THREADS];
+void* physics_workStart[PHYSICS_MAX_THREADS];
+void* physics_workDone[PHYSICS_MAX_THREADS];
+volatile bool physics_workersQuit;
+
+static Int32 Physics_Region(Int32 index, Int32 chunksZ) {
+	Int32 row = index / World_Width, y = row / World_Length, z = row - y * World_Length;
+	return (y >> CHUNK_SHIFT) * chunksZ + (z >> CHUNK_SHIFT);
+}
+
+static void Physics_SortByRegion(struct TickQueue* queue) {
+	Int32 chunksZ = (World_Length + CHUNK_MAX) >> CHUNK_SHIFT;
+	Int32 regions = ((World_Height + CHUNK_MAX) >> CHUNK_SHIFT) * chunksZ;
+	if (regions + 1 > physics_regionsCapacity) {
+		Mem_Free(&physics_regionStarts);
+		physics_regionsCapacity = regions + 1;
+		physics_regionStarts = Mem_Alloc(physics_regionsCapacity, sizeof(Int32), "physics regions");
+	}
+	Int32* starts = physics_regionStarts;
+	Mem_Set(starts, 0, (regions + 1) * sizeof(Int32));
+
+	UInt32 i;
+	for (i = 0; i < physics_evalCount; i++) {
+		Int32 index = (Int32)queue->Buffer[(queue->Head + i) & queue->BufferMask];
+		starts[Physics_Region(index, chunksZ) + 1]++;
+	}
+
+	Int32 r;
+	for (r = 1; r <= regions; r++) { starts[r] += starts[r - 1]; }
+	for (i = 0; i < physics_evalCount; i++) {
+		Int32 index = (Int32)queue->Buffer[(queue->Head + i) & queue->BufferMask];
+		physics_evalOrder[starts[Physics_Region(index, chunksZ)]++] = i;
+	}
+}
+
+static void Physics_EvalSlice(Int32 slice) {
+	struct TickQueue* queue = physics_evalQueue;
+	UInt32 i = physics_evalCount * slice / physics_threads;
+	UInt32 end = physics_evalCount * (slice + 1) / physics_threads;
+
+	for (; i < end; i++) {
+		UInt32 pos = physics_evalOrder[i];
+		Int32 index = (Int32)queue->Buffer[(queue->Head + pos) & queue->BufferMask];
+		BlockID block = physics_blocks[index];
+		/* Water might still flow into here earlier in the tick */
+		if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) {
+			physics_sponged[pos] = PHYSICS_UNCHECKED; continue;
+		}
+		physics_sponged[pos] = Physics_CheckWaterSponges(index);
+	}
+}
+
+/* Workers stay alive between ticks, and just wait until there are sponge checks to do */
+static void Physics_EvalWorker(Int32 slice) {
+	for (;;) {
+		Waitable_Wait(physics_workStart[slice]);
+		if (physics_workersQuit) return;
+		Physics_EvalSlice(slice);
+		Waitable_Signal(physics_workDone[slice]);
+	}
+}
+
+static void Physics_EvalWorker1(void) { Physics_EvalWorker(1); }
+static void Physics_EvalWorker2(void) { Physics_EvalWorker(2); }
+static void Physics_EvalWorker3(void) { Physics_EvalWorker(3); }
+Thread_StartFunc* physics_evalWorkers[PHYSICS_MAX_THREADS] = {
+	NULL, Physics_EvalWorker1, Physics_EvalWorker2, Physics_EvalWorker3,
+};
+
+static void Physics_StopWorkers(void) {
+	Int32 i;
+	physics_workersQuit = true;
+	for (i = 1; i < PHYSICS_MAX_THREADS; i++) {
+		if (!physics_workers[i]) continue;
+		Waitable_Signal(physics_workStart[i]);
+		Thread_JoinAndFree(physics_workers[i]);
+
+		Waitable_Free(physics_workStart[i]);
+		Waitable_Free(physics_workDone[i]);
+		physics_workers[i] = NULL;
+	}
+	physics_workersQuit = false;
+}
+
+static void Physics_EvalWater(struct TickQueue* queue) {
+	if (queue->Size > physics_evalCapacity) {
+		Mem_Free(&physics_sponged);
+		Mem_Free(&physics_evalOrder);
+		physics_evalCapacity = queue->BufferSize;
+		physics_sponged   = Mem_Alloc(physics_evalCapacity, sizeof(UInt8),  "physics sponge checks");
+		physics_evalOrder = Mem_Alloc(physics_evalCapacity, sizeof(UInt32), "physics sponge order");
+	}
+	physics_evalQueue = queue;
+	physics_evalCount = queue->Size;
+	physics_evalStale = false;
+	Physics_SortByRegion(queue);
+
+	Int32 i;
+	for (i = 1; i < physics_threads; i++) {
+		if (!physics_workers[i]) {
+			physics_workStart[i] = Waitable_Create();
+			physics_workDone[i]  = Waitable_Create();
+			physics_workers[i]   = Thread_Start(physics_evalWorkers[i]);
+		}
+		Waitable_Signal(physics_workStart[i]);
+	}
+	Physics_EvalSlice(0);
+	for (i = 1; i < physics_threads; i++) {
+		Waitable_Wait(physics_workDone[i]);
+	}
 }
 
 static void Physics_TickWater(void) {
-	Int32 i, count = physics_waterQ.Size;
+	struct TickQueue* queue = &physics_waterQ[physics_liquidTick & PHYSICS_WHEEL_MASK];
+	Int32 i, count = queue->Size;
+	bool parallel = physics_threads > 1 && count >= PHYSICS_PARALLEL_MIN;
+	if (parallel) Physics_EvalWater(queue);
+
 	for (i = 0; i < count; i++) {
-		Int32 index;
-		if (Physics_CheckItem(&physics_waterQ, &index)) {
-			BlockID block = World_Blocks[index];
-			if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
+		Int32 index = (Int32)TickQueue_Dequeue(queue);
+		BlockID block = physics_blocks[index];
+		if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
+
+		if (parallel && !physics_evalStale && physics_sponged[i] != PHYSICS_UNCHECKED) {
+			Physics_SpreadWater(index, physics_sponged[i]);
+		} else {
 			Physics_ActivateWater(index, block);
 		}
 	}
@@ -402,9 +715,9 @@ static void Physics_PlaceSponge(Int32 index, BlockID block) {
 		for (zz = z - 2; zz <= z + 2; zz++) {
 			for (xx = x - 2; xx <= x + 2; xx++) {
 				if (!World_IsValidPos(xx, yy, zz)) continue;
-				block = World_GetBlock(xx, yy, zz);
+				block = Physics_GetBlock(xx, yy, zz);
 				if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
-					Game_UpdateBlock(xx, yy, zz, BLOCK_AIR);
+					Physics_UpdateBlock(xx, yy, zz, BLOCK_AIR);
 				}
 			}
 		}
@@ -423,10 +736,9 @@ static void Physics_DeleteSponge(Int32 index, BlockID block) {
 					if (!World_IsValidPos(xx, yy, zz)) continue;
 
 					index = World_Pack(xx, yy, zz);
-					block = World_Blocks[index];
+					block = physics_blocks[index];
 					if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
-						UInt32 item = (1UL << physics_tickShift) | (UInt32)index;
-						TickQueue_Enqueue(&physics_waterQ, item);
+						Physics_Schedule(physics_waterQ, index, 1);
 					}
 				}
 			}
@@ -437,22 +749,22 @@ static void Physics_DeleteSponge(Int32 index, BlockID block) {
 
 static void Physics_HandleSlab(Int32 index, BlockID block) {
 	if (index < World_OneY) return;
-	if (World_Blocks[index - World_OneY] != BLOCK_SLAB) return;
+	if (physics_blocks[index - World_OneY] != BLOCK_SLAB) return;
 
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
-	Game_UpdateBlock(x, y, z, BLOCK_AIR);
-	Game_UpdateBlock(x, y - 1, z, BLOCK_DOUBLE_SLAB);
+	Physics_UpdateBlock(x, y, z, BLOCK_AIR);
+	Physics_UpdateBlock(x, y - 1, z, BLOCK_DOUBLE_SLAB);
 }
 
 static void Physics_HandleCobblestoneSlab(Int32 index, BlockID block) {
 	if (index < World_OneY) return;
-	if (World_Blocks[index - World_OneY] != BLOCK_COBBLE_SLAB) return;
+	if (physics_blocks[index - World_OneY] != BLOCK_COBBLE_SLAB) return;
 
 	Int32 x, y, z;
 	World_Unpack(index, x, y, z);
-	Game_UpdateBlock(x, y, z, BLOCK_AIR);
-	Game_UpdateBlock(x, y - 1, z, BLOCK_COBBLE);
+	Physics_UpdateBlock(x, y, z, BLOCK_AIR);
+	Physics_UpdateBlock(x, y - 1, z, BLOCK_COBBLE);
 }
 
 
@@ -463,7 +775,7 @@ UInt8 physics_blocksTnt[BLOCK_CPE_COUNT] = {
 };
 
 static void Physics_Explode(Int32 x, Int32 y, Int32 z, Int32 power) {
-	Game_UpdateBlock(x, y, z, BLOCK_AIR);
+	Physics_UpdateBlock(x, y, z, BLOCK_AIR);
 	Int32 index = World_Pack(x, y, z);
 	Physics_ActivateNeighbours(x, y, z, index);
 
@@ -478,10 +790,10 @@ static void Physics_Explode(Int32 x, Int32 y, Int32 z, Int32 power) {
 				if (!World_IsValidPos(xx, yy, zz)) continue;
 				index = World_Pack(xx, yy, zz);
 
-				BlockID block = World_Blocks[index];
+				BlockID block = physics_blocks[index];
 				if (block < BLOCK_CPE_COUNT && physics_blocksTnt[block]) continue;
 
-				Game_UpdateBlock(xx, yy, zz, BLOCK_AIR);
+				Physics_UpdateBlock(xx, yy, zz, BLOCK_AIR);
 				Physics_ActivateNeighbours(xx, yy, zz, index);
 			}
 		}
@@ -498,8 +810,14 @@ void Physics_Init(void) {
 	Event_RegisterVoid(&WorldEvents_MapLoaded,    NULL, Physics_OnNewMapLoaded);
 	Event_RegisterBlock(&UserEvents_BlockChanged, NULL, Physics_BlockChanged);
 	Physics_Enabled = Options_GetBool(OPT_BLOCK_PHYSICS, true);
-	TickQueue_Init(&physics_lavaQ);
-	TickQueue_Init(&physics_waterQ);
+	physics_threads = Options_GetInt(OPT_PHYSICS_THREADS, 1, PHYSICS_MAX_THREADS, 2);
+	physics_budgetMicros = Options_GetInt(OPT_PHYSICS_BUDGET, 1, 100, 5) * 1000;
+	physics_async = Options_GetBool(OPT_PHYSICS_ASYNC, false);
+	Int32 i;
+	for (i = 0; i < PHYSICS_WHEEL_SIZE; i++) {
+		TickQueue_Init(&physics_lavaQ[i]);
+		TickQueue_Init(&physics_waterQ[i]);
+	}
 
 	Physics_OnPlace[BLOCK_SAND]        = Physics_DoFalling;
 	Physics_OnPlace[BLOCK_GRAVEL]      = Physics_DoFalling;
@@ -538,18 +856,250 @@ void Physics_Init(void) {
 	Physics_OnPlace[BLOCK_TNT]         = Physics_HandleTnt;
 }
 
+static void Physics_StopAsync(void) {
+	if (!physics_thread) return;
+	physics_asyncQuit = true;
+	Waitable_Signal(physics_asyncStart);
+	Thread_JoinAndFree(physics_thread);
+
+	Waitable_Free(physics_asyncStart);
+	Waitable_Free(physics_asyncDone);
+	physics_thread    = NULL;
+	physics_asyncQuit = false;
+}
+
 void Physics_Free(void) {
+	Physics_Sync();
+	Physics_StopAsync();
+	Physics_FreeCopy();
 	Event_UnregisterVoid(&WorldEvents_MapLoaded,    NULL, Physics_OnNewMapLoaded);
 	Event_UnregisterBlock(&UserEvents_BlockChanged, NULL, Physics_BlockChanged);
+	Mem_Free(&physics_chunkTickables);
+	Mem_Free(&physics_liveChunks);
+	Mem_Free(&physics_changes);
+	physics_changesCapacity = 0;
+	Physics_StopWorkers();
+	Mem_Free(&physics_sponged);
+	Mem_Free(&physics_evalOrder);
+	Mem_Free(&physics_regionStarts);
+	physics_evalCapacity = 0; physics_regionsCapacity = 0;
 }
 
 void Physics_Tick(void) {
 	if (!Physics_Enabled || !World_Blocks) return;
 
 	/*if ((tickCount % 5) == 0) {*/
+	physics_liquidTick++;
 	Physics_TickLava();
 	Physics_TickWater();
 	/*}*/
 	physics_tickCount++;
 	Physics_TickRandomBlocks();
 }
+
+
+/* Points the world at the given blocks, without telling the rest of the game */
+static void Physics_UseMap(BlockID* blocks, Int32 width, Int32 height, Int32 length) {
+	World_Blocks = blocks; World_BlocksSize = width * height * length;
+	physics_blocks = blocks;
+	World_Width  = width;  World_Height = height; World_Length = length;
+	World_MaxX = width - 1; World_MaxY = height - 1; World_MaxZ = length - 1;
+	World_OneY = width * length;
+
+	physics_maxWaterX = World_MaxX - 2;
+	physics_maxWaterY = World_MaxY - 2;
+	physics_maxWaterZ = World_MaxZ - 2;
+}
+
+static void Physics_ResetQueues(void) {
+	Int32 i;
+	for (i = 0; i < PHYSICS_WHEEL_SIZE; i++) {
+		TickQueue_Clear(&physics_lavaQ[i]);
+		TickQueue_Clear(&physics_waterQ[i]);
+	}
+	physics_liquidTick = 0;
+}
+
+/* Places lava and water sources in a grid over the surface of the map, then runs liquid ticks over it */
+static Int32 Physics_RunFlood(Int32 ticks) {
+	Int32 x, y, z, i;
+	for (z = 8; z < World_Length; z += 16) {
+		for (x = 8; x < World_Width; x += 16) {
+			for (y = World_MaxY; y > 0 && Physics_GetBlock(x, y - 1, z) == BLOCK_AIR; y--) {}
+
+			BlockID block = ((x ^ z) & 16) ? BLOCK_LAVA : BLOCK_WATER;
+			Int32 index   = World_Pack(x, y, z);
+			physics_blocks[index] = block;
+			Physics_OnPlace[block](index, block);
+		}
+	}
+
+	struct Stopwatch timer; Stopwatch_Start(&timer);
+	for (i = 0; i < ticks; i++) {
+		physics_liquidTick++;
+		Physics_TickLava();
+		Physics_TickWater();
+	}
+	return Stopwatch_ElapsedMicroseconds(&timer);
+}
+
+/* Generates a map, then floods it using the given number of threads. Returns the resulting map. */
+/* Only the map is replaced, so everything else must not touch the world meanwhile. */
+static BlockID* Physics_Flood(Int32 size, Int32 ticks, Int32 threads, Int32* micros) {
+	Gen_SetDimensions(size, 64, size); Gen_Vanilla = true; Gen_Seed = 12345;
+	NotchyGen_Generate();
+	BlockID* map = Gen_Blocks; Gen_Blocks = NULL;
+
+	/* Stash away liquid ticks of the real world */
+	struct TickQueue lavaQ[PHYSICS_WHEEL_SIZE], waterQ[PHYSICS_WHEEL_SIZE];
+	Mem_Copy(lavaQ,  physics_lavaQ,  sizeof(lavaQ));
+	Mem_Copy(waterQ, physics_waterQ, sizeof(waterQ));
+	Int32 i;
+	for (i = 0; i < PHYSICS_WHEEL_SIZE; i++) {
+		TickQueue_Init(&physics_lavaQ[i]);
+		TickQueue_Init(&physics_waterQ[i]);
+	}
+
+	BlockID* blocks = World_Blocks;
+	BlockID* physicsBlocks = physics_blocks;
+	Int32 width = World_Width, height = World_Height, length = World_Length;
+	UInt32 liquidTick = physics_liquidTick;
+	Int32 realThreads = physics_threads;
+
+	physics_benchmarking = true;
+	physics_threads      = threads;
+	physics_liquidTick   = 0;
+	Physics_UseMap(map, size, 64, size);
+	*micros = Physics_RunFlood(ticks);
+
+	Physics_ResetQueues();
+	physics_benchmarking = false;
+	physics_threads      = realThreads;
+	Physics_UseMap(blocks, width, height, length);
+	physics_blocks = physicsBlocks;
+	Mem_Copy(physics_lavaQ,  lavaQ,  sizeof(lavaQ));
+	Mem_Copy(physics_waterQ, waterQ, sizeof(waterQ));
+	physics_liquidTick = liquidTick;
+
+	Tree_Width = World_Width; Tree_Height = World_Height; Tree_Length = World_Length;
+	Tree_Blocks = physics_blocks; Tree_Rnd = &physics_rnd;
+	return map;
+}
+
+Int32 Physics_FloodBenchmark(Int32 size, Int32 ticks) {
+	Physics_Sync();
+	Int32 micros;
+	/* Sponge checks on other threads would only add noise to the timing */
+	BlockID* map = Physics_Flood(size, ticks, 1, &micros);
+	Mem_Free(&map);
+	return micros;
+}
+
+void Physics_ThreadsCheck(Int32 size, Int32 ticks, struct PhysicsCheckResult* serial, struct PhysicsCheckResult* threaded) {
+	Physics_Sync();
+	Int32 volume = size * 64 * size;
+	BlockID* map = Physics_Flood(size, ticks, 1, &serial->Micros);
+	serial->Hash = Utils_CRC32(map, volume);
+	Mem_Free(&map);
+
+	map = Physics_Flood(size, ticks, PHYSICS_MAX_THREADS, &threaded->Micros);
+	threaded->Hash = Utils_CRC32(map, volume);
+	Mem_Free(&map);
+}
+
+
+/* Block physics is run at a fixed rate, regardless of frame rate. When frames are slow, at most */
+/* a few milliseconds of physics ticks are run each frame, and the rest are carried over to later frames. */
+/* If physics falls too far behind (e.g. a huge flood), the oldest ticks are skipped rather than */
+/* letting the backlog grow forever and physics fall further and further behind. */
+#define PHYSICS_TICK_INTERVAL (1.0 / 20)
+#define PHYSICS_MAX_BACKLOG 20
+
+static void Physics_UpdateRate(Real64 delta, Int32 ticks) {
+	physics_rateTicks   += ticks;
+	physics_rateElapsed += delta;
+	if (physics_rateElapsed < 1.0) return;
+
+	Physics_TicksPerSecond = (Int32)(physics_rateTicks / physics_rateElapsed + 0.5);
+	physics_rateTicks   = 0;
+	physics_rateElapsed = 0.0;
+}
+
+/* NOTE: The physics thread only touches physics state and its copy of the map. */
+/* The main thread must call Physics_Sync before doing anything to physics state. */
+static void Physics_RunAsyncTicks(void) {
+	for (;;) {
+		Waitable_Wait(physics_asyncStart);
+		if (physics_asyncQuit) return;
+
+		Int32 i;
+		for (i = 0; i < physics_asyncTicks; i++) { Physics_Tick(); }
+		Waitable_Signal(physics_asyncDone);
+	}
+}
+
+void Physics_Sync(void) {
+	if (!physics_threadRunning) return;
+	Waitable_Wait(physics_asyncDone);
+	physics_threadRunning = false;
+
+	Game_BeginBlockUpdates();
+	UInt32 i;
+	for (i = 0; i < physics_changesCount; i++) {
+		struct PhysicsChange* change = &physics_changes[i];
+		Int32 x, y, z;
+		World_Unpack(change->Index, x, y, z);
+		World_Blocks[change->Index] = change->Block;
+		Game_RefreshBlock(x, y, z, change->OldBlock, change->Block);
+	}
+	Game_EndBlockUpdates();
+	physics_changesCount = 0;
+}
+
+void Physics_Update(Real64 delta) {
+	if (!Physics_Enabled || !World_Blocks || !ServerConnection_IsSinglePlayer) {
+		physics_accumulator = 0.0; Physics_Backlog = 0; return;
+	}
+	Physics_Sync();
+
+	physics_accumulator += delta;
+	Int32 due = (Int32)(physics_accumulator / PHYSICS_TICK_INTERVAL);
+	if (due > PHYSICS_MAX_BACKLOG) {
+		Physics_SkippedTicks += due - PHYSICS_MAX_BACKLOG;
+		physics_accumulator  -= (due - PHYSICS_MAX_BACKLOG) * PHYSICS_TICK_INTERVAL;
+		due = PHYSICS_MAX_BACKLOG;
+	}
+
+	/* The physics thread can use all the time until the next frame, so just run everything that's due */
+	Int32 ticks = 0;
+	if (physics_copy) {
+		ticks = due;
+		if (ticks) {
+			/* Physics thread is kept alive between frames, and just waits until there are ticks to run */
+			if (!physics_thread) {
+				physics_asyncStart = Waitable_Create();
+				physics_asyncDone  = Waitable_Create();
+				physics_thread     = Thread_Start(Physics_RunAsyncTicks);
+			}
+			physics_asyncTicks    = ticks;
+			physics_threadRunning = true;
+			Waitable_Signal(physics_asyncStart);
+		}
+	} else {
+		struct Stopwatch timer;
+		Stopwatch_Start(&timer);
+		Int32 elapsed = 0;
+
+		Game_BeginBlockUpdates();
+		/* Always run at least one tick, otherwise physics would never progress on slow machines */
+		while (ticks < due && (ticks == 0 || elapsed < physics_budgetMicros)) {
+			Physics_Tick(); ticks++;
+			elapsed += Stopwatch_ElapsedMicroseconds(&timer);
+		}
+		Game_EndBlockUpdates();
+	}
+
+	physics_accumulator -= ticks * PHYSICS_TICK_INTERVAL;
+	Physics_Backlog = due - ticks;
+	Physics_UpdateRate(delta, ticks);
+}
@@ -10,5 +10,28 @@ bool Physics_Enabled;
 void Physics_SetEnabled(bool enabled);
 void Physics_Init(void);
 void Physics_Free(void);
+/* Runs a single tick of block physics. */
 void Physics_Tick(void);
+/* Runs however many block physics ticks are due at a fixed rate, within a per-frame time budget.
+When physics runs on its own thread, this instead hands back block changes from the last batch of ticks. */
+void Physics_Update(Real64 delta);
+/* Waits for the physics thread to finish its current batch of ticks, then applies its block changes. */
+/* Must be called before changing the world from the main thread. */
+void Physics_Sync(void);
+
+/* Physics ticks run over the last second. */
+Int32 Physics_TicksPerSecond;
+/* Number of physics ticks that are due but have not been run yet. */
+Int32 Physics_Backlog;
+/* Number of physics ticks skipped because physics fell too far behind. */
+UInt32 Physics_SkippedTicks;
+/* Floods a generated size x 64 x size map with water and lava, then runs liquid ticks over it. */
+/* Returns how long the liquid ticks took, in microseconds. */
+Int32 Physics_FloodBenchmark(Int32 size, Int32 ticks);
+struct PhysicsCheckResult { UInt32 Hash; Int32 Micros; };
+/* Floods a generated map like Physics_FloodBenchmark, once with sponge checks on worker threads and once without. */
+/* Outputs the CRC32 of the resulting map blocks for each, which must be the same. */
+void Physics_ThreadsCheck(Int32 size, Int32 ticks, struct PhysicsCheckResult* serial, struct PhysicsCheckResult* threaded);
+/* Updates how many blocks that need random ticking are in each layer of the map. */
+void Physics_OnBlockChanged(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockID block);
 #endif
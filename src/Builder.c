@@ -266,6 +266,53 @@ static void Builder_ReadChunkData(Int32 x1, Int32 y1, Int32 z1, bool* outAllAir,
 	*outAllSolid = allSolid;
 }
 
+static Int32 Builder_LongestLayersRun(Int32* counts, Int32* start) {
+	Int32 i, run = 0, best = 0;
+	for (i = 0; i < CHUNK_SIZE; i++) {
+		run = counts[i] == CHUNK_SIZE_2 ? run + 1 : 0;
+		if (run > best) { best = run; *start = i - run + 1; }
+	}
+	return best;
+}
+
+static void Builder_CalcOccluder(Int32 x1, Int32 y1, Int32 z1) {
+	Int32 countsX[CHUNK_SIZE] = { 0 }, countsY[CHUNK_SIZE] = { 0 }, countsZ[CHUNK_SIZE] = { 0 };
+	Int32 xx, yy, zz;
+
+	/* Count fully opaque blocks in each layer of the chunk along each axis */
+	for (yy = 0; yy < CHUNK_SIZE; yy++) {
+		for (zz = 0; zz < CHUNK_SIZE; zz++) {
+			Int32 chunkIndex = (yy + 1) * EXTCHUNK_SIZE_2 + (zz + 1) * EXTCHUNK_SIZE + (0 + 1);
+			for (xx = 0; xx < CHUNK_SIZE; xx++, chunkIndex++) {
+				Int32 solid = Block_FullOpaque[Builder_Chunk[chunkIndex]];
+				countsX[xx] += solid; countsY[yy] += solid; countsZ[zz] += solid;
+			}
+		}
+	}
+
+	Vector3I min = { x1, y1, z1 }, max = { x1 + CHUNK_MAX, y1 + CHUNK_MAX, z1 + CHUNK_MAX };
+	Int32 start = 0, lenX, lenY, lenZ;
+	/* Use whichever axis has the longest run of completely solid layers */
+	lenY = Builder_LongestLayersRun(countsY, &start);
+	if (lenY) { min.Y = y1 + start; max.Y = min.Y + lenY - 1; }
+
+	lenX = Builder_LongestLayersRun(countsX, &start);
+	if (lenX > lenY) {
+		min.Y = y1; max.Y = y1 + CHUNK_MAX;
+		min.X = x1 + start; max.X = min.X + lenX - 1;
+	}
+
+	lenZ = Builder_LongestLayersRun(countsZ, &start);
+	if (lenZ > lenX && lenZ > lenY) {
+		min.X = x1; max.X = x1 + CHUNK_MAX;
+		min.Y = y1; max.Y = y1 + CHUNK_MAX;
+		min.Z = z1 + start; max.Z = min.Z + lenZ - 1;
+	}
+
+	Builder_HasOccluder = lenX || lenY || lenZ;
+	Builder_OccluderMin = min; Builder_OccluderMax = max;
+}
+
 static bool Builder_BuildChunk(Int32 x1, Int32 y1, Int32 z1, bool* allAir) {
 	Builder_PreStretchTiles(x1, y1, z1);
 	BlockID chunk[EXTCHUNK_SIZE_3]; Builder_Chunk = chunk;
@@ -275,6 +322,8 @@ static bool Builder_BuildChunk(Int32 x1, Int32 y1, Int32 z1, bool* allAir) {
 	Mem_Set(chunk, BLOCK_AIR, EXTCHUNK_SIZE_3 * sizeof(BlockID));
 	bool allSolid;
 	Builder_ReadChunkData(x1, y1, z1, allAir, &allSolid);
+	Builder_HasOccluder = false;
+	if (!(*allAir)) Builder_CalcOccluder(x1, y1, z1);
 
 	if (x1 == 0 || y1 == 0 || z1 == 0 || x1 + CHUNK_SIZE >= World_Width ||
 		y1 + CHUNK_SIZE >= World_Height || z1 + CHUNK_SIZE >= World_Length) allSolid = false;
@@ -291,6 +340,7 @@ static bool Builder_BuildChunk(Int32 x1, Int32 y1, Int32 z1, bool* allAir) {
 	Builder_Stretch(x1, y1, z1);
 	Builder_PostStretchTiles(x1, y1, z1);
 	Int32 x, y, z, xx, yy, zz;
+	Vector3I meshMin = { xMax, yMax, zMax }, meshMax = { x1, y1, z1 };
 
 	for (y = y1, yy = 0; y < yMax; y++, yy++) {
 		for (z = z1, zz = 0; z < zMax; z++, zz++) {
@@ -303,11 +353,17 @@ static bool Builder_BuildChunk(Int32 x1, Int32 y1, Int32 z1, bool* allAir) {
 					Builder_X = x; Builder_Y = y; Builder_Z = z;
 					Builder_ChunkIndex = chunkIndex;
 					Builder_RenderBlock(index);
+
+					meshMin.X = min(meshMin.X, x); meshMax.X = max(meshMax.X, x);
+					meshMin.Y = min(meshMin.Y, y); meshMax.Y = max(meshMax.Y, y);
+					meshMin.Z = min(meshMin.Z, z); meshMax.Z = max(meshMax.Z, z);
 				}
 				chunkIndex++;
 			}
 		}
 	}
+
+	Builder_MeshMin = meshMin; Builder_MeshMax = meshMax;
 	return true;
 }
 
@@ -1,6 +1,7 @@
 #ifndef CC_BUILDER_H
 #define CC_BUILDER_H
 #include "Core.h"
+#include "Vectors.h"
 /* Converts a 16x16x16 chunk into a mesh of vertices.
 NormalMeshBuilder:
    Implements a simple chunk mesh builder, where each block face is a single colour.
@@ -11,6 +12,12 @@ Copyright 2014-2017 ClassicalSharp | Licensed under BSD-3
 struct ChunkInfo;
 
 Int32 Builder_SidesLevel, Builder_EdgeLevel;
+/* Coordinates of the lowest and highest drawn blocks in the chunk last built by Builder_MakeChunk. */
+Vector3I Builder_MeshMin, Builder_MeshMax;
+/* Coordinates of the largest box of fully opaque blocks in the chunk last built by Builder_MakeChunk. */
+/* The box is made of whole 16x16 layers of the chunk, and is only valid if Builder_HasOccluder is true. */
+Vector3I Builder_OccluderMin, Builder_OccluderMax;
+bool Builder_HasOccluder;
 
 void Builder_Init(void);
 void Builder_OnNewMapLoaded(void);
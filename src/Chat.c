@@ -14,6 +14,10 @@
 #include "Block.h"
 #include "EnvRenderer.h"
 #include "GameStructs.h"
+#include "Particle.h"
+#include "ChunkUpdater.h"
+#include "BlockPhysics.h"
+#include "AsyncDownloader.h"
 
 #define CHAT_LOGTIMES_DEF_ELEMS 256
 #define CHAT_LOGTIMES_EXPAND_ELEMS 512
@@ -197,7 +201,7 @@ typedef void (*ChatCommandConstructor)(struct ChatCommand* cmd);
 
 #define COMMANDS_PREFIX "/client"
 #define COMMANDS_PREFIX_SPACE "/client "
-struct ChatCommand commands_list[8];
+struct ChatCommand commands_list[16];
 Int32 commands_count;
 
 static bool Commands_IsCommandPrefix(STRING_PURE String* input) {
@@ -462,6 +466,7 @@ static void CuboidCommand_DoCuboid(void) {
 	if (cuboid_block == -1) toPlace = Inventory_SelectedBlock;
 
 	Int32 x, y, z;
+	Game_BeginBlockUpdates();
 	for (y = min.Y; y <= max.Y; y++) {
 		for (z = min.Z; z <= max.Z; z++) {
 			for (x = min.X; x <= max.X; x++) {
@@ -469,6 +474,7 @@ static void CuboidCommand_DoCuboid(void) {
 			}
 		}
 	}
+	Game_EndBlockUpdates();
 }
 
 static void CuboidCommand_BlockChanged(void* obj, Vector3I coords, BlockID oldBlock, BlockID block) {
@@ -559,6 +565,273 @@ static void TeleportCommand_Make(struct ChatCommand* cmd) {
 }
 
 
+/*########################################################################################################################*
+*------------------------------------------------------NetStatsCommand----------------------------------------------------*
+*#########################################################################################################################*/
+static void NetStatsCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	if (argsCount == 1) {
+		NetStats_Print();
+	} else if (String_CaselessEqualsConst(&args[1], "on")) {
+		NetStats_Enabled = true;
+		Chat_AddRaw("&e/client netstats: &fNow collecting packet statistics.");
+	} else if (String_CaselessEqualsConst(&args[1], "off")) {
+		NetStats_Enabled = false;
+		Chat_AddRaw("&e/client netstats: &fNo longer collecting packet statistics.");
+	} else if (String_CaselessEqualsConst(&args[1], "reset")) {
+		NetStats_Reset();
+		Chat_AddRaw("&e/client netstats: &fPacket statistics reset.");
+	} else if (String_CaselessEqualsConst(&args[1], "export")) {
+		String path = argsCount > 2 ? args[2] : String_FromReadonly("netstats.csv");
+		ReturnCode res = NetStats_Export(&path);
+
+		if (res) { Chat_LogError(res, "exporting to", &path); return; }
+		Chat_Add1("&e/client netstats: &fExported packet statistics to %s", &path);
+	} else {
+		Chat_Add1("&e/client netstats: &cUnrecognised option &f\"%s\"&c.", &args[1]);
+	}
+}
+
+static void NetStatsCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "NetStats";
+	cmd->Help[0] = "&a/client netstats [on/off/reset/export] [file]";
+	cmd->Help[1] = "&eShows which packet handlers took the most time.";
+	cmd->Help[2] = "&bon/off: &eStarts or stops collecting statistics.";
+	cmd->Help[3] = "&bexport: &eWrites statistics for every packet to a CSV file.";
+	cmd->Execute = NetStatsCommand_Execute;
+}
+
+
+/*########################################################################################################################*
+*------------------------------------------------------ParticlesCommand---------------------------------------------------*
+*#########################################################################################################################*/
+static void ParticlesCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	Int32 count = 10000, ticks = 20;
+	if (argsCount > 1 && (!Convert_TryParseInt32(&args[1], &count) || count <= 0)) {
+		Chat_AddRaw("&e/client bench particles: &cCount must be a positive integer.");
+		return;
+	}
+
+	Vector3 pos = LocalPlayer_Instance.Base.Position;
+	Int32 elapsed = Particles_Benchmark(pos, count, ticks) / ticks;
+	Chat_Add2("&e/client bench particles: &f%i particles, %i microseconds per tick", &count, &elapsed);
+}
+
+static void ParticlesCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "Particles";
+	cmd->Help[0] = "&a/client bench particles [count]";
+	cmd->Help[1] = "&eSpawns count terrain and rain particles around you,";
+	cmd->Help[2] = "&eand shows how long simulating them took.";
+	cmd->SingleplayerOnly = true;
+	cmd->Execute = ParticlesCommand_Execute;
+}
+
+
+/*########################################################################################################################*
+*------------------------------------------------------OcclusionCommand---------------------------------------------------*
+*#########################################################################################################################*/
+static void OcclusionCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	Int32 iterations = 100, total, hidden;
+	Int32 elapsed = ChunkUpdater_OcclusionBenchmark(iterations, &total, &hidden) / iterations;
+	Chat_Add3("&e/client bench occlusion: &f%i of %i chunks in view hidden, %i microseconds per pass", &hidden, &total, &elapsed);
+}
+
+static void OcclusionCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "Occlusion";
+	cmd->Help[0] = "&a/client bench occlusion";
+	cmd->Help[1] = "&eShows how many chunks in view are hidden behind nearer";
+	cmd->Help[2] = "&echunks, and how long working that out took.";
+	cmd->Execute = OcclusionCommand_Execute;
+}
+
+
+/*########################################################################################################################*
+*--------------------------------------------------------FloodCommand-----------------------------------------------------*
+*#########################################################################################################################*/
+static void FloodCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	Int32 size = 256, ticks = 200;
+	if (argsCount > 1 && (!Convert_TryParseInt32(&args[1], &size) || size < 16 || size > 1024)) {
+		Chat_AddRaw("&e/client bench flood: &cSize must be an integer between 16 and 1024.");
+		return;
+	}
+	if (argsCount > 2 && (!Convert_TryParseInt32(&args[2], &ticks) || ticks <= 0)) {
+		Chat_AddRaw("&e/client bench flood: &cTicks must be a positive integer.");
+		return;
+	}
+
+	Int32 ms = Physics_FloodBenchmark(size, ticks) / 1000;
+	Chat_Add4("&e/client bench flood: &f%i liquid ticks on a %ix64x%i map took %i ms", &ticks, &size, &size, &ms);
+}
+
+static void FloodCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "Flood";
+	cmd->Help[0] = "&a/client bench flood [size] [ticks]";
+	cmd->Help[1] = "&eFloods a generated map with water and lava, and shows";
+	cmd->Help[2] = "&ehow long the liquid physics ticks took.";
+	cmd->SingleplayerOnly = true;
+	cmd->Execute = FloodCommand_Execute;
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------PhysicsCheckCommand---------------------------------------------------*
+*#########################################################################################################################*/
+static void PhysicsCheckCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	Int32 ticks = 200, size = 256;
+	if (argsCount > 1 && (!Convert_TryParseInt32(&args[1], &ticks) || ticks <= 0)) {
+		Chat_AddRaw("&e/client bench physicscheck: &cTicks must be a positive integer.");
+		return;
+	}
+
+	struct PhysicsCheckResult serial, threaded;
+	Physics_ThreadsCheck(size, ticks, &serial, &threaded);
+	serial.Micros /= 1000; threaded.Micros /= 1000;
+	Chat_Add2("&e/client bench physicscheck: &fOne thread: CRC32 %y, took %i ms", &serial.Hash, &serial.Micros);
+	Chat_Add2("&e/client bench physicscheck: &fWorker threads: CRC32 %y, took %i ms", &threaded.Hash, &threaded.Micros);
+	if (serial.Hash != threaded.Hash) Chat_AddRaw("&e/client bench physicscheck: &cResulting maps differ!");
+}
+
+static void PhysicsCheckCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "PhysicsCheck";
+	cmd->Help[0] = "&a/client bench physicscheck [ticks]";
+	cmd->Help[1] = "&eFloods a generated map with and without worker threads,";
+	cmd->Help[2] = "&eand checks that both produced exactly the same blocks.";
+	cmd->SingleplayerOnly = true;
+	cmd->Execute = PhysicsCheckCommand_Execute;
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------EntitiesCommand-----------------------------------------------------*
+*#########################################################################################################################*/
+static void EntitiesCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	Int32 ticks = 100;
+	if (argsCount > 1 && (!Convert_TryParseInt32(&args[1], &ticks) || ticks <= 0)) {
+		Chat_AddRaw("&e/client bench entities: &cTicks must be a positive integer.");
+		return;
+	}
+
+	/* Entity IDs are a single byte, so 255 is the most other players there can be */
+	Int32 counts[5] = { 10, 30, 100, 200, ENTITIES_SELF_ID };
+	Int32 i;
+	for (i = 0; i < Array_Elems(counts); i++) {
+		struct EntitiesBenchResult result;
+		Entities_Benchmark(counts[i], ticks, &result);
+		Chat_Add4("&e/client bench entities: &f%i entities: grid took %i us, checking all took %i us, %i rebuilds",
+			&counts[i], &result.GridMicros, &result.ScanMicros, &result.Rebuilds);
+		if (!result.Same) Chat_AddRaw("&e/client bench entities: &cGrid and checking all found different neighbours!");
+	}
+}
+
+static void EntitiesCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "Entities";
+	cmd->Help[0] = "&a/client bench entities [ticks]";
+	cmd->Help[1] = "&eMoves 10 to 255 generated entities around, and shows how long finding";
+	cmd->Help[2] = "&eneighbours took with the entity grid and by checking every entity.";
+	cmd->SingleplayerOnly = true;
+	cmd->Execute = EntitiesCommand_Execute;
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------------CachedSkinCommand----------------------------------------------------*
+*#########################################################################################################################*/
+static void CachedSkinCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	String skinName = String_FromRawArray(LocalPlayer_Instance.SkinNameRaw);
+	if (argsCount > 1) skinName = args[1];
+
+	struct AsyncRequest item;
+	if (!AsyncDownloader_GetCachedSkin(&skinName, &item)) {
+		Chat_Add1("&e/client bench cachedskin: &cSkin %s is not in the texture cache.", &skinName);
+		return;
+	}
+
+	if (item.ImageResult) {
+		Chat_Add2("&e/client bench cachedskin: &cCached skin %s is not a valid PNG (error %i).", &skinName, &item.ImageResult);
+	} else {
+		Int32 width = item.ImageWidth, height = item.ImageHeight;
+		Chat_Add4("&e/client bench cachedskin: &fLoaded %s from the cache without network access: %ix%i, CRC32 %y",
+			&skinName, &width, &height, &item.DataHash);
+	}
+	ASyncRequest_Free(&item);
+}
+
+static void CachedSkinCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "CachedSkin";
+	cmd->Help[0] = "&a/client bench cachedskin [skin name]";
+	cmd->Help[1] = "&eLoads a skin (your own by default) from the texture cache,";
+	cmd->Help[2] = "&ewithout any network access, and shows its size and CRC32.";
+	cmd->Execute = CachedSkinCommand_Execute;
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------------BenchCommand------------------------------------------------------*
+*#########################################################################################################################*/
+/* Benchmarks and checks, which are run as /client bench [name] instead of each being a client command */
+struct ChatCommand bench_list[8];
+Int32 bench_count;
+
+static void BenchCommand_Register(ChatCommandConstructor constructor) {
+	if (bench_count == Array_Elems(bench_list)) {
+		ErrorHandler_Fail("BenchCommand_Register - hit max benchmarks");
+	}
+
+	struct ChatCommand command = { 0 };
+	constructor(&command);
+	bench_list[bench_count++] = command;
+}
+
+static struct ChatCommand* BenchCommand_GetMatch(STRING_PURE String* name) {
+	Int32 i;
+	for (i = 0; i < bench_count; i++) {
+		String benchName = String_FromReadonly(bench_list[i].Name);
+		if (String_CaselessEquals(&benchName, name)) return &bench_list[i];
+	}
+
+	Chat_Add1("&e/client bench: &cUnrecognised benchmark: \"&f%s&c\".", name);
+	return NULL;
+}
+
+static void BenchCommand_Execute(STRING_PURE String* args, Int32 argsCount) {
+	Int32 i, j;
+	if (argsCount == 1) {
+		Chat_AddRaw("&eList of benchmarks:");
+		for (i = 0; i < bench_count; i++) { Chat_AddRaw(bench_list[i].Help[0]); }
+		Chat_AddRaw("&eTo see help for a benchmark, type &a/client bench help [name]");
+		return;
+	}
+
+	if (String_CaselessEqualsConst(&args[1], "help")) {
+		if (argsCount == 2) { Chat_AddRaw("&e/client bench help: &cNo benchmark name given."); return; }
+		struct ChatCommand* bench = BenchCommand_GetMatch(&args[2]);
+		if (!bench) return;
+
+		for (j = 0; j < Array_Elems(bench->Help); j++) {
+			if (!bench->Help[j]) continue;
+			Chat_AddRaw(bench->Help[j]);
+		}
+		return;
+	}
+
+	struct ChatCommand* bench = BenchCommand_GetMatch(&args[1]);
+	if (!bench) return;
+	if (bench->SingleplayerOnly && !ServerConnection_IsSinglePlayer) {
+		Chat_Add1("&e/client bench: \"&f%s&e\" can only be used in singleplayer.", &args[1]);
+		return;
+	}
+	/* Benchmarks see their name as args[0], the same as client commands do */
+	bench->Execute(args + 1, argsCount - 1);
+}
+
+static void BenchCommand_Make(struct ChatCommand* cmd) {
+	cmd->Name    = "Bench";
+	cmd->Help[0] = "&a/client bench [name] [args]";
+	cmd->Help[1] = "&eRuns the given benchmark or check.";
+	cmd->Help[2] = "&eType &a/client bench &efor a list of benchmarks.";
+	cmd->Execute = BenchCommand_Execute;
+}
+
+
 /*########################################################################################################################*
 *-------------------------------------------------------Generic chat------------------------------------------------------*
 *#########################################################################################################################*/
@@ -582,6 +855,15 @@ static void Chat_Init(void) {
 	Commands_Register(ModelCommand_Make);
 	Commands_Register(CuboidCommand_Make);
 	Commands_Register(TeleportCommand_Make);
+	Commands_Register(NetStatsCommand_Make);
+	Commands_Register(BenchCommand_Make);
+
+	BenchCommand_Register(ParticlesCommand_Make);
+	BenchCommand_Register(OcclusionCommand_Make);
+	BenchCommand_Register(FloodCommand_Make);
+	BenchCommand_Register(PhysicsCheckCommand_Make);
+	BenchCommand_Register(EntitiesCommand_Make);
+	BenchCommand_Register(CachedSkinCommand_Make);
 }
 
 static void Chat_Reset(void) {
@@ -14,18 +14,56 @@
 #include "Utils.h"
 #include "ErrorHandler.h"
 #include "Vectors.h"
+#include "OcclusionCulling.h"
 
 Vector3I ChunkUpdater_ChunkPos;
 UInt32* ChunkUpdater_Distances;
+/* Bounds of each chunk's mesh, and whether each chunk was in the frustum when last tested. */
+/* Both are indexed the same way as MapRenderer_Chunks. */
+struct FrustumBoxes ChunkUpdater_Bounds;
+bool* ChunkUpdater_InFrustum;
+/* Box of fully opaque blocks in each chunk, or 0 half size if the chunk has none. */
+struct FrustumBoxes ChunkUpdater_Occluders;
+
+/* Sets bounds of the chunk's mesh from the coordinates of its lowest and highest drawn blocks */
+static void ChunkUpdater_SetBounds(struct ChunkInfo* info, Vector3I min, Vector3I max) {
+	Int32 i = (Int32)(info - MapRenderer_Chunks);
+	/* Pad by a block on each side, as sprites and some models poke slightly outside their block */
+	ChunkUpdater_Bounds.CentreX[i] = (min.X + max.X + 1) * 0.5f; ChunkUpdater_Bounds.HalfX[i] = (max.X + 1 - min.X) * 0.5f + 1.0f;
+	ChunkUpdater_Bounds.CentreY[i] = (min.Y + max.Y + 1) * 0.5f; ChunkUpdater_Bounds.HalfY[i] = (max.Y + 1 - min.Y) * 0.5f + 1.0f;
+	ChunkUpdater_Bounds.CentreZ[i] = (min.Z + max.Z + 1) * 0.5f; ChunkUpdater_Bounds.HalfZ[i] = (max.Z + 1 - min.Z) * 0.5f + 1.0f;
+}
+
+static void ChunkUpdater_SetOccluder(struct ChunkInfo* info, Vector3I min, Vector3I max) {
+	Int32 i = (Int32)(info - MapRenderer_Chunks);
+	ChunkUpdater_Occluders.CentreX[i] = (min.X + max.X + 1) * 0.5f; ChunkUpdater_Occluders.HalfX[i] = (max.X + 1 - min.X) * 0.5f;
+	ChunkUpdater_Occluders.CentreY[i] = (min.Y + max.Y + 1) * 0.5f; ChunkUpdater_Occluders.HalfY[i] = (max.Y + 1 - min.Y) * 0.5f;
+	ChunkUpdater_Occluders.CentreZ[i] = (min.Z + max.Z + 1) * 0.5f; ChunkUpdater_Occluders.HalfZ[i] = (max.Z + 1 - min.Z) * 0.5f;
+}
+
+/* Resets bounds to the whole chunk, and removes its occluder until it is next built */
+static void ChunkUpdater_ResetBounds(struct ChunkInfo* info) {
+	Vector3I min = { info->CentreX - 8, info->CentreY - 8, info->CentreZ - 8 };
+	Vector3I max = { info->CentreX + 7, info->CentreY + 7, info->CentreZ + 7 };
+	ChunkUpdater_SetBounds(info, min, max);
+	ChunkUpdater_Occluders.HalfX[info - MapRenderer_Chunks] = 0.0f;
+}
+
+static bool ChunkUpdater_IsInFrustum(struct ChunkInfo* info) {
+	Int32 i = (Int32)(info - MapRenderer_Chunks);
+	FrustumCulling_BoxesInFrustum(&ChunkUpdater_Bounds, i, 1, &ChunkUpdater_InFrustum[i]);
+	return ChunkUpdater_InFrustum[i];
+}
 
 void ChunkInfo_Reset(struct ChunkInfo* chunk, Int32 x, Int32 y, Int32 z) {
 	chunk->CentreX = x + 8; chunk->CentreY = y + 8; chunk->CentreZ = z + 8;
+	ChunkUpdater_ResetBounds(chunk);
 #if !CC_BUILD_GL11
 	chunk->Vb = NULL;
 #endif
 
 	chunk->Visible = true; chunk->Empty = false;
-	chunk->PendingDelete = false; chunk->AllAir = false;
+	chunk->PendingDelete = false; chunk->AllAir = false; chunk->Occluded = false;
 	chunk->DrawXMin = false; chunk->DrawXMax = false; chunk->DrawZMin = false;
 	chunk->DrawZMax = false; chunk->DrawYMin = false; chunk->DrawYMax = false;
 
@@ -90,6 +128,8 @@ static void ChunkUpdater_FreeAllocations(void) {
 	Mem_Free(&MapRenderer_SortedChunks);
 	Mem_Free(&MapRenderer_RenderChunks);
 	Mem_Free(&ChunkUpdater_Distances);
+	Mem_Free(&ChunkUpdater_Bounds.CentreX);
+	Mem_Free(&ChunkUpdater_InFrustum);
 	ChunkUpdater_FreePartsAllocations();
 }
 
@@ -105,6 +145,19 @@ static void ChunkUpdater_PerformAllocations(void) {
 	MapRenderer_SortedChunks = Mem_Alloc(MapRenderer_ChunksCount, sizeof(struct ChunkInfo*), "sorted chunk info");
 	MapRenderer_RenderChunks = Mem_Alloc(MapRenderer_ChunksCount, sizeof(struct ChunkInfo*), "render chunk info");
 	ChunkUpdater_Distances   = Mem_Alloc(MapRenderer_ChunksCount, sizeof(Int32), "chunk distances");
+	ChunkUpdater_InFrustum   = Mem_Alloc(MapRenderer_ChunksCount, sizeof(bool), "chunk visibility");
+
+	/* Bounds and occluder arrays are allocated as a single block */
+	Int32 count = MapRenderer_ChunksCount;
+	Real32* bounds = Mem_Alloc(count * 12, sizeof(Real32), "chunk bounds");
+	ChunkUpdater_Bounds.CentreX = bounds;             ChunkUpdater_Bounds.HalfX = bounds + count * 3;
+	ChunkUpdater_Bounds.CentreY = bounds + count;     ChunkUpdater_Bounds.HalfY = bounds + count * 4;
+	ChunkUpdater_Bounds.CentreZ = bounds + count * 2; ChunkUpdater_Bounds.HalfZ = bounds + count * 5;
+
+	bounds += count * 6;
+	ChunkUpdater_Occluders.CentreX = bounds;             ChunkUpdater_Occluders.HalfX = bounds + count * 3;
+	ChunkUpdater_Occluders.CentreY = bounds + count;     ChunkUpdater_Occluders.HalfY = bounds + count * 4;
+	ChunkUpdater_Occluders.CentreZ = bounds + count * 2; ChunkUpdater_Occluders.HalfZ = bounds + count * 5;
 	ChunkUpdater_PerformPartsAllocations();
 }
 
@@ -188,10 +241,45 @@ static Int32 ChunkUpdater_AdjustViewDist(Int32 dist) {
 	return (viewDist + 24) * (viewDist + 24);
 }
 
+/* Chunks are frustum culled in groups of 4x4x4 first, so whole regions inside or outside can be skipped */
+#define CU_GROUP_SIZE 4
+static void ChunkUpdater_CullChunks(void) {
+	Int32 gx, gy, gz, cy, cz;
+	for (gz = 0; gz < MapRenderer_ChunksZ; gz += CU_GROUP_SIZE) {
+		for (gy = 0; gy < MapRenderer_ChunksY; gy += CU_GROUP_SIZE) {
+			for (gx = 0; gx < MapRenderer_ChunksX; gx += CU_GROUP_SIZE) {
+				Int32 countX = min(CU_GROUP_SIZE, MapRenderer_ChunksX - gx);
+				Int32 countY = min(CU_GROUP_SIZE, MapRenderer_ChunksY - gy);
+				Int32 countZ = min(CU_GROUP_SIZE, MapRenderer_ChunksZ - gz);
+
+				/* Padded the same as chunk bounds, so it contains all of them */
+				Vector3 centre, half;
+				half.X = countX * HALF_CHUNK_SIZE + 1.0f; centre.X = (Real32)(gx * CHUNK_SIZE + countX * HALF_CHUNK_SIZE);
+				half.Y = countY * HALF_CHUNK_SIZE + 1.0f; centre.Y = (Real32)(gy * CHUNK_SIZE + countY * HALF_CHUNK_SIZE);
+				half.Z = countZ * HALF_CHUNK_SIZE + 1.0f; centre.Z = (Real32)(gz * CHUNK_SIZE + countZ * HALF_CHUNK_SIZE);
+				Int32 result = FrustumCulling_ClassifyBox(&centre, &half);
+
+				/* Chunks along X are stored next to each other, so test a row of the group at once */
+				for (cz = gz; cz < gz + countZ; cz++) {
+					for (cy = gy; cy < gy + countY; cy++) {
+						Int32 index = MapRenderer_Pack(gx, cy, cz);
+						if (result == FRUSTUM_INTERSECTS) {
+							FrustumCulling_BoxesInFrustum(&ChunkUpdater_Bounds, index, countX, &ChunkUpdater_InFrustum[index]);
+						} else {
+							Mem_Set(&ChunkUpdater_InFrustum[index], result == FRUSTUM_INSIDE, countX * sizeof(bool));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
 static Int32 ChunkUpdater_UpdateChunksAndVisibility(Int32* chunkUpdates) {
 	Int32 i, j = 0;
 	Int32 viewDistSqr = ChunkUpdater_AdjustViewDist(Game_ViewDistance);
 	Int32 userDistSqr = ChunkUpdater_AdjustViewDist(Game_UserViewDistance);
+	ChunkUpdater_CullChunks();
 
 	for (i = 0; i < MapRenderer_ChunksCount; i++) {
 		struct ChunkInfo* info = MapRenderer_SortedChunks[i];
@@ -205,13 +293,17 @@ static Int32 ChunkUpdater_UpdateChunksAndVisibility(Int32* chunkUpdates) {
 		}
 		noData |= info->PendingDelete;
 
+		Int32 index = (Int32)(info - MapRenderer_Chunks);
+		bool inFrustum = ChunkUpdater_InFrustum[index];
+
 		if (noData && distSqr <= viewDistSqr && *chunkUpdates < cu_chunksTarget) {
 			ChunkUpdater_DeleteChunk(info);
 			ChunkUpdater_BuildChunk(info, chunkUpdates);
+			/* Bounds of the new mesh may differ from when chunks were culled */
+			inFrustum = ChunkUpdater_IsInFrustum(info);
 		}
 
-		info->Visible = distSqr <= viewDistSqr &&
-			FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+		info->Visible = distSqr <= viewDistSqr && inFrustum;
 		if (info->Visible && !info->Empty) { MapRenderer_RenderChunks[j] = info; j++; }
 	}
 	return j;
@@ -239,8 +331,7 @@ static Int32 ChunkUpdater_UpdateChunksStill(Int32* chunkUpdates) {
 			ChunkUpdater_BuildChunk(info, chunkUpdates);
 
 			/* only need to update the visibility of chunks in range. */
-			info->Visible = distSqr <= viewDistSqr &&
-				FrustumCulling_SphereInFrustum(info->CentreX, info->CentreY, info->CentreZ, 14); /* 14 ~ sqrt(3 * 8^2) */
+			info->Visible = distSqr <= viewDistSqr && ChunkUpdater_IsInFrustum(info);
 			if (info->Visible && !info->Empty) { MapRenderer_RenderChunks[j] = info; j++; }
 		} else if (info->Visible) {
 			MapRenderer_RenderChunks[j] = info; j++;
@@ -249,6 +340,69 @@ static Int32 ChunkUpdater_UpdateChunksStill(Int32* chunkUpdates) {
 	return j;
 }
 
+/* Max number of the nearest chunks whose occluders are drawn when recalculating occlusion */
+#define CU_MAX_OCCLUDERS 128
+static void ChunkUpdater_GetBox(struct FrustumBoxes* boxes, Int32 i, Vector3* min, Vector3* max) {
+	min->X = boxes->CentreX[i] - boxes->HalfX[i]; max->X = boxes->CentreX[i] + boxes->HalfX[i];
+	min->Y = boxes->CentreY[i] - boxes->HalfY[i]; max->Y = boxes->CentreY[i] + boxes->HalfY[i];
+	min->Z = boxes->CentreZ[i] - boxes->HalfZ[i]; max->Z = boxes->CentreZ[i] + boxes->HalfZ[i];
+}
+
+static void ChunkUpdater_CalcOccluded(void) {
+	Vector3 min, max;
+	Int32 i, drawn = 0;
+	Int32 viewDistSqr = ChunkUpdater_AdjustViewDist(Game_ViewDistance);
+	struct FrustumBoxes* occ = &ChunkUpdater_Occluders;
+	struct FrustumBoxes* bounds = &ChunkUpdater_Bounds;
+	OcclusionCulling_Begin(&Gfx_Projection, &Gfx_View, Game_CurrentCameraPos);
+
+	for (i = 0; i < MapRenderer_ChunksCount && drawn < CU_MAX_OCCLUDERS; i++) {
+		if (ChunkUpdater_Distances[i] > viewDistSqr) break;
+		Int32 index = (Int32)(MapRenderer_SortedChunks[i] - MapRenderer_Chunks);
+		if (occ->HalfX[index] == 0.0f || !ChunkUpdater_InFrustum[index]) continue;
+
+		ChunkUpdater_GetBox(occ, index, &min, &max);
+		OcclusionCulling_DrawOccluder(min, max);
+		drawn++;
+	}
+
+	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+		struct ChunkInfo* info = MapRenderer_SortedChunks[i];
+		if (!info->Visible || info->Empty) continue;
+		Int32 index = (Int32)(info - MapRenderer_Chunks);
+		ChunkUpdater_GetBox(bounds, index, &min, &max);
+		info->Occluded = !OcclusionCulling_TestBox(min, max);
+	}
+}
+
+static void ChunkUpdater_RemoveOccluded(void) {
+	Int32 i, j = 0;
+	for (i = 0; i < MapRenderer_RenderChunksCount; i++) {
+		struct ChunkInfo* info = MapRenderer_RenderChunks[i];
+		if (!info->Occluded) { MapRenderer_RenderChunks[j] = info; j++; }
+	}
+	MapRenderer_RenderChunksCount = j;
+}
+
+Int32 ChunkUpdater_OcclusionBenchmark(Int32 iterations, Int32* total, Int32* hidden) {
+	struct Stopwatch sw;
+	Int32 i, elapsed;
+	*total = 0; *hidden = 0;
+	if (!MapRenderer_Chunks) return 0;
+
+	Stopwatch_Start(&sw);
+	for (i = 0; i < iterations; i++) { ChunkUpdater_CalcOccluded(); }
+	elapsed = Stopwatch_ElapsedMicroseconds(&sw);
+
+	for (i = 0; i < MapRenderer_ChunksCount; i++) {
+		struct ChunkInfo* info = &MapRenderer_Chunks[i];
+		if (!info->Visible || info->Empty) continue;
+		(*total)++;
+		if (info->Occluded) (*hidden)++;
+	}
+	return elapsed;
+}
+
 void ChunkUpdater_UpdateChunks(Real64 delta) {
 	Int32 chunkUpdates = 0;
 	cu_chunksTarget += delta < cu_targetTime ? 1 : -1; /* build more chunks if 30 FPS or over, otherwise slowdown. */
@@ -264,6 +418,10 @@ void ChunkUpdater_UpdateChunks(Real64 delta) {
 		ChunkUpdater_UpdateChunksStill(&chunkUpdates) :
 		ChunkUpdater_UpdateChunksAndVisibility(&chunkUpdates);
 
+	/* Chunks and their occluders only move relative to the camera when it moves or chunks are rebuilt */
+	if (!samePos || chunkUpdates != 0) ChunkUpdater_CalcOccluded();
+	ChunkUpdater_RemoveOccluded();
+
 	cu_lastCamPos = camPos;
 	cu_lastHeadX = headX; cu_lastHeadY = headY;
 
@@ -334,6 +492,7 @@ static void ChunkUpdater_ClearChunkCache_Handler(void* obj) {
 
 void ChunkUpdater_DeleteChunk(struct ChunkInfo* info) {
 	info->Empty = false; info->AllAir = false;
+	ChunkUpdater_ResetBounds(info);
 #if OCCLUSION
 	info.OcclusionFlags = 0;
 	info.OccludedFlags = 0;
@@ -373,10 +532,12 @@ void ChunkUpdater_BuildChunk(struct ChunkInfo* info, Int32* chunkUpdates) {
 	(*chunkUpdates)++;
 	info->PendingDelete = false;
 	Builder_MakeChunk(info);
+	if (Builder_HasOccluder) ChunkUpdater_SetOccluder(info, Builder_OccluderMin, Builder_OccluderMax);
 
 	if (!info->NormalParts && !info->TranslucentParts) {
 		info->Empty = true; return;
 	}
+	ChunkUpdater_SetBounds(info, Builder_MeshMin, Builder_MeshMax);
 	Int32 i;
 
 	if (info->NormalParts) {
@@ -25,6 +25,7 @@ struct ChunkInfo {
 	UInt8 Empty : 1;         /* Whether the chunk is empty of data */
 	UInt8 PendingDelete : 1; /* Whether chunk is pending deletion*/	
 	UInt8 AllAir : 1;        /* Whether chunk is completely air */
+	UInt8 Occluded : 1;      /* Whether chunk is hidden behind nearer chunks */
 	UInt8 : 0;               /* pad to next byte*/
 
 	UInt8 DrawXMin : 1;
@@ -53,6 +54,9 @@ void ChunkUpdater_Refresh(void);
 void ChunkUpdater_RefreshBorders(Int32 clipLevel);
 void ChunkUpdater_ApplyMeshBuilder(void);
 void ChunkUpdater_Update(Real64 deltaTime);
+/* Recalculates which chunks are hidden behind nearer chunks the given number of times. */
+/* Returns elapsed microseconds, and sets how many chunks are in view and how many of those are hidden. */
+Int32 ChunkUpdater_OcclusionBenchmark(Int32 iterations, Int32* total, Int32* hidden);
 
 void ChunkUpdater_ResetPartFlags(void);
 void ChunkUpdater_ResetPartCounts(void);
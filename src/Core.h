@@ -62,12 +62,15 @@ struct FontDesc { void* Handle; UInt16 Size, Style; };
 
 #define CC_BUILD_GL11 false
 #define CC_BUILD_D3D9 true
+/* Records draw calls in memory instead of drawing, for profiling the CPU side of rendering. */
+/* Requires CC_BUILD_D3D9 to be false. */
+#define CC_BUILD_NULLGFX false
 
 #define CC_BUILD_WIN true
 #define CC_BUILD_OSX false
 #define CC_BUILD_NIX false
 
-#if CC_BUILD_D3D9
+#if CC_BUILD_D3D9 || CC_BUILD_NULLGFX
 typedef void* GfxResourceID;
 #else
 typedef UInt32 GfxResourceID;
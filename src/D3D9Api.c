@@ -257,14 +257,14 @@ void Gfx_UpdateTexturePart(GfxResourceID texId, Int32 x, Int32 y, struct Bitmap*
 	if (mipmaps) D3D9_DoMipmaps(texture, x, y, part, true);
 }
 
-void Gfx_BindTexture(GfxResourceID texId) {
+void GfxBackend_BindTexture(GfxResourceID texId) {
 	ReturnCode hresult = IDirect3DDevice9_SetTexture(device, 0, (IDirect3DBaseTexture9*)texId);
 	ErrorHandler_CheckOrFail(hresult, "D3D9_BindTexture");
 }
 
 void Gfx_DeleteTexture(GfxResourceID* texId) { D3D9_FreeResource(texId); }
 
-void Gfx_SetTexturing(bool enabled) {
+void GfxBackend_SetTexturing(bool enabled) {
 	if (enabled) return;
 	ReturnCode hresult = IDirect3DDevice9_SetTexture(device, 0, NULL);
 	ErrorHandler_CheckOrFail(hresult, "D3D9_SetTexturing");
@@ -330,15 +330,13 @@ void Gfx_SetFogMode(Int32 fogMode) {
 }
 
 
-void Gfx_SetFaceCulling(bool enabled) {
+void GfxBackend_SetFaceCulling(bool enabled) {
 	D3DCULL mode = enabled ? D3DCULL_CW : D3DCULL_NONE;
 	D3D9_SetRenderState(D3DRS_CULLMODE, mode, "D3D9_SetFaceCulling");
 }
 
 bool d3d9_alphaTest = false;
-void Gfx_SetAlphaTest(bool enabled) {
-	if (d3d9_alphaTest == enabled) return;
-
+void GfxBackend_SetAlphaTest(bool enabled) {
 	d3d9_alphaTest = enabled;
 	D3D9_SetRenderState(D3DRS_ALPHATESTENABLE, (UInt32)enabled, "D3D9_SetAlphaTest");
 }
@@ -353,9 +351,7 @@ void Gfx_SetAlphaTestFunc(Int32 compareFunc, Real32 refValue) {
 }
 
 bool d3d9_alphaBlend = false;
-void Gfx_SetAlphaBlending(bool enabled) {
-	if (d3d9_alphaBlend == enabled) return;
-
+void GfxBackend_SetAlphaBlending(bool enabled) {
 	d3d9_alphaBlend = enabled;
 	D3D9_SetRenderState(D3DRS_ALPHABLENDENABLE, (UInt32)enabled, "D3D9_SetAlphaBlending");
 }
@@ -388,7 +384,7 @@ void Gfx_ClearCol(PackedCol col) {
 }
 
 bool d3d9_depthTest = false;
-void Gfx_SetDepthTest(bool enabled) {
+void GfxBackend_SetDepthTest(bool enabled) {
 	d3d9_depthTest = enabled;
 	D3D9_SetRenderState(D3DRS_ZENABLE, (UInt32)enabled, "D3D9_SetDepthTest");
 }
@@ -405,7 +401,7 @@ void Gfx_SetColourWriteMask(bool r, bool g, bool b, bool a) {
 }
 
 bool d3d9_depthWrite = false;
-void Gfx_SetDepthWrite(bool enabled) {
+void GfxBackend_SetDepthWrite(bool enabled) {
 	d3d9_depthWrite = enabled;
 	D3D9_SetRenderState(D3DRS_ZWRITEENABLE, (UInt32)enabled, "D3D9_SetDepthWrite");
 }
@@ -479,11 +475,7 @@ void Gfx_BindIb(GfxResourceID ib) {
 void Gfx_DeleteVb(GfxResourceID* vb) { D3D9_FreeResource(vb); }
 void Gfx_DeleteIb(GfxResourceID* ib) { D3D9_FreeResource(ib); }
 
-Int32 d3d9_batchFormat = -1;
-void Gfx_SetBatchFormat(Int32 format) {
-	if (format == d3d9_batchFormat) return;
-	d3d9_batchFormat = format;
-
+void GfxBackend_SetBatchFormat(Int32 format) {
 	ReturnCode hresult = IDirect3DDevice9_SetFVF(device, d3d9_formatMappings[format]);
 	ErrorHandler_CheckOrFail(hresult, "D3D9_SetBatchFormat");
 	d3d9_batchStride = Gfx_strideSizes[format];
@@ -666,8 +658,7 @@ void Gfx_OnWindowResize(void) {
 
 
 static void D3D9_SetDefaultRenderStates(void) {
-	Gfx_SetFaceCulling(false);
-	d3d9_batchFormat = -1;
+	GfxBackend_SetFaceCulling(false);
 	D3D9_SetRenderState(D3DRS_COLORVERTEX, false, "D3D9_ColorVertex");
 	D3D9_SetRenderState2(D3DRS_LIGHTING, false, "D3D9_Lighting");
 	D3D9_SetRenderState2(D3DRS_SPECULARENABLE, false, "D3D9_SpecularEnable");
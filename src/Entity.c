@@ -213,31 +213,313 @@ bool Entity_TouchesAnyWater(struct Entity* entity) {
 }
 
 
+/*########################################################################################################################*
+*--------------------------------------------------------NameAtlas--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Name textures of players are packed into a few shared textures, each split into a grid of cells. */
+/* Used cells in each row are tracked with a bitmask, so a name's cells can be freed and reused */
+/* when the player leaves or is renamed, without having to repack any other names. */
+#define NAMEATLAS_WIDTH  1024
+#define NAMEATLAS_HEIGHT 512
+#define NAMEATLAS_CELL   32
+#define NAMEATLAS_COLS   (NAMEATLAS_WIDTH  / NAMEATLAS_CELL) /* must be 32, i.e. one bit per cell */
+#define NAMEATLAS_ROWS   (NAMEATLAS_HEIGHT / NAMEATLAS_CELL)
+#define NAMEATLAS_MAX_PAGES 16
+#define NameAtlas_Mask(cells, x) ((cells) == NAMEATLAS_COLS ? 0xFFFFFFFFUL : ((1UL << (cells)) - 1) << (x))
+
+struct NameAtlasPage { GfxResourceID TexID; UInt32 Rows[NAMEATLAS_ROWS]; };
+struct NameAtlasPage nameAtlas_pages[NAMEATLAS_MAX_PAGES];
+/* Names to draw are batched up, then drawn with one draw call per page used */
+VertexP3fT2fC4b nameAtlas_vertices[ENTITIES_MAX_COUNT * 4], nameAtlas_sorted[ENTITIES_MAX_COUNT * 4];
+UInt8 nameAtlas_quadPages[ENTITIES_MAX_COUNT];
+Int32 nameAtlas_quads;
+GfxResourceID nameAtlas_vb;
+
+static void NameAtlas_MakePage(struct NameAtlasPage* page) {
+	struct Bitmap bmp; Bitmap_AllocateClearedPow2(&bmp, NAMEATLAS_WIDTH, NAMEATLAS_HEIGHT);
+	page->TexID = Gfx_CreateTexture(&bmp, true, false);
+	Mem_Free(&bmp.Scan0);
+}
+
+/* Finds free cells in the atlas for a name of the given size. Returns false if the atlas is full. */
+static bool NameAtlas_Alloc(struct Texture* tex, Int32* cellX, Int32* cellY, Int32 width, Int32 height) {
+	Int32 cellsX = Math_CeilDiv(width, NAMEATLAS_CELL), cellsY = Math_CeilDiv(height, NAMEATLAS_CELL);
+	if (cellsX > NAMEATLAS_COLS || cellsY > NAMEATLAS_ROWS) return false;
+	Int32 i, x, y, row;
+
+	for (i = 0; i < NAMEATLAS_MAX_PAGES; i++) {
+		struct NameAtlasPage* page = &nameAtlas_pages[i];
+		for (y = 0; y + cellsY <= NAMEATLAS_ROWS; y++) {
+			for (x = 0; x + cellsX <= NAMEATLAS_COLS; x++) {
+				UInt32 mask = NameAtlas_Mask(cellsX, x);
+				for (row = y; row < y + cellsY; row++) {
+					if (page->Rows[row] & mask) break;
+				}
+				if (row < y + cellsY) continue;
+
+				for (row = y; row < y + cellsY; row++) { page->Rows[row] |= mask; }
+				if (!page->TexID) NameAtlas_MakePage(page);
+
+				Int32 texX = x * NAMEATLAS_CELL, texY = y * NAMEATLAS_CELL;
+				struct Texture tmp = { page->TexID, TEX_RECT(0,0, width,height),
+					TEX_UV((Real32)texX / NAMEATLAS_WIDTH, (Real32)texY / NAMEATLAS_HEIGHT,
+					(Real32)(texX + width) / NAMEATLAS_WIDTH, (Real32)(texY + height) / NAMEATLAS_HEIGHT) };
+				*tex = tmp; *cellX = x; *cellY = y;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static void NameAtlas_Release(struct Texture* tex) {
+	Int32 i, row;
+	if (!tex->ID) return;
+
+	for (i = 0; i < NAMEATLAS_MAX_PAGES; i++) {
+		struct NameAtlasPage* page = &nameAtlas_pages[i];
+		if (page->TexID != tex->ID) continue;
+
+		Int32 x = (Int32)(tex->U1 * NAMEATLAS_WIDTH  + 0.5f) / NAMEATLAS_CELL;
+		Int32 y = (Int32)(tex->V1 * NAMEATLAS_HEIGHT + 0.5f) / NAMEATLAS_CELL;
+		Int32 cellsX = Math_CeilDiv(tex->Width, NAMEATLAS_CELL), cellsY = Math_CeilDiv(tex->Height, NAMEATLAS_CELL);
+
+		UInt32 mask = NameAtlas_Mask(cellsX, x);
+		for (row = y; row < y + cellsY; row++) { page->Rows[row] &= ~mask; }
+		break;
+	}
+	tex->ID = NULL;
+}
+
+static void NameAtlas_Free(void) {
+	Int32 i;
+	for (i = 0; i < NAMEATLAS_MAX_PAGES; i++) {
+		struct NameAtlasPage* page = &nameAtlas_pages[i];
+		Gfx_DeleteTexture(&page->TexID);
+		Mem_Set(page->Rows, 0, sizeof(page->Rows));
+	}
+	Gfx_DeleteVb(&nameAtlas_vb);
+	nameAtlas_quads = 0;
+}
+
+static VertexP3fT2fC4b* NameAtlas_AddQuad(GfxResourceID texId) {
+	Int32 i;
+	for (i = 0; i < NAMEATLAS_MAX_PAGES; i++) {
+		if (nameAtlas_pages[i].TexID == texId) break;
+	}
+
+	nameAtlas_quadPages[nameAtlas_quads] = (UInt8)i;
+	return &nameAtlas_vertices[nameAtlas_quads++ * 4];
+}
+
+static void NameAtlas_Flush(void) {
+	if (!nameAtlas_quads) return;
+	Int32 counts[NAMEATLAS_MAX_PAGES] = { 0 }, offsets[NAMEATLAS_MAX_PAGES];
+	Int32 i, total = 0;
+
+	/* Sort quads by page, so that all names on the same page are drawn together */
+	for (i = 0; i < nameAtlas_quads; i++) { counts[nameAtlas_quadPages[i]]++; }
+	for (i = 0; i < NAMEATLAS_MAX_PAGES; i++) { offsets[i] = total; total += counts[i]; }
+	for (i = 0; i < nameAtlas_quads; i++) {
+		Int32 dst = offsets[nameAtlas_quadPages[i]]++;
+		Mem_Copy(&nameAtlas_sorted[dst * 4], &nameAtlas_vertices[i * 4], sizeof(VertexP3fT2fC4b) * 4);
+	}
+
+	if (!nameAtlas_vb) {
+		nameAtlas_vb = Gfx_CreateDynamicVb(VERTEX_FORMAT_P3FT2FC4B, ENTITIES_MAX_COUNT * 4);
+	}
+	Gfx_SetBatchFormat(VERTEX_FORMAT_P3FT2FC4B);
+	Gfx_SetDynamicVbData(nameAtlas_vb, nameAtlas_sorted, nameAtlas_quads * 4);
+
+	for (i = 0, total = 0; i < NAMEATLAS_MAX_PAGES; i++) {
+		if (!counts[i]) continue;
+		Gfx_BindTexture(nameAtlas_pages[i].TexID);
+		Gfx_DrawVb_IndexedTris_Range(counts[i] * 4, total * 4);
+		total += counts[i];
+	}
+	nameAtlas_quads = 0;
+}
+
+
 /*########################################################################################################################*
 *--------------------------------------------------------Entities---------------------------------------------------------*
 *#########################################################################################################################*/
 EntityID entities_closestId;
+/* Names of other players further than this from the camera aren't drawn, unless names are unscaled */
+#define ENTITIES_NAME_DIST 32
+/* Entities are bucketed into a uniform grid of columns on the horizontal plane, so that queries only */
+/* need to look at entities in nearby columns. Each entity is added to every column its (rotated) picking */
+/* bounds could overlap. Grid is rebuilt lazily on the next query after an entity moves to different columns. */
+#define ENTITYGRID_SHIFT 2
+#define ENTITYGRID_SIZE (1 << ENTITYGRID_SHIFT)
+#define ENTITYGRID_BUCKETS 256
+#define ENTITYGRID_HASH(cx, cz) (((cx) * 31 + (cz)) & (ENTITYGRID_BUCKETS - 1))
+struct EntityGridEntry { Int32 Next; EntityID Id; };
+
+Int32 entityGrid_heads[ENTITYGRID_BUCKETS];
+struct EntityGridEntry* entityGrid_entries;
+Int32 entityGrid_count, entityGrid_capacity;
+Int32 entityGrid_minX, entityGrid_maxX, entityGrid_minZ, entityGrid_maxZ;
+bool entityGrid_stale = true;
+/* Stamp of the last query each entity was returned from, to avoid testing entities in several columns twice */
+UInt32 entityGrid_stamps[ENTITIES_MAX_COUNT], entityGrid_curStamp;
+/* Range of columns each entity was added to when the grid was last rebuilt */
+struct EntityGridCells { Int32 MinX, MaxX, MinZ, MaxZ; };
+struct EntityGridCells entityGrid_cells[ENTITIES_MAX_COUNT];
+
+static void EntityGrid_Add(EntityID id, Int32 cx, Int32 cz) {
+	if (entityGrid_count == entityGrid_capacity) {
+		entityGrid_capacity = max(512, entityGrid_capacity * 2);
+		if (entityGrid_entries) {
+			entityGrid_entries = Mem_Realloc(entityGrid_entries, entityGrid_capacity, sizeof(struct EntityGridEntry), "entity grid");
+		} else {
+			entityGrid_entries = Mem_Alloc(entityGrid_capacity, sizeof(struct EntityGridEntry), "entity grid");
+		}
+	}
+
+	Int32 bucket = ENTITYGRID_HASH(cx, cz);
+	struct EntityGridEntry* entry = &entityGrid_entries[entityGrid_count];
+	entry->Id = id; entry->Next = entityGrid_heads[bucket];
+	entityGrid_heads[bucket] = entityGrid_count++;
+}
+
+/* Gets the range of columns the given entity's (rotated) picking bounds could overlap */
+static void EntityGrid_GetCells(struct Entity* e, struct EntityGridCells* cells) {
+	/* Model may be rotated, so use radius of the circle enclosing the model's bounds */
+	struct AABB* bb = &e->ModelAABB;
+	Real32 dx = max(Math_AbsF(bb->Min.X), Math_AbsF(bb->Max.X));
+	Real32 dz = max(Math_AbsF(bb->Min.Z), Math_AbsF(bb->Max.Z));
+	Real32 radius = Math_SqrtF(dx * dx + dz * dz);
+
+	cells->MinX = Math_Floor(e->Position.X - radius) >> ENTITYGRID_SHIFT;
+	cells->MaxX = Math_Floor(e->Position.X + radius) >> ENTITYGRID_SHIFT;
+	cells->MinZ = Math_Floor(e->Position.Z - radius) >> ENTITYGRID_SHIFT;
+	cells->MaxZ = Math_Floor(e->Position.Z + radius) >> ENTITYGRID_SHIFT;
+}
+
+static void EntityGrid_Update(void) {
+	if (!entityGrid_stale) return;
+	entityGrid_stale = false;
+	entityGrid_count = 0;
+	entityGrid_minX = Int32_MaxValue; entityGrid_maxX = Int32_MinValue;
+	entityGrid_minZ = Int32_MaxValue; entityGrid_maxZ = Int32_MinValue;
+
+	Int32 i, cx, cz;
+	for (i = 0; i < ENTITYGRID_BUCKETS; i++) { entityGrid_heads[i] = -1; }
+
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		EntityID id = Entities_Active[i];
+		struct EntityGridCells* cells = &entityGrid_cells[id];
+		EntityGrid_GetCells(Entities_List[id], cells);
+
+		for (cx = cells->MinX; cx <= cells->MaxX; cx++) {
+			for (cz = cells->MinZ; cz <= cells->MaxZ; cz++) { EntityGrid_Add(id, cx, cz); }
+		}
+		entityGrid_minX = min(entityGrid_minX, cells->MinX); entityGrid_maxX = max(entityGrid_maxX, cells->MaxX);
+		entityGrid_minZ = min(entityGrid_minZ, cells->MinZ); entityGrid_maxZ = max(entityGrid_maxZ, cells->MaxZ);
+	}
+}
+
+/* Marks the grid as needing to be rebuilt if any entity has moved into a different range of columns */
+static void EntityGrid_CheckMoved(void) {
+	if (entityGrid_stale) return;
+	struct EntityGridCells cells;
+	Int32 i;
+
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		EntityID id = Entities_Active[i];
+		EntityGrid_GetCells(Entities_List[id], &cells);
+		struct EntityGridCells* old = &entityGrid_cells[id];
+
+		if (cells.MinX != old->MinX || cells.MaxX != old->MaxX || cells.MinZ != old->MinZ || cells.MaxZ != old->MaxZ) {
+			entityGrid_stale = true; return;
+		}
+	}
+}
+
+static Int32 EntityGrid_Collect(Int32 cx, Int32 cz, EntityID* ids, Int32 count) {
+	Int32 i = entityGrid_heads[ENTITYGRID_HASH(cx, cz)];
+	for (; i != -1; i = entityGrid_entries[i].Next) {
+		EntityID id = entityGrid_entries[i].Id;
+		if (entityGrid_stamps[id] == entityGrid_curStamp) continue;
+		entityGrid_stamps[id] = entityGrid_curStamp;
+		ids[count++] = id;
+	}
+	return count;
+}
+
+/* Skins are decoded on the async downloader's thread, but creating textures is still done on the main thread. */
+/* So that lots of players joining at once doesn't cause a big stall, only a few are created per tick. */
+#define PLAYER_MAX_SKIN_UPLOADS 4
+Int32 player_skinUploadsLeft;
+
 void Entities_Tick(struct ScheduledTask* task) {
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		Entities_List[i]->VTABLE->Tick(Entities_List[i], task->Interval);
+	Int32 i;
+	player_skinUploadsLeft = PLAYER_MAX_SKIN_UPLOADS;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* entity = Entities_List[Entities_Active[i]];
+		entity->VTABLE->Tick(entity, task->Interval);
+	}
+	EntityGrid_CheckMoved();
+}
+
+/* Same result as Math_LerpAngle, but without branches so the caller's loop can be vectorised */
+static Real32 Entities_LerpAngle(Real32 left, Real32 right, Real32 t) {
+	Int32 invertLeft  = (left  > 270.0f) & (right < 90.0f);
+	Int32 invertRight = (right > 270.0f) & (left  < 90.0f);
+	Real32 a = left  - 360.0f * invertLeft;
+	Real32 b = right - 360.0f * invertRight;
+	return a + (b - a) * t;
+}
+
+void Entities_Interpolate(Real32 t) {
+	struct EntitiesHot* h = &Entities_Hot;
+	Int32 i, count = Entities_ActiveCount;
+	/* Entities_Active is sorted, so the last network player in it has the highest ID */
+	if (count && Entities_Active[count - 1] == ENTITIES_SELF_ID) count--;
+	if (!count) return;
+	count = Entities_Active[count - 1] + 1;
+
+	/* Unused slots below count are interpolated too, so that these loops have no branches */
+	for (i = 0; i < count; i++) {
+		h->X[i] = t * (h->NextX[i] - h->PrevX[i]) + h->PrevX[i];
+		h->Y[i] = t * (h->NextY[i] - h->PrevY[i]) + h->PrevY[i];
+		h->Z[i] = t * (h->NextZ[i] - h->PrevZ[i]) + h->PrevZ[i];
+	}
+	for (i = 0; i < count; i++) {
+		h->HeadX[i] = Entities_LerpAngle(h->PrevHeadX[i], h->NextHeadX[i], t);
+		h->HeadY[i] = Entities_LerpAngle(h->PrevHeadY[i], h->NextHeadY[i], t);
+		h->RotX[i]  = Entities_LerpAngle(h->PrevRotX[i],  h->NextRotX[i],  t);
+		h->RotY[i]  = Entities_LerpAngle(h->PrevRotY[i],  h->NextRotY[i],  t);
+		h->RotZ[i]  = Entities_LerpAngle(h->PrevRotZ[i],  h->NextRotZ[i],  t);
 	}
 }
 
 void Entities_RenderModels(Real64 delta, Real32 t) {
 	Gfx_SetTexturing(true);
 	Gfx_SetAlphaTest(true);
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		Entities_List[i]->VTABLE->RenderModel(Entities_List[i], delta, t);
+	Entities_Interpolate(t);
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* entity = Entities_List[Entities_Active[i]];
+		entity->VTABLE->RenderModel(entity, delta, t);
 	}
+	EntityGrid_CheckMoved();
 	Gfx_SetTexturing(false);
 	Gfx_SetAlphaTest(false);
 }
 	
 
+/* Gets IDs (in ascending order) of entities whose names might need to be drawn. Except when names are */
+/* unscaled, other players' names are only drawn within ENTITIES_NAME_DIST of the camera, so the grid is used. */
+static Int32 Entities_GetNameCandidates(EntityID* ids) {
+	if (Entities_NameMode == NAME_MODE_ALL_UNSCALED) {
+		Mem_Copy(ids, Entities_Active, Entities_ActiveCount * sizeof(EntityID));
+		return Entities_ActiveCount;
+	}
+	return Entities_QueryRadius(Game_CurrentCameraPos, ENTITIES_NAME_DIST, ids);
+}
+
 void Entities_RenderNames(Real64 delta) {
 	if (Entities_NameMode == NAME_MODE_NONE) return;
 	struct LocalPlayer* p = &LocalPlayer_Instance;
@@ -249,13 +531,18 @@ void Entities_RenderNames(Real64 delta) {
 	bool hadFog = Gfx_GetFog();
 	if (hadFog) Gfx_SetFog(false);
 
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		if (i != entities_closestId || i == ENTITIES_SELF_ID) {
-			Entities_List[i]->VTABLE->RenderName(Entities_List[i]);
+	EntityID ids[ENTITIES_MAX_COUNT];
+	Int32 i, count = Entities_GetNameCandidates(ids);
+	for (i = 0; i < count; i++) {
+		EntityID id = ids[i];
+		if (id != entities_closestId && id != ENTITIES_SELF_ID) {
+			Entities_List[id]->VTABLE->RenderName(Entities_List[id]);
 		}
 	}
+	/* Local player has the highest ID, so its name is still drawn last */
+	struct Entity* self = Entities_List[ENTITIES_SELF_ID];
+	if (self) self->VTABLE->RenderName(self);
+	NameAtlas_Flush();
 
 	Gfx_SetTexturing(false);
 	Gfx_SetAlphaTest(false);
@@ -274,13 +561,18 @@ void Entities_RenderHoveredNames(Real64 delta) {
 	bool hadFog = Gfx_GetFog();
 	if (hadFog) Gfx_SetFog(false);
 
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		if ((i == entities_closestId || allNames) && i != ENTITIES_SELF_ID) {
-			Entities_List[i]->VTABLE->RenderName(Entities_List[i]);
+	if (allNames) {
+		EntityID ids[ENTITIES_MAX_COUNT];
+		Int32 i, count = Entities_GetNameCandidates(ids);
+		for (i = 0; i < count; i++) {
+			EntityID id = ids[i];
+			if (id != ENTITIES_SELF_ID) Entities_List[id]->VTABLE->RenderName(Entities_List[id]);
 		}
+	} else if (entities_closestId != ENTITIES_SELF_ID && Entities_List[entities_closestId]) {
+		struct Entity* closest = Entities_List[entities_closestId];
+		closest->VTABLE->RenderName(closest);
 	}
+	NameAtlas_Flush();
 
 	Gfx_SetTexturing(false);
 	Gfx_SetAlphaTest(false);
@@ -289,28 +581,33 @@ void Entities_RenderHoveredNames(Real64 delta) {
 }
 
 static void Entities_ContextLost(void* obj) {
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		Entities_List[i]->VTABLE->ContextLost(Entities_List[i]);
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* entity = Entities_List[Entities_Active[i]];
+		entity->VTABLE->ContextLost(entity);
 	}
 	Gfx_DeleteTexture(&ShadowComponent_ShadowTex);
+	Gfx_DeleteVb(&ShadowComponent_Vb);
+	NameAtlas_Free();
 }
 
 static void Entities_ContextRecreated(void* obj) {
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		Entities_List[i]->VTABLE->ContextRecreated(Entities_List[i]);
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* entity = Entities_List[Entities_Active[i]];
+		entity->VTABLE->ContextRecreated(entity);
 	}
 }
 
+static void Entities_WorldChanged(void* obj) { ShadowComponent_Invalidate(); }
+static void Entities_EnvVarChanged(void* obj, Int32 envVar) { ShadowComponent_Invalidate(); }
+
 static void Entities_ChatFontChanged(void* obj) {
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		if (Entities_List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
-		Player_UpdateName((struct Player*)Entities_List[i]);
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* entity = Entities_List[Entities_Active[i]];
+		if (entity->EntityType != ENTITY_TYPE_PLAYER) continue;
+		Player_UpdateName((struct Player*)entity);
 	}
 }
 
@@ -318,6 +615,9 @@ void Entities_Init(void) {
 	Event_RegisterVoid(&GfxEvents_ContextLost,      NULL, Entities_ContextLost);
 	Event_RegisterVoid(&GfxEvents_ContextRecreated, NULL, Entities_ContextRecreated);
 	Event_RegisterVoid(&ChatEvents_FontChanged,     NULL, Entities_ChatFontChanged);
+	Event_RegisterVoid(&WorldEvents_MapLoaded,      NULL, Entities_WorldChanged);
+	Event_RegisterVoid(&BlockEvents_BlockDefChanged, NULL, Entities_WorldChanged);
+	Event_RegisterInt(&WorldEvents_EnvVarChanged,   NULL, Entities_EnvVarChanged);
 
 	Entities_NameMode = Options_GetEnum(OPT_NAMES_MODE, NAME_MODE_HOVERED,
 		NameMode_Names, Array_Elems(NameMode_Names));
@@ -329,25 +629,72 @@ void Entities_Init(void) {
 }
 
 void Entities_Free(void) {
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		Entities_Remove((EntityID)i);
+	/* Entities_Remove takes the entity out of the active list */
+	while (Entities_ActiveCount) {
+		Entities_Remove(Entities_Active[0]);
 	}
 
 	Event_UnregisterVoid(&GfxEvents_ContextLost,      NULL, Entities_ContextLost);
 	Event_UnregisterVoid(&GfxEvents_ContextRecreated, NULL, Entities_ContextRecreated);
 	Event_UnregisterVoid(&ChatEvents_FontChanged,     NULL, Entities_ChatFontChanged);
+	Event_UnregisterVoid(&WorldEvents_MapLoaded,      NULL, Entities_WorldChanged);
+	Event_UnregisterVoid(&BlockEvents_BlockDefChanged, NULL, Entities_WorldChanged);
+	Event_UnregisterInt(&WorldEvents_EnvVarChanged,   NULL, Entities_EnvVarChanged);
+	Mem_Free(&entityGrid_entries);
+	entityGrid_capacity = 0;
 
 	if (ShadowComponent_ShadowTex) {
 		Gfx_DeleteTexture(&ShadowComponent_ShadowTex);
 	}
+	Gfx_DeleteVb(&ShadowComponent_Vb);
+	NameAtlas_Free();
+}
+
+void Entities_Add(EntityID id, struct Entity* entity) {
+	if (!Entities_List[id]) {
+		Int32 i = Entities_ActiveCount;
+		/* Keep active list sorted, so entities are always processed in the same order as before */
+		for (; i > 0 && Entities_Active[i - 1] > id; i--) {
+			Entities_Active[i] = Entities_Active[i - 1];
+		}
+		Entities_Active[i] = id;
+		Entities_ActiveCount++;
+	}
+	Entities_List[id] = entity;
+	entityGrid_stale = true;
 }
 
 void Entities_Remove(EntityID id) {
 	Event_RaiseInt(&EntityEvents_Removed, id);
 	Entities_List[id]->VTABLE->Despawn(Entities_List[id]);
 	Entities_List[id] = NULL;
+
+	Int32 i, j = 0;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		if (Entities_Active[i] != id) Entities_Active[j++] = Entities_Active[i];
+	}
+	Entities_ActiveCount = j;
+	entityGrid_stale = true;
+}
+
+Int32 Entities_QueryRadius(Vector3 pos, Real32 radius, EntityID* ids) {
+	EntityGrid_Update();
+	entityGrid_curStamp++;
+	Int32 minX = Math_Floor(pos.X - radius) >> ENTITYGRID_SHIFT, maxX = Math_Floor(pos.X + radius) >> ENTITYGRID_SHIFT;
+	Int32 minZ = Math_Floor(pos.Z - radius) >> ENTITYGRID_SHIFT, maxZ = Math_Floor(pos.Z + radius) >> ENTITYGRID_SHIFT;
+
+	Int32 cx, cz, i, j, count = 0;
+	for (cx = minX; cx <= maxX; cx++) {
+		for (cz = minZ; cz <= maxZ; cz++) { count = EntityGrid_Collect(cx, cz, ids, count); }
+	}
+
+	/* Sort IDs, so entities are always processed in the same order */
+	for (i = 1; i < count; i++) {
+		EntityID id = ids[i];
+		for (j = i; j > 0 && ids[j - 1] > id; j--) { ids[j] = ids[j - 1]; }
+		ids[j] = id;
+	}
+	return count;
 }
 
 EntityID Entities_GetCloset(struct Entity* src) {
@@ -355,24 +702,125 @@ EntityID Entities_GetCloset(struct Entity* src) {
 	Vector3 dir = Vector3_GetDirVector(src->HeadY * MATH_DEG2RAD, src->HeadX * MATH_DEG2RAD);
 	Real32 closestDist = MATH_POS_INF;
 	EntityID targetId = ENTITIES_SELF_ID;
+	EntityID ids[ENTITIES_MAX_COUNT];
+
+	EntityGrid_Update();
+	entityGrid_curStamp++;
+	/* Walk the columns the ray passes through, nearest first */
+	Int32 cx = Math_Floor(eyePos.X) >> ENTITYGRID_SHIFT, cz = Math_Floor(eyePos.Z) >> ENTITYGRID_SHIFT;
+	Int32 stepX = dir.X >= 0.0f ? 1 : -1, stepZ = dir.Z >= 0.0f ? 1 : -1;
+	Real32 deltaX = dir.X != 0.0f ? ENTITYGRID_SIZE / Math_AbsF(dir.X) : MATH_POS_INF;
+	Real32 deltaZ = dir.Z != 0.0f ? ENTITYGRID_SIZE / Math_AbsF(dir.Z) : MATH_POS_INF;
+	Real32 nextX  = dir.X != 0.0f ? ((cx + (stepX > 0)) * ENTITYGRID_SIZE - eyePos.X) / dir.X : MATH_POS_INF;
+	Real32 nextZ  = dir.Z != 0.0f ? ((cz + (stepZ > 0)) * ENTITYGRID_SIZE - eyePos.Z) / dir.Z : MATH_POS_INF;
+
+	for (;;) {
+		/* Stop once the ray has left the area containing entities */
+		if (cx > entityGrid_maxX && (stepX > 0 || dir.X == 0.0f)) break;
+		if (cx < entityGrid_minX && (stepX < 0 || dir.X == 0.0f)) break;
+		if (cz > entityGrid_maxZ && (stepZ > 0 || dir.Z == 0.0f)) break;
+		if (cz < entityGrid_minZ && (stepZ < 0 || dir.Z == 0.0f)) break;
+
+		Int32 i, count = EntityGrid_Collect(cx, cz, ids, 0);
+		for (i = 0; i < count; i++) {
+			EntityID id = ids[i];
+			if (id == ENTITIES_SELF_ID) continue; /* because we don't want to pick against local player */
+			struct Entity* entity = Entities_List[id];
+
+			Real32 t0, t1;
+			if (!Intersection_RayIntersectsRotatedBox(eyePos, dir, entity, &t0, &t1)) continue;
+			if (t0 < closestDist || (t0 == closestDist && id < targetId)) {
+				closestDist = t0;
+				targetId = id;
+			}
+		}
 
-	UInt32 i;
-	for (i = 0; i < ENTITIES_SELF_ID; i++) { /* because we don't want to pick against local player */
-		struct Entity* entity = Entities_List[i];
-		if (!entity) continue;
-
-		Real32 t0, t1;
-		if (Intersection_RayIntersectsRotatedBox(eyePos, dir, entity, &t0, &t1) && t0 < closestDist) {
-			closestDist = t0;
-			targetId = (EntityID)i;
+		/* Entities in later columns can't be any closer */
+		Real32 next = min(nextX, nextZ);
+		if (next > closestDist || next == MATH_POS_INF) break;
+		if (nextX < nextZ) {
+			cx += stepX; nextX += deltaX;
+		} else {
+			cz += stepZ; nextZ += deltaZ;
 		}
 	}
 	return targetId;
 }
 
+/* Whether the given entity is within the horizontal pushing distance of pos */
+static bool Entities_BenchTouches(Vector3 pos, EntityID id, Real32 radius) {
+	Vector3 other = Entities_List[id]->Position;
+	return Math_AbsF(other.X - pos.X) <= 1.0f + radius && Math_AbsF(other.Z - pos.Z) <= 1.0f + radius;
+}
+
+struct Entity entities_benchList[ENTITIES_SELF_ID];
+void Entities_Benchmark(Int32 count, Int32 ticks, struct EntitiesBenchResult* result) {
+	struct Entity* oldList[ENTITIES_MAX_COUNT];
+	EntityID oldActive[ENTITIES_MAX_COUNT];
+	Int32 oldCount = Entities_ActiveCount;
+	Mem_Copy(oldList,   Entities_List,   sizeof(oldList));
+	Mem_Copy(oldActive, Entities_Active, sizeof(oldActive));
+
+	/* All generated entities use the local player's model bounds */
+	struct AABB* bb = &LocalPlayer_Instance.Base.ModelAABB;
+	Real32 dx = max(Math_AbsF(bb->Min.X), Math_AbsF(bb->Max.X));
+	Real32 dz = max(Math_AbsF(bb->Min.Z), Math_AbsF(bb->Max.Z));
+	Real32 radius = Math_SqrtF(dx * dx + dz * dz);
+
+	Random rnd; Random_Init(&rnd, 2018);
+	Int32 i, j, n;
+	Mem_Set(Entities_List, 0, sizeof(Entities_List));
+	for (i = 0; i < count; i++) {
+		struct Entity* e = &entities_benchList[i];
+		Mem_Set(e, 0, sizeof(struct Entity));
+		e->ModelAABB  = *bb;
+		e->Position.X = Random_Float(&rnd) * 128.0f;
+		e->Position.Z = Random_Float(&rnd) * 128.0f;
+		Entities_List[i] = e; Entities_Active[i] = (EntityID)i;
+	}
+	Entities_ActiveCount = count;
+	entityGrid_stale = true;
+
+	EntityID ids[ENTITIES_MAX_COUNT];
+	struct Stopwatch sw;
+	result->GridMicros = 0; result->ScanMicros = 0;
+	result->Rebuilds   = 0; result->Same = true;
+
+	for (n = 0; n < ticks; n++) {
+		/* About half of the entities take a small step each tick */
+		for (i = 0; i < count; i++) {
+			if (Random_Next(&rnd, 2)) continue;
+			entities_benchList[i].Position.X += Random_Float(&rnd) * 0.5f - 0.25f;
+			entities_benchList[i].Position.Z += Random_Float(&rnd) * 0.5f - 0.25f;
+		}
+		Int32 gridFound = 0, scanFound = 0;
+
+		Stopwatch_Start(&sw);
+		EntityGrid_CheckMoved();
+		if (entityGrid_stale) result->Rebuilds++;
+		for (i = 0; i < count; i++) {
+			Vector3 pos = entities_benchList[i].Position;
+			Int32 found = Entities_QueryRadius(pos, 1.0f, ids);
+			for (j = 0; j < found; j++) { gridFound += Entities_BenchTouches(pos, ids[j], radius); }
+		}
+		result->GridMicros += Stopwatch_ElapsedMicroseconds(&sw);
+
+		for (i = 0; i < count; i++) {
+			Vector3 pos = entities_benchList[i].Position;
+			for (j = 0; j < count; j++) { scanFound += Entities_BenchTouches(pos, Entities_Active[j], radius); }
+		}
+		result->ScanMicros += Stopwatch_ElapsedMicroseconds(&sw);
+		if (gridFound != scanFound) result->Same = false;
+	}
+
+	Mem_Copy(Entities_List,   oldList,   sizeof(oldList));
+	Mem_Copy(Entities_Active, oldActive, sizeof(oldActive));
+	Entities_ActiveCount = oldCount;
+	entityGrid_stale = true;
+}
+
 void Entities_DrawShadows(void) {
 	if (Entities_ShadowMode == SHADOW_MODE_NONE) return;
-	ShadowComponent_BoundShadowTex = false;
 
 	Gfx_SetAlphaArgBlend(true);
 	Gfx_SetDepthWrite(false);
@@ -380,15 +828,17 @@ void Entities_DrawShadows(void) {
 	Gfx_SetTexturing(true);
 
 	Gfx_SetBatchFormat(VERTEX_FORMAT_P3FT2FC4B);
-	ShadowComponent_Draw(Entities_List[ENTITIES_SELF_ID]);
+	ShadowComponent_Draw(ENTITIES_SELF_ID, Entities_List[ENTITIES_SELF_ID]);
 	if (Entities_ShadowMode == SHADOW_MODE_CIRCLE_ALL) {
-		UInt32 i;
-		for (i = 0; i < ENTITIES_SELF_ID; i++) {
-			if (!Entities_List[i]) continue;
-			if (Entities_List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
-			ShadowComponent_Draw(Entities_List[i]);
+		Int32 i;
+		for (i = 0; i < Entities_ActiveCount; i++) {
+			EntityID id = Entities_Active[i];
+			if (id == ENTITIES_SELF_ID) continue;
+			if (Entities_List[id]->EntityType != ENTITY_TYPE_PLAYER) continue;
+			ShadowComponent_Draw(id, Entities_List[id]);
 		}
 	}
+	ShadowComponent_Flush();
 
 	Gfx_SetAlphaArgBlend(false);
 	Gfx_SetDepthWrite(true);
@@ -473,15 +923,23 @@ static void Player_MakeNameTexture(struct Player* player) {
 	Drawer2D_UseBitmappedChat = true;
 	struct Size2D size = Drawer2D_MeasureText(&args);
 
-	if (size.Width == 0) {
+	bool empty = size.Width == 0;
+	Int32 cellX, cellY;
+	/* really long names are cut off at the atlas width */
+	size.Width = min(size.Width + 3, NAMEATLAS_WIDTH); size.Height += 3;
+
+	if (empty || !NameAtlas_Alloc(&player->NameTex, &cellX, &cellY, size.Width, size.Height)) {
 		player->NameTex.ID = NULL;
 		player->NameTex.X  = PLAYER_NAME_EMPTY_TEX;
 	} else {
 		UChar buffer[String_BufferSize(STRING_SIZE)];
 		String shadowName = String_InitAndClearArray(buffer);
 
-		size.Width += 3; size.Height += 3;
-		struct Bitmap bmp; Bitmap_AllocateClearedPow2(&bmp, size.Width, size.Height);
+		/* Clear the whole of the name's cells, so nothing of names that used them before can bleed in */
+		Int32 bmpWidth  = Math_CeilDiv(size.Width,  NAMEATLAS_CELL) * NAMEATLAS_CELL;
+		Int32 bmpHeight = Math_CeilDiv(size.Height, NAMEATLAS_CELL) * NAMEATLAS_CELL;
+		struct Bitmap bmp; Bitmap_Allocate(&bmp, bmpWidth, bmpHeight);
+		Mem_Set(bmp.Scan0, 0, Bitmap_DataSize(bmpWidth, bmpHeight));
 		Drawer2D_Begin(&bmp);
 		{
 			PackedCol origWhiteCol = Drawer2D_Cols['f'];
@@ -497,7 +955,7 @@ static void Player_MakeNameTexture(struct Player* player) {
 		}
 		Drawer2D_End();
 
-		Drawer2D_Make2DTexture(&player->NameTex, &bmp, size, 0, 0);
+		Gfx_UpdateTexturePart(player->NameTex.ID, cellX * NAMEATLAS_CELL, cellY * NAMEATLAS_CELL, &bmp, false);
 		Mem_Free(&bmp.Scan0);
 	}
 	Drawer2D_UseBitmappedChat = bitmapped;
@@ -517,7 +975,7 @@ static void Player_DrawName(struct Player* player) {
 
 	if (player->NameTex.X == PLAYER_NAME_EMPTY_TEX) return;
 	if (!player->NameTex.ID) Player_MakeNameTexture(player);
-	Gfx_BindTexture(player->NameTex.ID);
+	if (!player->NameTex.ID) return;
 
 	Vector3 pos;
 	model->RecalcProperties(entity);
@@ -535,24 +993,20 @@ static void Player_DrawName(struct Player* player) {
 		size.X *= tempW * 0.2f; size.Y *= tempW * 0.2f;
 	}
 
-	VertexP3fT2fC4b vertices[4];
-	struct TextureRec rec = { 0.0f, 0.0f, player->NameTex.U2, player->NameTex.V2 };
+	struct TextureRec rec = { player->NameTex.U1, player->NameTex.V1, player->NameTex.U2, player->NameTex.V2 };
 	PackedCol col = PACKEDCOL_WHITE;
-	Particle_DoRender(&size, &pos, &rec, col, vertices);
-
-	Gfx_SetBatchFormat(VERTEX_FORMAT_P3FT2FC4B);
-	GfxCommon_UpdateDynamicVb_IndexedTris(GfxCommon_texVb, vertices, 4);
+	Particle_DoRender(&size, &pos, &rec, col, NameAtlas_AddQuad(player->NameTex.ID));
 }
 
 static struct Player* Player_FirstOtherWithSameSkin(struct Player* player) {
 	struct Entity* entity = &player->Base;
 	String skin = String_FromRawArray(player->SkinNameRaw);
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i] || Entities_List[i] == entity) continue;
-		if (Entities_List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* other = Entities_List[Entities_Active[i]];
+		if (other == entity || other->EntityType != ENTITY_TYPE_PLAYER) continue;
 
-		struct Player* p = (struct Player*)Entities_List[i];
+		struct Player* p = (struct Player*)other;
 		String pSkin = String_FromRawArray(p->SkinNameRaw);
 		if (String_Equals(&skin, &pSkin)) return p;
 	}
@@ -562,12 +1016,12 @@ static struct Player* Player_FirstOtherWithSameSkin(struct Player* player) {
 static struct Player* Player_FirstOtherWithSameSkinAndFetchedSkin(struct Player* player) {
 	struct Entity* entity = &player->Base;
 	String skin = String_FromRawArray(player->SkinNameRaw);
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i] || Entities_List[i] == entity) continue;
-		if (Entities_List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* other = Entities_List[Entities_Active[i]];
+		if (other == entity || other->EntityType != ENTITY_TYPE_PLAYER) continue;
 
-		struct Player* p = (struct Player*)Entities_List[i];
+		struct Player* p = (struct Player*)other;
 		String pSkin = String_FromRawArray(p->SkinNameRaw);
 		if (p->FetchedSkin && String_Equals(&skin, &pSkin)) return p;
 	}
@@ -580,6 +1034,7 @@ static void Player_ApplySkin(struct Player* player, struct Player* from) {
 
 	dst->TextureId = src->TextureId;	
 	dst->SkinType  = src->SkinType;
+	player->SkinHash = from->SkinHash;
 	dst->uScale    = src->uScale;
 	dst->vScale    = src->vScale;
 
@@ -597,17 +1052,51 @@ void Player_ResetSkin(struct Player* player) {
 	entity->MobTextureId = NULL;
 	entity->TextureId    = NULL;
 	entity->SkinType = SKIN_TYPE_64x32;
+	player->SkinHash = 0;
+}
+
+/* Returns a player with a different skin name, whose skin was downloaded with exactly the same contents */
+static struct Player* Player_FirstWithSameSkinData(struct Player* player, UInt32 hash) {
+	String skin = String_FromRawArray(player->SkinNameRaw);
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* other = Entities_List[Entities_Active[i]];
+		if (other->EntityType != ENTITY_TYPE_PLAYER) continue;
+
+		struct Player* p = (struct Player*)other;
+		String pSkin = String_FromRawArray(p->SkinNameRaw);
+		if (p->SkinHash == hash && other->TextureId && !String_Equals(&skin, &pSkin)) return p;
+	}
+	return NULL;
+}
+
+/* Deletes the player's skin texture, unless it is shared with a player that has a different skin name */
+static void Player_DeleteSkinTexture(struct Player* player) {
+	struct Entity* entity = &player->Base;
+	if (!entity->TextureId) return;
+	String skin = String_FromRawArray(player->SkinNameRaw);
+	Int32 i;
+
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* other = Entities_List[Entities_Active[i]];
+		if (other->EntityType != ENTITY_TYPE_PLAYER || other->TextureId != entity->TextureId) continue;
+
+		struct Player* p = (struct Player*)other;
+		String pSkin = String_FromRawArray(p->SkinNameRaw);
+		if (!String_Equals(&skin, &pSkin)) { entity->TextureId = NULL; return; }
+	}
+	Gfx_DeleteTexture(&entity->TextureId);
 }
 
 /* Apply or reset skin, for all players with same skin */
 static void Player_SetSkinAll(struct Player* player, bool reset) {
 	String skin = String_FromRawArray(player->SkinNameRaw);
-	UInt32 i;
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) {
-		if (!Entities_List[i]) continue;
-		if (Entities_List[i]->EntityType != ENTITY_TYPE_PLAYER) continue;
+	Int32 i;
+	for (i = 0; i < Entities_ActiveCount; i++) {
+		struct Entity* entity = Entities_List[Entities_Active[i]];
+		if (entity->EntityType != ENTITY_TYPE_PLAYER) continue;
 
-		struct Player* p = (struct Player*)Entities_List[i];
+		struct Player* p = (struct Player*)entity;
 		String pSkin = String_FromRawArray(p->SkinNameRaw);
 		if (!String_Equals(&skin, &pSkin)) continue;
 
@@ -648,28 +1137,6 @@ static void Player_ClearHat(struct Bitmap* bmp, UInt8 skinType) {
 	}
 }
 
-static void Player_EnsurePow2(struct Player* player, struct Bitmap* bmp) {
-	Int32 width  = Math_NextPowOf2(bmp->Width);
-	Int32 height = Math_NextPowOf2(bmp->Height);
-	if (width == bmp->Width && height == bmp->Height) return;
-
-	struct Bitmap scaled; Bitmap_Allocate(&scaled, width, height);
-	Int32 y;
-	UInt32 stride = (UInt32)(bmp->Width) * BITMAP_SIZEOF_PIXEL;
-	for (y = 0; y < bmp->Height; y++) {
-		UInt32* src = Bitmap_GetRow(bmp, y);
-		UInt32* dst = Bitmap_GetRow(&scaled, y);
-		Mem_Copy(dst, src, stride);
-	}
-
-	struct Entity* entity = &player->Base;
-	entity->uScale = (Real32)bmp->Width  / width;
-	entity->vScale = (Real32)bmp->Height / height;
-
-	Mem_Free(&bmp->Scan0);
-	*bmp = scaled;
-}
-
 static void Player_CheckSkin(struct Player* player) {
 	struct Entity* entity = &player->Base;
 	String skin = String_FromRawArray(player->SkinNameRaw);
@@ -684,33 +1151,41 @@ static void Player_CheckSkin(struct Player* player) {
 		player->FetchedSkin = true;
 	}
 
+	if (player_skinUploadsLeft <= 0) return;
 	struct AsyncRequest item;
 	if (!AsyncDownloader_Get(&skin, &item)) return;
 	if (!item.ResultData) { Player_SetSkinAll(player, true); return; }
 
-	String url = String_FromRawArray(item.URL);
-	struct Stream mem; struct Bitmap bmp;
-	Stream_ReadonlyMemory(&mem, item.ResultData, item.ResultSize);
-
-	ReturnCode res = Bitmap_DecodePng(&bmp, &mem);
-	if (res) {
-		Chat_LogError(res, "decoding", &url);
-		Mem_Free(&bmp.Scan0);
+	if (item.ImageResult) {
+		String url = String_FromRawArray(item.URL);
+		Chat_LogError(item.ImageResult, "decoding", &url);
+		ASyncRequest_Free(&item);
 		return;
 	}
 
-	Gfx_DeleteTexture(&entity->TextureId);
+	struct Bitmap bmp = item.Image;
+	Player_DeleteSkinTexture(player);
 	Player_SetSkinAll(player, true);
-	Player_EnsurePow2(player, &bmp);
+	entity->uScale = (Real32)item.ImageWidth  / bmp.Width;
+	entity->vScale = (Real32)item.ImageHeight / bmp.Height;
 	entity->SkinType = Utils_GetSkinType(&bmp);
 
 	if (entity->SkinType == SKIN_TYPE_INVALID) {
 		Player_SetSkinAll(player, true);
 	} else {
-		if (entity->Model->UsesHumanSkin) {
-			Player_ClearHat(&bmp, entity->SkinType);
+		/* Different skin names can still point to the same image */
+		struct Player* same = Player_FirstWithSameSkinData(player, item.DataHash);
+		if (same) {
+			entity->TextureId = same->Base.TextureId;
+		} else {
+			if (entity->Model->UsesHumanSkin) {
+				Player_ClearHat(&bmp, entity->SkinType);
+			}
+			entity->TextureId = Gfx_CreateTexture(&bmp, true, false);
+			player_skinUploadsLeft--;
 		}
-		entity->TextureId = Gfx_CreateTexture(&bmp, true, false);
+
+		player->SkinHash = item.DataHash;
 		Player_SetSkinAll(player, false);
 	}
 	Mem_Free(&bmp.Scan0);
@@ -720,7 +1195,7 @@ static void Player_Despawn(struct Entity* entity) {
 	struct Player* player = (struct Player*)entity;
 	struct Player* first = Player_FirstOtherWithSameSkin(player);
 	if (!first) {
-		Gfx_DeleteTexture(&entity->TextureId);
+		Player_DeleteSkinTexture(player);
 		Player_ResetSkin(player);
 	}
 	entity->VTABLE->ContextLost(entity);
@@ -728,7 +1203,7 @@ static void Player_Despawn(struct Entity* entity) {
 
 static void Player_ContextLost(struct Entity* entity) {
 	struct Player* player = (struct Player*)entity;
-	Gfx_DeleteTexture(&player->NameTex.ID);
+	NameAtlas_Release(&player->NameTex);
 	player->NameTex.X = 0; /* X is used as an 'empty name' flag */
 }
 
@@ -817,7 +1292,7 @@ static void LocalPlayer_SetLocation(struct Entity* entity, struct LocationUpdate
 }
 
 void LocalPlayer_Tick(struct Entity* entity, Real64 delta) {
-	if (!World_Blocks) return;
+	if (!World_Blocks || World_Streaming) return;
 	struct LocalPlayer* p = (struct LocalPlayer*)entity;
 	struct HacksComp* hacks = &p->Hacks;
 
@@ -836,9 +1311,11 @@ void LocalPlayer_Tick(struct Entity* entity, Real64 delta) {
 		Vector3 zero = Vector3_Zero; entity->Velocity = zero;
 	}
 
-	PhysicsComp_UpdateVelocityState(&p->Physics);
+	struct PhysicsEnv env;
+	PhysicsComp_QueryEnv(&p->Physics, &env);
+	PhysicsComp_UpdateVelocityState(&p->Physics, &env);
 	Vector3 headingVelocity = Vector3_RotateY3(xMoving, 0, zMoving, entity->HeadY * MATH_DEG2RAD);
-	PhysicsComp_PhysicsTick(&p->Physics, headingVelocity);
+	PhysicsComp_PhysicsTick(&p->Physics, headingVelocity, &env);
 
 	/* Fixes high jump, when holding down a movement key, jump, fly, then let go of fly key */
 	if (p->Hacks.Floating) entity->Velocity.Y = 0.0f;
@@ -994,22 +1471,44 @@ bool LocalPlayer_HandlesKey(Int32 key) {
 /*########################################################################################################################*
 *-------------------------------------------------------NetPlayer---------------------------------------------------------*
 *#########################################################################################################################*/
+/* Copies the player's current interpolation states into Entities_Hot */
+static void NetPlayer_StoreInterp(struct NetPlayer* p) {
+	EntityID id = (EntityID)(p - NetPlayers_List);
+	struct EntitiesHot* h = &Entities_Hot;
+	struct InterpState* prev = &p->Interp.Prev;
+	struct InterpState* next = &p->Interp.Next;
+
+	h->PrevX[id] = prev->Pos.X; h->PrevY[id] = prev->Pos.Y; h->PrevZ[id] = prev->Pos.Z;
+	h->NextX[id] = next->Pos.X; h->NextY[id] = next->Pos.Y; h->NextZ[id] = next->Pos.Z;
+	h->PrevHeadX[id] = prev->HeadX; h->PrevHeadY[id] = prev->HeadY;
+	h->NextHeadX[id] = next->HeadX; h->NextHeadY[id] = next->HeadY;
+	h->PrevRotX[id]  = prev->RotX;  h->PrevRotY[id]  = p->Interp.PrevRotY; h->PrevRotZ[id] = prev->RotZ;
+	h->NextRotX[id]  = next->RotX;  h->NextRotY[id]  = p->Interp.NextRotY; h->NextRotZ[id] = next->RotZ;
+}
+
 static void NetPlayer_SetLocation(struct Entity* entity, struct LocationUpdate* update, bool interpolate) {
 	struct NetPlayer* p = (struct NetPlayer*)entity;
 	NetInterpComp_SetLocation(&p->Interp, update, interpolate);
+	NetPlayer_StoreInterp(p);
 }
 
 void NetPlayer_Tick(struct Entity* entity, Real64 delta) {
 	struct NetPlayer* p = (struct NetPlayer*)entity;
 	Player_CheckSkin((struct Player*)p);
 	NetInterpComp_AdvanceState(&p->Interp);
+	NetPlayer_StoreInterp(p);
 	AnimatedComp_Update(entity, p->Interp.Prev.Pos, p->Interp.Next.Pos, delta);
 }
 
 static void NetPlayer_RenderModel(struct Entity* entity, Real64 deltaTime, Real32 t) {
 	struct NetPlayer* p = (struct NetPlayer*)entity;
-	Vector3_Lerp(&entity->Position, &p->Interp.Prev.Pos, &p->Interp.Next.Pos, t);
-	InterpComp_LerpAngles((struct InterpComp*)(&p->Interp), entity, t);
+	EntityID id = (EntityID)(p - NetPlayers_List);
+	struct EntitiesHot* h = &Entities_Hot;
+
+	/* Position and angles were already interpolated for all players by Entities_Interpolate */
+	entity->Position.X = h->X[id]; entity->Position.Y = h->Y[id]; entity->Position.Z = h->Z[id];
+	entity->HeadX = h->HeadX[id]; entity->HeadY = h->HeadY[id];
+	entity->RotX  = h->RotX[id];  entity->RotY  = h->RotY[id]; entity->RotZ = h->RotZ[id];
 
 	AnimatedComp_GetCurrent(entity, t);
 	p->ShouldRender = IModel_ShouldRender(entity);
@@ -1021,7 +1520,7 @@ static void NetPlayer_RenderName(struct Entity* entity) {
 	if (!p->ShouldRender) return;
 
 	Real32 dist = IModel_RenderDistance(entity);
-	Int32 threshold = Entities_NameMode == NAME_MODE_ALL_UNSCALED ? 8192 * 8192 : 32 * 32;
+	Int32 threshold = Entities_NameMode == NAME_MODE_ALL_UNSCALED ? 8192 * 8192 : ENTITIES_NAME_DIST * ENTITIES_NAME_DIST;
 	if (dist <= (Real32)threshold) Player_DrawName((struct Player*)p);
 }
 
@@ -1039,4 +1538,5 @@ void NetPlayer_Init(struct NetPlayer* player, STRING_PURE String* displayName, S
 	entity->VTABLE->Tick        = NetPlayer_Tick;
 	entity->VTABLE->RenderModel = NetPlayer_RenderModel;
 	entity->VTABLE->RenderName  = NetPlayer_RenderName;
+	NetPlayer_StoreInterp(player);
 }
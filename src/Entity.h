@@ -102,6 +102,28 @@ bool Entity_TouchesAnyLava(struct Entity* entity);
 bool Entity_TouchesAnyWater(struct Entity* entity);
 
 struct Entity* Entities_List[ENTITIES_MAX_COUNT];
+/* IDs of all entities in Entities_List, in ascending order. Loops over entities should use this */
+/* instead of checking every slot of Entities_List, since usually only a few slots are used. */
+EntityID Entities_Active[ENTITIES_MAX_COUNT];
+Int32 Entities_ActiveCount;
+/* Sets the entity with the given ID, replacing any existing entity with that ID. */
+void Entities_Add(EntityID id, struct Entity* entity);
+
+/* Hot per-entity fields, stored as one array per field indexed by entity ID. Loops over all entities */
+/* then walk contiguous memory, instead of touching a whole struct Entity for a few fields of it. */
+struct EntitiesHot {
+	/* Previous and next interpolation states of network players. */
+	Real32 PrevX[ENTITIES_SELF_ID], PrevY[ENTITIES_SELF_ID], PrevZ[ENTITIES_SELF_ID];
+	Real32 NextX[ENTITIES_SELF_ID], NextY[ENTITIES_SELF_ID], NextZ[ENTITIES_SELF_ID];
+	Real32 PrevHeadX[ENTITIES_SELF_ID], PrevHeadY[ENTITIES_SELF_ID], PrevRotX[ENTITIES_SELF_ID], PrevRotY[ENTITIES_SELF_ID], PrevRotZ[ENTITIES_SELF_ID];
+	Real32 NextHeadX[ENTITIES_SELF_ID], NextHeadY[ENTITIES_SELF_ID], NextRotX[ENTITIES_SELF_ID], NextRotY[ENTITIES_SELF_ID], NextRotZ[ENTITIES_SELF_ID];
+	/* Interpolated position and orientation of network players, computed by Entities_Interpolate. */
+	Real32 X[ENTITIES_SELF_ID], Y[ENTITIES_SELF_ID], Z[ENTITIES_SELF_ID];
+	Real32 HeadX[ENTITIES_SELF_ID], HeadY[ENTITIES_SELF_ID], RotX[ENTITIES_SELF_ID], RotY[ENTITIES_SELF_ID], RotZ[ENTITIES_SELF_ID];
+};
+struct EntitiesHot Entities_Hot;
+/* Interpolates position and orientation of all network players in one pass over Entities_Hot. */
+void Entities_Interpolate(Real32 t);
 void Entities_Tick(struct ScheduledTask* task);
 void Entities_RenderModels(Real64 delta, Real32 t);
 void Entities_RenderNames(Real64 delta);
@@ -109,7 +131,16 @@ void Entities_RenderHoveredNames(Real64 delta);
 void Entities_Init(void);
 void Entities_Free(void);
 void Entities_Remove(EntityID id);
+/* Returns ID of the closest entity (other than the local player) the given entity is looking at. */
 EntityID Entities_GetCloset(struct Entity* src);
+/* Retrieves IDs (in ascending order) of entities whose position may be within the given horizontal distance. */
+/* NOTE: May return some entities further away than that, so distance still needs to be checked. */
+Int32 Entities_QueryRadius(Vector3 pos, Real32 radius, EntityID* ids);
+struct EntitiesBenchResult { Int32 GridMicros, ScanMicros, Rebuilds; bool Same; };
+/* Temporarily replaces all entities with the given number of generated ones, which wander around for the */
+/* given number of ticks. Each tick, neighbours of every entity are found with the grid and by checking all */
+/* other entities, so both can be compared as the number of entities grows. */
+void Entities_Benchmark(Int32 count, Int32 ticks, struct EntitiesBenchResult* result);
 void Entities_DrawShadows(void);
 
 #define TABLIST_MAX_NAMES 256
@@ -129,7 +160,7 @@ void TabList_MakeComponent(struct IGameComponent* comp);
 
 
 #define Player_Layout struct Entity Base; UInt8 DisplayNameRaw[String_BufferSize(STRING_SIZE)]; \
-UChar SkinNameRaw[String_BufferSize(STRING_SIZE)]; bool FetchedSkin; struct Texture NameTex;
+UChar SkinNameRaw[String_BufferSize(STRING_SIZE)]; bool FetchedSkin; struct Texture NameTex; UInt32 SkinHash;
 
 /* Represents a player entity. */
 struct Player { Player_Layout };
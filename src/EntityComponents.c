@@ -464,6 +464,24 @@ void LocalInterpComp_AdvanceState(struct InterpComp* interp) {
 Real32 ShadowComponent_radius, shadowComponent_uvScale;
 struct ShadowData { Real32 Y; BlockID Block; UInt8 A; };
 
+/* Shadows of all entities are gathered into one array, which is only drawn once it fills up or at the end of the frame. */
+#define SHADOW_MAX_VERTICES 8192
+#define SHADOW_ENTITY_VERTICES 128
+VertexP3fT2fC4b shadowComponent_vertices[SHADOW_MAX_VERTICES];
+Int32 shadowComponent_count;
+
+/* Result of probing a column of blocks for shadow receivers, cached until the entity moves to another column,
+or until blocks in the world change. Only the block in the topmost cell can end up above the entity,
+so one more than the maximum of 4 receivers is enough to handle the entity moving up or down within that cell. */
+#define SHADOW_MAX_HITS 5
+struct ShadowHit { Real32 Y; BlockID Block; };
+struct ShadowColumn {
+	Int32 X, Y, Z; UInt32 Version;
+	UInt8 Count; struct ShadowHit Hits[SHADOW_MAX_HITS];
+};
+struct ShadowColumn shadowComponent_columns[ENTITIES_MAX_COUNT][4];
+UInt32 shadowComponent_version = 1;
+
 bool lequal(Real32 a, Real32 b) { return a < b || Math_AbsF(a - b) < 0.001f; }
 static void ShadowComponent_DrawCoords(VertexP3fT2fC4b** vertices, struct Entity* entity, struct ShadowData* data, Real32 x1, Real32 z1, Real32 x2, Real32 z2) {
 	Vector3 cen = entity->Position;
@@ -538,17 +556,18 @@ static void ShadowComponent_CalcAlpha(Real32 playerY, struct ShadowData* data) {
 	else data->Y += 1.0f / 4.0f;
 }
 
-static bool ShadowComponent_GetBlocks(struct Entity* entity, Int32 x, Int32 y, Int32 z, struct ShadowData* data) {
-	Int32 count;
-	struct ShadowData zeroData = { 0 };
-	for (count = 0; count < 4; count++) { data[count] = zeroData; }
-	count = 0;
+#define ShadowComponent_IsFull(block) (Block_MinBB[block].X == 0.0f && Block_MaxBB[block].X == 1.0f &&\
+	Block_MinBB[block].Z == 0.0f && Block_MaxBB[block].Z == 1.0f)
 
-	struct ShadowData* cur = data;
-	Real32 posY = entity->Position.Y;
+static void ShadowComponent_ProbeColumn(struct ShadowColumn* col, Int32 x, Int32 y, Int32 z) {
+	col->X = x; col->Y = y; col->Z = z;
+	col->Version = shadowComponent_version;
+	col->Count = 0;
+
+	Int32 top = y;
 	bool outside = x < 0 || z < 0 || x >= World_Width || z >= World_Length;
 
-	while (y >= 0 && count < 4) {
+	while (y >= 0 && col->Count < SHADOW_MAX_HITS) {
 		BlockID block;
 		if (!outside) {
 			block = World_GetBlock(x, y, z);
@@ -563,18 +582,42 @@ static bool ShadowComponent_GetBlocks(struct Entity* entity, Int32 x, Int32 y, I
 
 		UInt8 draw = Block_Draw[block];
 		if (draw == DRAW_GAS || draw == DRAW_SPRITE || Block_IsLiquid[block]) continue;
-		Real32 blockY = (y + 1.0f) + Block_MaxBB[block].Y;
-		if (blockY >= posY + 0.01f) continue;
 
-		cur->Block = block; cur->Y = blockY;
+		struct ShadowHit* hit = &col->Hits[col->Count++];
+		hit->Block = block; hit->Y = (y + 1.0f) + Block_MaxBB[block].Y;
+		/* Block in the topmost cell may be above the entity, so shadow might still continue past it */
+		if (y + 1 != top && ShadowComponent_IsFull(block)) return;
+	}
+}
+
+static bool ShadowComponent_GetBlocks(struct Entity* entity, struct ShadowColumn* cols, Int32 x, Int32 y, Int32 z, struct ShadowData* data) {
+	/* An entity's shadow covers at most two adjacent columns along each axis */
+	struct ShadowColumn* col = &cols[(x & 1) | ((z & 1) << 1)];
+	if (col->Version != shadowComponent_version || col->X != x || col->Y != y || col->Z != z) {
+		ShadowComponent_ProbeColumn(col, x, y, z);
+	}
+
+	Int32 i, count;
+	struct ShadowData zeroData = { 0 };
+	for (count = 0; count < 4; count++) { data[count] = zeroData; }
+	count = 0;
+
+	struct ShadowData* cur = data;
+	Real32 posY = entity->Position.Y;
+
+	for (i = 0; i < col->Count && count < 4; i++) {
+		struct ShadowHit* hit = &col->Hits[i];
+		if (hit->Y >= posY + 0.01f) continue;
+
+		cur->Block = hit->Block; cur->Y = hit->Y;
 		ShadowComponent_CalcAlpha(posY, cur);
 		count++; cur++;
 
 		/* Check if the casted shadow will continue on further down. */
-		if (Block_MinBB[block].X == 0.0f && Block_MaxBB[block].X == 1.0f &&
-			Block_MinBB[block].Z == 0.0f && Block_MaxBB[block].Z == 1.0f) return true;
+		if (ShadowComponent_IsFull(hit->Block)) return true;
 	}
 
+	/* Otherwise the probe reached the bottom of the world */
 	if (count < 4) {
 		cur->Block = WorldEnv_EdgeBlock; cur->Y = 0.0f;
 		ShadowComponent_CalcAlpha(posY, cur);
@@ -605,60 +648,61 @@ static void ShadowComponent_MakeTex(void) {
 	ShadowComponent_ShadowTex = Gfx_CreateTexture(&bmp, false, false);
 }
 
-void ShadowComponent_Draw(struct Entity* entity) {
+void ShadowComponent_Draw(EntityID id, struct Entity* entity) {
 	Vector3 Position = entity->Position;
 	if (Position.Y < 0.0f) return;
 
 	Real32 posX = Position.X, posZ = Position.Z;
 	Int32 posY = min((Int32)Position.Y, World_MaxY);
-	GfxResourceID vb;
 
 	Real32 radius = 7.0f * min(entity->ModelScale.Y, 1.0f) * entity->Model->ShadowScale;
 	ShadowComponent_radius = radius / 16.0f;
 	shadowComponent_uvScale = 16.0f / (radius * 2.0f);
 
-	VertexP3fT2fC4b vertices[128];
 	struct ShadowData data[4];
+	struct ShadowColumn* cols = shadowComponent_columns[id];
+	if (shadowComponent_count + SHADOW_ENTITY_VERTICES > SHADOW_MAX_VERTICES) ShadowComponent_Flush();
+	VertexP3fT2fC4b* ptr = &shadowComponent_vertices[shadowComponent_count];
 
-	/* TODO: Should shadow component use its own VB? */
-	VertexP3fT2fC4b* ptr = vertices;
 	if (Entities_ShadowMode == SHADOW_MODE_SNAP_TO_BLOCK) {
-		vb = GfxCommon_texVb;
 		Int32 x1 = Math_Floor(posX), z1 = Math_Floor(posZ);
-		if (!ShadowComponent_GetBlocks(entity, x1, posY, z1, data)) return;
+		if (!ShadowComponent_GetBlocks(entity, cols, x1, posY, z1, data)) return;
 
 		ShadowComponent_DrawSquareShadow(&ptr, data[0].Y, x1, z1);
 	} else {
-		vb = ModelCache_Vb;
 		Int32 x1 = Math_Floor(posX - ShadowComponent_radius), z1 = Math_Floor(posZ - ShadowComponent_radius);
 		Int32 x2 = Math_Floor(posX + ShadowComponent_radius), z2 = Math_Floor(posZ + ShadowComponent_radius);
 
-		if (ShadowComponent_GetBlocks(entity, x1, posY, z1, data) && data[0].A > 0) {
+		if (ShadowComponent_GetBlocks(entity, cols, x1, posY, z1, data) && data[0].A > 0) {
 			ShadowComponent_DrawCircle(&ptr, entity, data, (Real32)x1, (Real32)z1);
 		}
-		if (x1 != x2 && ShadowComponent_GetBlocks(entity, x2, posY, z1, data) && data[0].A > 0) {
+		if (x1 != x2 && ShadowComponent_GetBlocks(entity, cols, x2, posY, z1, data) && data[0].A > 0) {
 			ShadowComponent_DrawCircle(&ptr, entity, data, (Real32)x2, (Real32)z1);
 		}
-		if (z1 != z2 && ShadowComponent_GetBlocks(entity, x1, posY, z2, data) && data[0].A > 0) {
+		if (z1 != z2 && ShadowComponent_GetBlocks(entity, cols, x1, posY, z2, data) && data[0].A > 0) {
 			ShadowComponent_DrawCircle(&ptr, entity, data, (Real32)x1, (Real32)z2);
 		}
-		if (x1 != x2 && z1 != z2 && ShadowComponent_GetBlocks(entity, x2, posY, z2, data) && data[0].A > 0) {
+		if (x1 != x2 && z1 != z2 && ShadowComponent_GetBlocks(entity, cols, x2, posY, z2, data) && data[0].A > 0) {
 			ShadowComponent_DrawCircle(&ptr, entity, data, (Real32)x2, (Real32)z2);
 		}
 	}
+	shadowComponent_count = (Int32)(ptr - shadowComponent_vertices);
+}
 
-	if (ptr == vertices) return;
+void ShadowComponent_Flush(void) {
+	if (!shadowComponent_count) return;
 	if (!ShadowComponent_ShadowTex) ShadowComponent_MakeTex();
-
-	if (!ShadowComponent_BoundShadowTex) {
-		Gfx_BindTexture(ShadowComponent_ShadowTex);
-		ShadowComponent_BoundShadowTex = true;
+	if (!ShadowComponent_Vb) {
+		ShadowComponent_Vb = Gfx_CreateDynamicVb(VERTEX_FORMAT_P3FT2FC4B, SHADOW_MAX_VERTICES);
 	}
 
-	UInt32 vCount = (UInt32)(ptr - vertices);
-	GfxCommon_UpdateDynamicVb_IndexedTris(vb, vertices, vCount);
+	Gfx_BindTexture(ShadowComponent_ShadowTex);
+	GfxCommon_UpdateDynamicVb_IndexedTris(ShadowComponent_Vb, shadowComponent_vertices, shadowComponent_count);
+	shadowComponent_count = 0;
 }
 
+void ShadowComponent_Invalidate(void) { shadowComponent_version++; }
+
 
 /*########################################################################################################################*
 *---------------------------------------------------CollisionsComponent---------------------------------------------------*
@@ -881,8 +925,89 @@ void PhysicsComp_Init(struct PhysicsComp* comp, struct Entity* entity) {
 	comp->ServerJumpVel = 0.42f;
 }
 
-static bool PhysicsComp_TouchesLiquid(BlockID block) { return Block_Collide[block] == COLLIDE_LIQUID; }
-void PhysicsComp_UpdateVelocityState(struct PhysicsComp* comp) {
+/* Bounds checked against by part of the environment query, along with the blocks they cover */
+struct EnvBounds { struct AABB BB; Vector3I Min, Max; };
+static void EnvBounds_Init(struct EnvBounds* b) {
+	Vector3I_Floor(&b->Min, &b->BB.Min);
+	Vector3I_Floor(&b->Max, &b->BB.Max);
+}
+
+/* NOTE: Need to check block is within the covered blocks, as AABB_Intersects treats touching edges as intersecting. */
+static bool EnvBounds_Touches(struct EnvBounds* b, Int32 x, Int32 y, Int32 z, struct AABB* blockBB) {
+	return x >= b->Min.X && x <= b->Max.X && y >= b->Min.Y && y <= b->Max.Y
+		&& z >= b->Min.Z && z <= b->Max.Z && AABB_Intersects(blockBB, &b->BB);
+}
+
+void PhysicsComp_QueryEnv(struct PhysicsComp* comp, struct PhysicsEnv* env) {
+	struct Entity* entity = comp->Entity;
+	struct EnvBounds body, liquid, rope, solid, feet, rest;
+	Vector3 liqOffset = VECTOR3_CONST(0.25f / 16.0f, 0.0f / 16.0f, 0.25f / 16.0f);
+
+	Entity_GetBounds(entity, &body.BB);
+	rope.BB = body.BB; rope.BB.Max.Y += 0.5f / 16.0f;
+	AABB_Offset(&liquid.BB, &body.BB, &liqOffset);
+	solid.BB = body.BB; solid.BB.Min.Y -= 0.5f / 16.0f; /* also check block standing on */
+
+	Int32 feetY = Math_Floor(body.BB.Min.Y), bodyY = feetY + 1;
+	Int32 headY = Math_Floor(body.BB.Max.Y);
+	if (bodyY > headY) bodyY = headY;
+	feet.BB = body.BB; feet.BB.Max.Y = feet.BB.Min.Y = (Real32)feetY;
+	rest.BB = body.BB; rest.BB.Min.Y = (Real32)min(bodyY, headY); rest.BB.Max.Y = (Real32)max(bodyY, headY);
+
+	EnvBounds_Init(&body); EnvBounds_Init(&rope); EnvBounds_Init(&liquid);
+	EnvBounds_Init(&solid); EnvBounds_Init(&feet); EnvBounds_Init(&rest);
+
+	/* Walk over the blocks covered by any of the bounds */
+	Vector3I bbMin = body.Min, bbMax = body.Max;
+	Vector3I_Min(&bbMin, &bbMin, &rope.Min);   Vector3I_Max(&bbMax, &bbMax, &rope.Max);
+	Vector3I_Min(&bbMin, &bbMin, &liquid.Min); Vector3I_Max(&bbMax, &bbMax, &liquid.Max);
+	Vector3I_Min(&bbMin, &bbMin, &solid.Min);  Vector3I_Max(&bbMax, &bbMax, &solid.Max);
+	Vector3I_Min(&bbMin, &bbMin, &feet.Min);   Vector3I_Max(&bbMax, &bbMax, &feet.Max);
+	Vector3I_Min(&bbMin, &bbMin, &rest.Min);   Vector3I_Max(&bbMax, &bbMax, &rest.Max);
+
+	bbMin.X = max(bbMin.X, 0); bbMax.X = min(bbMax.X, World_MaxX);
+	bbMin.Y = max(bbMin.Y, 0); bbMax.Y = min(bbMax.Y, World_MaxY);
+	bbMin.Z = max(bbMin.Z, 0); bbMax.Z = min(bbMax.Z, World_MaxZ);
+
+	env->TouchesWater = false; env->TouchesLava = false; env->TouchesRope = false;
+	env->LiquidFeet   = false; env->LiquidRest  = false; env->UseLiquidGravity = false;
+	env->BaseModifier = MATH_POS_INF; env->SolidModifier = MATH_POS_INF;
+
+	struct AABB blockBB;
+	Vector3 v;
+	Int32 x, y, z;
+	for (y = bbMin.Y; y <= bbMax.Y; y++) { v.Y = (Real32)y;
+		for (z = bbMin.Z; z <= bbMax.Z; z++) { v.Z = (Real32)z;
+			for (x = bbMin.X; x <= bbMax.X; x++) { v.X = (Real32)x;
+				BlockID block = World_GetBlock(x, y, z);
+				Vector3_Add(&blockBB.Min, &v, &Block_MinBB[block]);
+				Vector3_Add(&blockBB.Max, &v, &Block_MaxBB[block]);
+				UInt8 collide = Block_Collide[block], extCollide = Block_ExtendedCollide[block];
+
+				if (extCollide == COLLIDE_LIQUID_WATER && EnvBounds_Touches(&liquid, x, y, z, &blockBB)) env->TouchesWater = true;
+				if (extCollide == COLLIDE_LIQUID_LAVA  && EnvBounds_Touches(&liquid, x, y, z, &blockBB)) env->TouchesLava  = true;
+				if (extCollide == COLLIDE_CLIMB_ROPE   && EnvBounds_Touches(&rope,   x, y, z, &blockBB)) env->TouchesRope  = true;
+
+				if (collide == COLLIDE_LIQUID) {
+					if (EnvBounds_Touches(&feet, x, y, z, &blockBB)) env->LiquidFeet = true;
+					if (EnvBounds_Touches(&rest, x, y, z, &blockBB)) env->LiquidRest = true;
+				}
+
+				if (block == BLOCK_AIR) continue;
+				if (EnvBounds_Touches(&solid, x, y, z, &blockBB)) {
+					env->SolidModifier = min(env->SolidModifier, Block_SpeedMultiplier[block]);
+					if (extCollide == COLLIDE_LIQUID) env->UseLiquidGravity = true;
+				}
+				if (collide != COLLIDE_SOLID && EnvBounds_Touches(&body, x, y, z, &blockBB)) {
+					env->BaseModifier = min(env->BaseModifier, Block_SpeedMultiplier[block]);
+					if (extCollide == COLLIDE_LIQUID) env->UseLiquidGravity = true;
+				}
+			}
+		}
+	}
+}
+
+void PhysicsComp_UpdateVelocityState(struct PhysicsComp* comp, struct PhysicsEnv* env) {
 	struct Entity* entity = comp->Entity;
 	struct HacksComp* hacks = comp->Hacks;
 
@@ -893,7 +1018,7 @@ void PhysicsComp_UpdateVelocityState(struct PhysicsComp* comp) {
 		entity->Velocity.Y += 0.12f * dir;
 		if (hacks->Speeding     && hacks->CanSpeed) entity->Velocity.Y += 0.12f * dir;
 		if (hacks->HalfSpeeding && hacks->CanSpeed) entity->Velocity.Y += 0.06f * dir;
-	} else if (comp->Jumping && Entity_TouchesAnyRope(entity) && entity->Velocity.Y > 0.02f) {
+	} else if (comp->Jumping && env->TouchesRope && entity->Velocity.Y > 0.02f) {
 		entity->Velocity.Y = 0.02f;
 	}
 
@@ -901,21 +1026,9 @@ void PhysicsComp_UpdateVelocityState(struct PhysicsComp* comp) {
 		comp->CanLiquidJump = false; return;
 	}
 
-	bool touchWater = Entity_TouchesAnyWater(entity);
-	bool touchLava  = Entity_TouchesAnyLava(entity);
-	if (touchWater || touchLava) {
-		struct AABB bounds; Entity_GetBounds(entity, &bounds);
-		Int32 feetY = Math_Floor(bounds.Min.Y), bodyY = feetY + 1;
-		Int32 headY = Math_Floor(bounds.Max.Y);
-		if (bodyY > headY) bodyY = headY;
-
-		bounds.Max.Y = bounds.Min.Y = feetY;
-		bool liquidFeet = Entity_TouchesAny(&bounds, PhysicsComp_TouchesLiquid);
-		bounds.Min.Y = min(bodyY, headY);
-		bounds.Max.Y = max(bodyY, headY);
-		bool liquidRest = Entity_TouchesAny(&bounds, PhysicsComp_TouchesLiquid);
-
-		bool pastJumpPoint = liquidFeet && !liquidRest && (Math_Mod1(entity->Position.Y) >= 0.4f);
+	bool touchLava = env->TouchesLava;
+	if (env->TouchesWater || touchLava) {
+		bool pastJumpPoint = env->LiquidFeet && !env->LiquidRest && (Math_Mod1(entity->Position.Y) >= 0.4f);
 		if (!pastJumpPoint) {
 			comp->CanLiquidJump = true;
 			entity->Velocity.Y += 0.04f;
@@ -935,7 +1048,7 @@ void PhysicsComp_UpdateVelocityState(struct PhysicsComp* comp) {
 		if (hacks->Speeding     && hacks->CanSpeed) entity->Velocity.Y += 0.04f;
 		if (hacks->HalfSpeeding && hacks->CanSpeed) entity->Velocity.Y += 0.02f;
 		comp->CanLiquidJump = false;
-	} else if (Entity_TouchesAnyRope(entity)) {
+	} else if (env->TouchesRope) {
 		entity->Velocity.Y += (hacks->Speeding && hacks->CanSpeed) ? 0.15f : 0.10f;
 		comp->CanLiquidJump = false;
 	} else if (entity->OnGround) {
@@ -1011,41 +1124,6 @@ static void PhysicsComp_MoveNormal(struct PhysicsComp* comp, Vector3 vel, Real32
 	PhysicsComp_Move(comp, drag, gravity, yMul);
 }
 
-static Real32 PhysicsComp_LowestModifier(struct PhysicsComp* comp, struct AABB* bounds, bool checkSolid) {
-	Vector3I bbMin, bbMax;
-	Vector3I_Floor(&bbMin, &bounds->Min);
-	Vector3I_Floor(&bbMax, &bounds->Max);
-	Real32 modifier = MATH_POS_INF;
-
-	bbMin.X = max(bbMin.X, 0); bbMax.X = min(bbMax.X, World_MaxX);
-	bbMin.Y = max(bbMin.Y, 0); bbMax.Y = min(bbMax.Y, World_MaxY);
-	bbMin.Z = max(bbMin.Z, 0); bbMax.Z = min(bbMax.Z, World_MaxZ);
-
-	struct AABB blockBB;
-	Vector3 v;
-	Int32 x, y, z;
-	for (y = bbMin.Y; y <= bbMax.Y; y++) { v.Y = (Real32)y;
-		for (z = bbMin.Z; z <= bbMax.Z; z++) { v.Z = (Real32)z;
-			for (x = bbMin.X; x <= bbMax.X; x++) { v.X = (Real32)x;
-				BlockID block = World_GetBlock(x, y, z);
-				if (block == BLOCK_AIR) continue;
-				UInt8 collide = Block_Collide[block];
-				if (collide == COLLIDE_SOLID && !checkSolid) continue;
-
-				Vector3_Add(&blockBB.Min, &v, &Block_MinBB[block]);
-				Vector3_Add(&blockBB.Max, &v, &Block_MaxBB[block]);
-				if (!AABB_Intersects(&blockBB, bounds)) continue;
-
-				modifier = min(modifier, Block_SpeedMultiplier[block]);
-				if (Block_ExtendedCollide[block] == COLLIDE_LIQUID) {
-					comp->UseLiquidGravity = true;
-				}
-			}
-		}
-	}
-	return modifier;
-}
-
 static Real32 PhysicsComp_GetSpeed(struct HacksComp* hacks, Real32 speedMul) {
 	Real32 factor = hacks->Floating ? speedMul : 1.0f, speed = factor;
 	if (hacks->Speeding     && hacks->CanSpeed) speed += factor * hacks->SpeedMultiplier;
@@ -1053,12 +1131,9 @@ static Real32 PhysicsComp_GetSpeed(struct HacksComp* hacks, Real32 speedMul) {
 	return hacks->CanSpeed ? speed : min(speed, 1.0f);
 }
 
-static Real32 PhysicsComp_GetBaseSpeed(struct PhysicsComp* comp) {
-	struct AABB bounds; Entity_GetBounds(comp->Entity, &bounds);
-	comp->UseLiquidGravity = false;
-	Real32 baseModifier = PhysicsComp_LowestModifier(comp, &bounds, false);
-	bounds.Min.Y -= 0.5f / 16.0f; /* also check block standing on */
-	Real32 solidModifier = PhysicsComp_LowestModifier(comp, &bounds, true);
+static Real32 PhysicsComp_GetBaseSpeed(struct PhysicsComp* comp, struct PhysicsEnv* env) {
+	comp->UseLiquidGravity = env->UseLiquidGravity;
+	Real32 baseModifier = env->BaseModifier, solidModifier = env->SolidModifier;
 
 	if (baseModifier == MATH_POS_INF && solidModifier == MATH_POS_INF) return 1.0f;
 	return baseModifier == MATH_POS_INF ? solidModifier : baseModifier;
@@ -1066,12 +1141,12 @@ static Real32 PhysicsComp_GetBaseSpeed(struct PhysicsComp* comp) {
 
 #define LIQUID_GRAVITY 0.02f
 #define ROPE_GRAVITY   0.034f
-void PhysicsComp_PhysicsTick(struct PhysicsComp* comp, Vector3 vel) {
+void PhysicsComp_PhysicsTick(struct PhysicsComp* comp, Vector3 vel, struct PhysicsEnv* env) {
 	struct Entity* entity = comp->Entity;
 	struct HacksComp* hacks = comp->Hacks;
 
 	if (hacks->Noclip) entity->OnGround = false;
-	Real32 baseSpeed = PhysicsComp_GetBaseSpeed(comp);
+	Real32 baseSpeed = PhysicsComp_GetBaseSpeed(comp, env);
 	Real32 verSpeed  = baseSpeed * (PhysicsComp_GetSpeed(hacks, 8.0f) / 5.0f);
 	Real32 horSpeed  = baseSpeed * PhysicsComp_GetSpeed(hacks, 8.0f / 5.0f) * hacks->BaseHorSpeed;
 	/* previously horSpeed used to be multiplied by factor of 0.02 in last case */
@@ -1089,13 +1164,13 @@ void PhysicsComp_PhysicsTick(struct PhysicsComp* comp, Vector3 vel) {
 		else if (comp->MultiJumps > 1) { horSpeed *= 93.0f; verSpeed *= 10.0f; }
 	}
 
-	if (Entity_TouchesAnyWater(entity) && !hacks->Floating) {
+	if (env->TouchesWater && !hacks->Floating) {
 		Vector3 waterDrag = VECTOR3_CONST(0.8f, 0.8f, 0.8f);
 		PhysicsComp_MoveNormal(comp, vel, 0.02f * horSpeed, waterDrag, LIQUID_GRAVITY, verSpeed);
-	} else if (Entity_TouchesAnyLava(entity) && !hacks->Floating) {
+	} else if (env->TouchesLava && !hacks->Floating) {
 		Vector3 lavaDrag = VECTOR3_CONST(0.5f, 0.5f, 0.5f);
 		PhysicsComp_MoveNormal(comp, vel, 0.02f * horSpeed, lavaDrag, LIQUID_GRAVITY, verSpeed);
-	} else if (Entity_TouchesAnyRope(entity) && !hacks->Floating) {
+	} else if (env->TouchesRope && !hacks->Floating) {
 		Vector3 ropeDrag = VECTOR3_CONST(0.5f, 0.85f, 0.5f);
 		PhysicsComp_MoveNormal(comp, vel, 0.02f * 1.7f, ropeDrag, ROPE_GRAVITY, verSpeed);
 	} else {
@@ -1158,12 +1233,13 @@ void PhysicsComp_CalculateJumpVelocity(struct PhysicsComp* comp, Real32 jumpHeig
 }
 
 void PhysicsComp_DoEntityPush(struct Entity* entity) {
-	Int32 id;
+	EntityID ids[ENTITIES_MAX_COUNT];
+	Int32 i, count = Entities_QueryRadius(entity->Position, 1.0f, ids);
 	Vector3 dir; dir.Y = 0.0f;
 
-	for (id = 0; id < ENTITIES_MAX_COUNT; id++) {
-		struct Entity* other = Entities_List[id];
-		if (!other || other == entity) continue;
+	for (i = 0; i < count; i++) {
+		struct Entity* other = Entities_List[ids[i]];
+		if (other == entity) continue;
 		if (!other->Model->Pushes) continue;
 
 		bool yIntersects =
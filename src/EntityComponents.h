@@ -100,9 +100,13 @@ void NetInterpComp_AdvanceState(struct NetInterpComp* interp);
 
 /* Entity component that draws square and circle shadows beneath entities */
 
-bool ShadowComponent_BoundShadowTex;
-GfxResourceID ShadowComponent_ShadowTex;
-void ShadowComponent_Draw(struct Entity* entity);
+GfxResourceID ShadowComponent_ShadowTex, ShadowComponent_Vb;
+/* Adds the entity's shadow to the batch of shadows to draw. */
+void ShadowComponent_Draw(EntityID id, struct Entity* entity);
+/* Draws all batched shadows. */
+void ShadowComponent_Flush(void);
+/* Discards cached probes of which blocks shadows fall onto, e.g. because blocks in the world changed. */
+void ShadowComponent_Invalidate(void);
 
 /* Entity component that performs collision detection */
 struct CollisionsComp {
@@ -124,10 +128,21 @@ struct PhysicsComp {
 	struct CollisionsComp* Collisions;
 };
 
+/* Summary of the blocks around an entity that affect its movement. */
+struct PhysicsEnv {
+	bool TouchesWater, TouchesLava, TouchesRope; /* Same as Entity_TouchesAnyWater/Lava/Rope */
+	bool LiquidFeet, LiquidRest; /* Whether liquid is at feet level, or in the rest of the body */
+	bool UseLiquidGravity;
+	/* Lowest speed modifier of non-solid blocks touched, and of all blocks touched including the one stood on */
+	Real32 BaseModifier, SolidModifier;
+};
+
 void PhysicsComp_Init(struct PhysicsComp* comp, struct Entity* entity);
-void PhysicsComp_UpdateVelocityState(struct PhysicsComp* comp);
+/* Gathers all the block information needed for a physics tick, in one pass over the blocks around the entity. */
+void PhysicsComp_QueryEnv(struct PhysicsComp* comp, struct PhysicsEnv* env);
+void PhysicsComp_UpdateVelocityState(struct PhysicsComp* comp, struct PhysicsEnv* env);
 void PhysicsComp_DoNormalJump(struct PhysicsComp* comp);
-void PhysicsComp_PhysicsTick(struct PhysicsComp* comp, Vector3 vel);
+void PhysicsComp_PhysicsTick(struct PhysicsComp* comp, Vector3 vel, struct PhysicsEnv* env);
 void PhysicsComp_CalculateJumpVelocity(struct PhysicsComp* comp, Real32 jumpHeight);
 Real64 PhysicsComp_GetMaxHeight(Real32 u);
 void PhysicsComp_DoEntityPush(struct Entity* entity);
@@ -395,6 +395,17 @@ void EnvRenderer_OnBlockChanged(Int32 x, Int32 y, Int32 z, BlockID oldBlock, Blo
 	}
 }
 
+void EnvRenderer_OnColumnChanged(Int32 x, Int32 z, Int32 maxY) {
+	Int32 index = (x * World_Length) + z;
+	Int32 height = Weather_Heightmap[index];
+	/* Same as in OnBlockChanged, changes below current rain height can be skipped */
+	/* (this also skips columns whose rain height was not calculated to begin with) */
+	if (maxY < height) return;
+
+	/* Nothing above the highest changed block can stop rain, since it was at or above old rain height */
+	EnvRenderer_CalcRainHeightAt(x, maxY, z, index);
+}
+
 static Real32 EnvRenderer_RainAlphaAt(Real32 x) {
 	/* Wolfram Alpha: fit {0,178},{1,169},{4,147},{9,114},{16,59},{25,9} */
 	Real32 falloff = 0.05f * x * x - 7 * x;
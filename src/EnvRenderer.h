@@ -17,6 +17,8 @@ bool EnvRenderer_ShouldRenderSkybox(void);
 
 Int16* Weather_Heightmap;
 void EnvRenderer_OnBlockChanged(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockID newBlock);
+/* Called after one or more blocks in the given column were changed, with maxY being the highest changed block. */
+void EnvRenderer_OnColumnChanged(Int32 x, Int32 z, Int32 maxY);
 void EnvRenderer_RenderWeather(Real64 deltaTime);
 
 bool EnvRenderer_Legacy, EnvRenderer_Minimal;
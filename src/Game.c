@@ -1,4 +1,5 @@
 #include "Game.h"
+#include "BlockPhysics.h"
 #include "Block.h"
 #include "World.h"
 #include "Lighting.h"
@@ -180,9 +181,57 @@ void Game_Disconnect(STRING_PURE String* title, STRING_PURE String* reason) {
 	}
 }
 
+Int32 game_batchDepth, game_batchCount, game_batchCapacity;
+/* Column (x + z * World_Width) and Y coordinate of each block changed while batching */
+Int32* game_batchCols;
+Int32* game_batchYs;
+
+static void Game_RefreshBlockChunks(Int32 x, Int32 y, Int32 z) {
+	Int32 cx = x >> 4, cy = y >> 4, cz = z >> 4;
+	Int32 bX = x & 0x0F, bY = y & 0x0F, bZ = z & 0x0F;
+	MapRenderer_RefreshChunk(cx, cy, cz);
+
+	/* Faces in neighbouring chunks that touch this block may now be hidden or visible */
+	if (bX == 0)  MapRenderer_RefreshChunk(cx - 1, cy, cz);
+	if (bX == 15) MapRenderer_RefreshChunk(cx + 1, cy, cz);
+	if (bY == 0)  MapRenderer_RefreshChunk(cx, cy - 1, cz);
+	if (bY == 15) MapRenderer_RefreshChunk(cx, cy + 1, cz);
+	if (bZ == 0)  MapRenderer_RefreshChunk(cx, cy, cz - 1);
+	if (bZ == 15) MapRenderer_RefreshChunk(cx, cy, cz + 1);
+}
+
+static void Game_AddBatchedBlock(Int32 x, Int32 y, Int32 z) {
+	if (game_batchCount == game_batchCapacity) {
+		game_batchCapacity = max(game_batchCapacity * 2, 512);
+		game_batchCols = Mem_Realloc(game_batchCols, game_batchCapacity, sizeof(Int32), "batched block columns");
+		game_batchYs   = Mem_Realloc(game_batchYs,   game_batchCapacity, sizeof(Int32), "batched block heights");
+	}
+
+	game_batchCols[game_batchCount] = x + z * World_Width;
+	game_batchYs[game_batchCount]   = y;
+	game_batchCount++;
+}
+
 void Game_UpdateBlock(Int32 x, Int32 y, Int32 z, BlockID block) {
+	/* physics thread may be changing blocks right now */
+	Physics_Sync();
 	BlockID oldBlock = World_GetBlock(x, y, z);
 	World_SetBlock(x, y, z, block);
+	Physics_OnBlockChanged(x, y, z, oldBlock, block);
+	Game_RefreshBlock(x, y, z, oldBlock, block);
+}
+
+void Game_RefreshBlock(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockID block) {
+	ShadowComponent_Invalidate();
+	Particles_InvalidateColumn(x, z);
+	Picking_Invalidate();
+	if (game_batchDepth) {
+		struct ChunkInfo* chunk = MapRenderer_GetChunk(x >> 4, y >> 4, z >> 4);
+		chunk->AllAir &= Block_Draw[block] == DRAW_GAS;
+		Game_RefreshBlockChunks(x, y, z);
+		Game_AddBatchedBlock(x, y, z);
+		return;
+	}
 
 	if (Weather_Heightmap) {
 		EnvRenderer_OnBlockChanged(x, y, z, oldBlock, block);
@@ -196,6 +245,83 @@ void Game_UpdateBlock(Int32 x, Int32 y, Int32 z, BlockID block) {
 	MapRenderer_RefreshChunk(cx, cy, cz);
 }
 
+void Game_BeginBlockUpdates(void) { game_batchDepth++; }
+
+static void Game_QuickSortBatch(Int32 left, Int32 right) {
+	Int32* keys = game_batchCols; Int32 key;
+	Int32* values = game_batchYs; Int32 value;
+	while (left < right) {
+		Int32 i = left, j = right;
+		Int32 pivot = keys[(i + j) / 2];
+
+		/* partition the list */
+		while (i <= j) {
+			while (pivot > keys[i]) i++;
+			while (pivot < keys[j]) j--;
+			QuickSort_Swap_KV_Maybe();
+		}
+		/* recurse into the smaller subset */
+		QuickSort_Recurse(Game_QuickSortBatch)
+	}
+}
+
+void Game_EndBlockUpdates(void) {
+	if (!game_batchDepth) return;
+	game_batchDepth--;
+	if (game_batchDepth || !game_batchCount) return;
+
+	/* Group changes by column, then update lighting/rain once for each changed column */
+	Game_QuickSortBatch(0, game_batchCount - 1);
+	Int32 i = 0;
+	while (i < game_batchCount) {
+		Int32 col = game_batchCols[i], maxY = game_batchYs[i];
+		for (i++; i < game_batchCount && game_batchCols[i] == col; i++) {
+			maxY = max(maxY, game_batchYs[i]);
+		}
+
+		Int32 x = col % World_Width, z = col / World_Width;
+		if (Weather_Heightmap) {
+			EnvRenderer_OnColumnChanged(x, z, maxY);
+		}
+		Lighting_OnColumnChanged(x, z, maxY);
+	}
+	game_batchCount = 0;
+}
+
+void Game_UpdateRows(Int32 minY, Int32 maxY) {
+	/* Shadows and particles may now fall on blocks in the new rows */
+	ShadowComponent_Invalidate();
+	Particles_ClearColumns();
+	Picking_Invalidate();
+	Int32 x, y, z;
+	/* Iterate from top down, so only the highest block in each column changes lighting/rain height */
+	for (y = maxY; y >= minY; y--) {
+		for (z = 0; z < World_Length; z++) {
+			for (x = 0; x < World_Width; x++) {
+				BlockID block = World_GetBlock(x, y, z);
+				if (block == BLOCK_AIR) continue;
+
+				if (Weather_Heightmap) {
+					EnvRenderer_OnBlockChanged(x, y, z, BLOCK_AIR, block);
+				}
+				Lighting_OnBlockChanged(x, y, z, BLOCK_AIR, block);
+			}
+		}
+	}
+
+	/* Chunks just below may have faces that are now hidden by the new rows */
+	Int32 minCy = max(0, minY - 1) >> CHUNK_SHIFT, maxCy = maxY >> CHUNK_SHIFT;
+	Int32 cx, cy, cz;
+	for (cy = minCy; cy <= maxCy; cy++) {
+		for (cz = 0; cz < MapRenderer_ChunksZ; cz++) {
+			for (cx = 0; cx < MapRenderer_ChunksX; cx++) {
+				MapRenderer_GetChunk(cx, cy, cz)->AllAir = false;
+				MapRenderer_RefreshChunk(cx, cy, cz);
+			}
+		}
+	}
+}
+
 bool Game_CanPick(BlockID block) {
 	if (Block_Draw[block] == DRAW_GAS)    return false;
 	if (Block_Draw[block] == DRAW_SPRITE) return true;
@@ -272,6 +398,8 @@ static void Game_OnResize(void* obj) {
 }
 
 static void Game_OnNewMapCore(void* obj) {
+	/* Batched block changes were for the old map */
+	game_batchCount = 0;
 	Int32 i;
 	for (i = 0; i < Game_ComponentsCount; i++) {
 		Game_Components[i].OnNewMap();
@@ -279,12 +407,18 @@ static void Game_OnNewMapCore(void* obj) {
 }
 
 static void Game_OnNewMapLoadedCore(void* obj) {
+	Picking_Invalidate();
 	Int32 i;
 	for (i = 0; i < Game_ComponentsCount; i++) {
 		Game_Components[i].OnNewMapLoaded();
 	}
 }
 
+static void Game_BlockDefChangedCore(void* obj) { Picking_Invalidate(); }
+/* Whether liquids can be picked depends on their place/delete permissions, see Game_CanPick */
+static void Game_BlockPermsChangedCore(void* obj) { Picking_Invalidate(); }
+static void Game_EnvVarChangedCore(void* obj, Int32 envVar) { Picking_Invalidate(); }
+
 static void Game_TextureChangedCore(void* obj, struct Stream* src, String* name) {
 	struct Bitmap bmp;
 	if (String_CaselessEqualsConst(name, "terrain.png")) {
@@ -427,6 +561,9 @@ void Game_Load(void) {
 	Event_RegisterVoid(&WorldEvents_NewMap,         NULL, Game_OnNewMapCore);
 	Event_RegisterVoid(&WorldEvents_MapLoaded,      NULL, Game_OnNewMapLoadedCore);
 	Event_RegisterEntry(&TextureEvents_FileChanged, NULL, Game_TextureChangedCore);
+	Event_RegisterVoid(&BlockEvents_BlockDefChanged, NULL, Game_BlockDefChangedCore);
+	Event_RegisterVoid(&BlockEvents_PermissionsChanged, NULL, Game_BlockPermsChangedCore);
+	Event_RegisterInt(&WorldEvents_EnvVarChanged,   NULL, Game_EnvVarChangedCore);
 	Event_RegisterVoid(&WindowEvents_Resized,       NULL, Game_OnResize);
 	Event_RegisterVoid(&WindowEvents_Closed,        NULL, Game_Free);
 
@@ -447,7 +584,7 @@ void Game_Load(void) {
 
 	LocalPlayer_Init(); 
 	LocalPlayer_MakeComponent(&comp); Game_AddComponent(&comp);
-	Entities_List[ENTITIES_SELF_ID] = &LocalPlayer_Instance.Base;
+	Entities_Add(ENTITIES_SELF_ID, &LocalPlayer_Instance.Base);
 
 	ChunkUpdater_Init();
 	EnvRenderer_MakeComponent(&comp);     Game_AddComponent(&comp);
@@ -461,7 +598,9 @@ void Game_Load(void) {
 	EnvRenderer_Legacy  = (flags & 1);
 	EnvRenderer_Minimal = (flags & 2);
 
-	if (!Game_IPAddress.length) {
+	if (ServerConnection_ReplayPath.length) {
+		ServerConnection_InitReplay();
+	} else if (!Game_IPAddress.length) {
 		ServerConnection_InitSingleplayer();
 	} else {
 		ServerConnection_InitMultiplayer();
@@ -513,7 +652,11 @@ void Game_Load(void) {
 
 	UChar loadTitleBuffer[String_BufferSize(STRING_SIZE)];
 	String loadTitle = String_InitAndClearArray(loadTitleBuffer);
-	String_Format2(&loadTitle, "Connecting to %s:%i..", &Game_IPAddress, &Game_Port);
+	if (ServerConnection_ReplayPath.length) {
+		String_Format1(&loadTitle, "Replaying %s..", &ServerConnection_ReplayPath);
+	} else {
+		String_Format2(&loadTitle, "Connecting to %s:%i..", &Game_IPAddress, &Game_Port);
+	}
 	String loadMsg = String_MakeNull();
 
 	Gui_FreeActive();
@@ -524,6 +667,10 @@ void Game_Load(void) {
 struct Stopwatch game_frameTimer;
 Real32 game_limitMs;
 void Game_SetFpsLimitMethod(FpsLimit method) {
+#if CC_BUILD_NULLGFX
+	/* Nothing is actually drawn, so always run as fast as possible */
+	method = FpsLimit_None;
+#endif
 	Game_FpsLimit = method;
 	game_limitMs = 0.0f;
 	Gfx_SetVSync(method == FpsLimit_VSync);
@@ -558,7 +705,7 @@ static void Game_Render3D(Real64 delta, Real32 t) {
 	Entities_RenderNames(delta);
 
 	Particles_Render(delta, t);
-	Camera_Active->GetPickedBlock(&Game_SelectedPos); /* TODO: only pick when necessary */
+	Camera_Active->GetPickedBlock(&Game_SelectedPos); /* reuses last result if nothing changed */
 
 	EnvRenderer_UpdateFog();
 	EnvRenderer_RenderSky(delta);
@@ -657,6 +804,7 @@ static void Game_RenderFrame(Real64 delta) {
 	Gfx_BindIb(GfxCommon_defaultIb);
 	Game_Accumulator += delta;
 	Game_Vertices = 0;
+	GfxCommon_StateChanges = 0; GfxCommon_StateChangesSkipped = 0;
 
 	Camera_Active->UpdateMouse();
 	if (!Window_Focused && !Gui_GetActiveScreen()->HandlesAllInput) {
@@ -670,6 +818,7 @@ static void Game_RenderFrame(Real64 delta) {
 	}
 
 	Game_DoScheduledTasks(delta);
+	Physics_Update(delta);
 	struct ScheduledTask entTask = Game_Tasks[entTaskI];
 	Real32 t = (Real32)(entTask.Accumulator / entTask.Interval);
 	LocalPlayer_SetInterpPosition(t);
@@ -703,6 +852,9 @@ void Game_Free(void* obj) {
 	Event_UnregisterVoid(&WorldEvents_NewMap,         NULL, Game_OnNewMapCore);
 	Event_UnregisterVoid(&WorldEvents_MapLoaded,      NULL, Game_OnNewMapLoadedCore);
 	Event_UnregisterEntry(&TextureEvents_FileChanged, NULL, Game_TextureChangedCore);
+	Event_UnregisterVoid(&BlockEvents_BlockDefChanged, NULL, Game_BlockDefChangedCore);
+	Event_UnregisterVoid(&BlockEvents_PermissionsChanged, NULL, Game_BlockPermsChangedCore);
+	Event_UnregisterInt(&WorldEvents_EnvVarChanged,   NULL, Game_EnvVarChangedCore);
 	Event_UnregisterVoid(&WindowEvents_Resized,       NULL, Game_OnResize);
 	Event_UnregisterVoid(&WindowEvents_Closed,        NULL, Game_Free);
 
@@ -82,6 +82,17 @@ void Game_SetViewDistance(Int32 distance, bool userDist);
 void Game_UpdateProjection(void);
 void Game_Disconnect(STRING_PURE String* title, STRING_PURE String* reason);
 void Game_UpdateBlock(Int32 x, Int32 y, Int32 z, BlockID block);
+/* Updates lighting and rendering for a block that has already been changed in the world. */
+void Game_RefreshBlock(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockID block);
+/* Starts batching block changes made through Game_UpdateBlock. Chunks are still marked as needing rebuilding
+straight away, but lighting and rain heights are only recalculated once per changed column of blocks.
+NOTE: Can be nested, the changes are only applied when the outermost Game_EndBlockUpdates is called. */
+void Game_BeginBlockUpdates(void);
+/* Applies all block changes made since the matching Game_BeginBlockUpdates. */
+void Game_EndBlockUpdates(void);
+/* Updates lighting and marks chunks as needing rebuilding, after rows minY to maxY (inclusive)
+of the world have been filled in. (e.g. while the map is still being received from the server) */
+void Game_UpdateRows(Int32 minY, Int32 maxY);
 bool Game_CanPick(BlockID block);
 bool Game_UpdateTexture(GfxResourceID* texId, struct Stream* src, STRING_PURE String* file, UInt8* skinType);
 bool Game_ValidateBitmap(STRING_PURE String* file, struct Bitmap* bmp);
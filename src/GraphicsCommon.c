@@ -15,6 +15,7 @@ String Gfx_ApiInfo[7] = {
 };
 
 void GfxCommon_Init(void) {
+	GfxCommon_ResetStateCache();
 	GfxCommon_quadVb = Gfx_CreateDynamicVb(VERTEX_FORMAT_P3FC4B, 4);
 	GfxCommon_texVb = Gfx_CreateDynamicVb(VERTEX_FORMAT_P3FT2FC4B, 4);
 
@@ -40,12 +41,78 @@ void GfxCommon_LoseContext(const UChar* reason) {
 void GfxCommon_RecreateContext(void) {
 	Gfx_LostContext = false;
 	Platform_LogConst("Recreating graphics context");
+	/* Render state was reset to defaults along with the context */
+	GfxCommon_ResetStateCache();
 
 	Event_RaiseVoid(&GfxEvents_ContextRecreated);
 	GfxCommon_Init();
 }
 
 
+/* Shadow copy of the render state last passed on to the graphics API. -1 means unknown. */
+Int8 gfx_texturing, gfx_faceCulling, gfx_alphaTest, gfx_alphaBlending, gfx_depthTest, gfx_depthWrite;
+Int32 gfx_batchFormat;
+GfxResourceID gfx_boundTexture;
+bool gfx_boundTextureKnown;
+
+void GfxCommon_ResetStateCache(void) {
+	gfx_texturing = -1; gfx_faceCulling = -1; gfx_alphaTest = -1;
+	gfx_alphaBlending = -1; gfx_depthTest = -1; gfx_depthWrite = -1;
+	gfx_batchFormat = -1;
+	GfxCommon_ResetBoundTexture();
+}
+
+void GfxCommon_ResetBoundTexture(void) { gfx_boundTextureKnown = false; }
+
+#define GfxCommon_CheckState(state, value) \
+if (state == value) { GfxCommon_StateChangesSkipped++; return; }\
+state = value; GfxCommon_StateChanges++;
+
+void Gfx_BindTexture(GfxResourceID texId) {
+	if (gfx_boundTextureKnown && gfx_boundTexture == texId) { GfxCommon_StateChangesSkipped++; return; }
+	gfx_boundTexture = texId; gfx_boundTextureKnown = true;
+	GfxCommon_StateChanges++;
+	GfxBackend_BindTexture(texId);
+}
+
+void Gfx_SetTexturing(bool enabled) {
+	GfxCommon_CheckState(gfx_texturing, enabled);
+	/* Some graphics APIs unbind the current texture when texturing is disabled */
+	if (!enabled) GfxCommon_ResetBoundTexture();
+	GfxBackend_SetTexturing(enabled);
+}
+
+void Gfx_SetFaceCulling(bool enabled) {
+	GfxCommon_CheckState(gfx_faceCulling, enabled);
+	GfxBackend_SetFaceCulling(enabled);
+}
+
+void Gfx_SetAlphaTest(bool enabled) {
+	GfxCommon_CheckState(gfx_alphaTest, enabled);
+	GfxBackend_SetAlphaTest(enabled);
+}
+
+void Gfx_SetAlphaBlending(bool enabled) {
+	GfxCommon_CheckState(gfx_alphaBlending, enabled);
+	GfxBackend_SetAlphaBlending(enabled);
+}
+
+void Gfx_SetDepthTest(bool enabled) {
+	GfxCommon_CheckState(gfx_depthTest, enabled);
+	GfxBackend_SetDepthTest(enabled);
+}
+
+void Gfx_SetDepthWrite(bool enabled) {
+	GfxCommon_CheckState(gfx_depthWrite, enabled);
+	GfxBackend_SetDepthWrite(enabled);
+}
+
+void Gfx_SetBatchFormat(Int32 vertexFormat) {
+	GfxCommon_CheckState(gfx_batchFormat, vertexFormat);
+	GfxBackend_SetBatchFormat(vertexFormat);
+}
+
+
 void GfxCommon_UpdateDynamicVb_Lines(GfxResourceID vb, void* vertices, Int32 vCount) {
 	Gfx_SetDynamicVbData(vb, vertices, vCount);
 	Gfx_DrawVb_Lines(vCount);
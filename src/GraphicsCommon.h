@@ -42,6 +42,24 @@ void GfxCommon_MakeIndices(UInt16* indices, Int32 iCount);
 void GfxCommon_SetupAlphaState(UInt8 draw);
 void GfxCommon_RestoreAlphaState(UInt8 draw);
 
+/* Number of render state changes passed on to the graphics API this frame, */
+/* and number skipped because the state was already the same. */
+Int32 GfxCommon_StateChanges, GfxCommon_StateChangesSkipped;
+/* Forgets all cached render state, so that the next change of each state is passed on to the graphics API. */
+void GfxCommon_ResetStateCache(void);
+/* Forgets which texture is bound, for when the graphics API binds a texture by itself. */
+void GfxCommon_ResetBoundTexture(void);
+
+/* Implemented by each graphics API. These are only called when the state is actually changing. */
+void GfxBackend_BindTexture(GfxResourceID texId);
+void GfxBackend_SetTexturing(bool enabled);
+void GfxBackend_SetFaceCulling(bool enabled);
+void GfxBackend_SetAlphaTest(bool enabled);
+void GfxBackend_SetAlphaBlending(bool enabled);
+void GfxBackend_SetDepthTest(bool enabled);
+void GfxBackend_SetDepthWrite(bool enabled);
+void GfxBackend_SetBatchFormat(Int32 vertexFormat);
+
 void GfxCommon_GenMipmaps(Int32 width, Int32 height, UInt8* lvlScan0, UInt8* scan0);
 Int32 GfxCommon_MipmapsLevels(Int32 width, Int32 height);
 void Texture_Render(struct Texture* tex);
@@ -6,6 +6,7 @@
 #include "GraphicsCommon.h"
 #include "GraphicsAPI.h"
 #include "Entity.h"
+#include "Platform.h"
 
 #define UV_POS_MASK ((UInt16)0x7FFF)
 #define UV_MAX ((UInt16)0x8000)
@@ -24,6 +25,243 @@ void ModelPart_Init(struct ModelPart* part, Int32 offset, Int32 count, Real32 ro
 	part->RotX = rotX; part->RotY = rotY; part->RotZ = rotZ;
 }
 
+#define IModel_RotateX t = cosX * v.Y + sinX * v.Z; v.Z = -sinX * v.Y + cosX * v.Z; v.Y = t;
+#define IModel_RotateY t = cosY * v.X - sinY * v.Z; v.Z = sinY * v.X + cosY * v.Z; v.X = t;
+#define IModel_RotateZ t = cosZ * v.X + sinZ * v.Y; v.Y = -sinZ * v.X + cosZ * v.Y; v.X = t;
+
+/* Rotates locally in IModel_Rotation order, then globally by the head angle when required. */
+#define IModel_RotateAll \
+if (IModel_Rotation == ROTATE_ORDER_ZYX) {\
+	IModel_RotateZ IModel_RotateY IModel_RotateX\
+} else if (IModel_Rotation == ROTATE_ORDER_XZY) {\
+	IModel_RotateX IModel_RotateZ IModel_RotateY\
+} else if (IModel_Rotation == ROTATE_ORDER_YZX) {\
+	IModel_RotateY IModel_RotateZ IModel_RotateX\
+}\
+if (head) {\
+	t = IModel_cosHead * v.X - IModel_sinHead * v.Z; v.Z = IModel_sinHead * v.X + IModel_cosHead * v.Z; v.X = t; /* Inlined RotY */\
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------------ModelMesh-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Models whose parts are drawn from a static copy of their vertices, with each part transformed by its own matrix,
+instead of rotating and uploading every vertex of every entity each frame. Vertex colours depend on the entity's
+lighting, so each mesh keeps a few copies baked with different face colours, and evicts the least recently used. */
+#define IMODEL_MAX_MESHES 24
+#define IMODEL_MESH_VARIANTS 8
+#define IMODEL_FACE_UNKNOWN 0xFF
+
+struct ModelMeshVariant {
+	PackedCol Cols[FACE_COUNT];
+	VertexP3fT2fC4b* Vertices;
+	GfxResourceID Vb;
+	UInt32 LastUsed;
+	bool Dirty;
+};
+struct ModelMesh {
+	struct ModelVertex* Source;
+	/* Face colour each quad uses, which is its index within the part it belongs to. Parts are only known
+	once they are first drawn, so quads of parts not drawn yet are IMODEL_FACE_UNKNOWN. */
+	UInt8* Faces;
+	Int32 Count, VariantsCount;
+	/* Number of entities in a row that needed a new variant, see IModel_SetupMesh */
+	Int32 Misses;
+	struct ModelMeshVariant Variants[IMODEL_MESH_VARIANTS];
+};
+
+struct ModelMesh IModel_meshes[IMODEL_MAX_MESHES];
+Int32 IModel_meshesCount;
+UInt32 IModel_meshUses;
+struct ModelMesh* IModel_activeMesh;
+struct ModelMeshVariant* IModel_activeVariant;
+struct ModelMeshVariant* IModel_boundVariant;
+/* Entity transform multiplied by view matrix, which part transforms are applied on top of. */
+struct Matrix IModel_transform;
+bool IModel_partMatrix, IModel_texMatrix;
+Real32 IModel_texU, IModel_texV;
+
+void IModel_InitMesh(struct IModel* model) {
+	if (!model->vertices || !model->index) return;
+	if (IModel_meshesCount == IMODEL_MAX_MESHES) return;
+	Int32 i;
+	for (i = 0; i < IModel_meshesCount; i++) {
+		if (IModel_meshes[i].Source == model->vertices) return;
+	}
+
+	struct ModelMesh* mesh = &IModel_meshes[IModel_meshesCount++];
+	mesh->Source = model->vertices;
+	mesh->Count  = model->index;
+	mesh->VariantsCount = 0;
+	mesh->Misses = 0;
+
+	Int32 quads = mesh->Count / IMODEL_QUAD_VERTICES;
+	mesh->Faces = Mem_Alloc(quads, sizeof(UInt8), "model mesh faces");
+	Mem_Set(mesh->Faces, IMODEL_FACE_UNKNOWN, quads * sizeof(UInt8));
+}
+
+static struct ModelMesh* IModel_FindMesh(struct ModelVertex* vertices) {
+	Int32 i;
+	for (i = 0; i < IModel_meshesCount; i++) {
+		if (IModel_meshes[i].Source == vertices) return &IModel_meshes[i];
+	}
+	return NULL;
+}
+
+static bool IModel_VariantMatches(struct ModelMeshVariant* variant) {
+	Int32 i;
+	for (i = 0; i < FACE_COUNT; i++) {
+		if (!PackedCol_Equals(variant->Cols[i], IModel_Cols[i])) return false;
+	}
+	return true;
+}
+
+static struct ModelMeshVariant* IModel_FindVariant(struct ModelMesh* mesh) {
+	struct ModelMeshVariant* variant = IModel_activeVariant;
+	if (variant && IModel_VariantMatches(variant)) return variant;
+	Int32 i;
+
+	for (i = 0; i < mesh->VariantsCount; i++) {
+		if (IModel_VariantMatches(&mesh->Variants[i])) return &mesh->Variants[i];
+	}
+	return NULL;
+}
+
+/* Sets the colour of the given quads of the variant's vertices, from the face each quad uses */
+static void IModel_BakeVariant(struct ModelMesh* mesh, struct ModelMeshVariant* variant, Int32 quad, Int32 quads) {
+	VertexP3fT2fC4b* dst = &variant->Vertices[quad * IMODEL_QUAD_VERTICES];
+	Int32 i;
+
+	for (i = quad; i < quad + quads; i++, dst += IMODEL_QUAD_VERTICES) {
+		UInt8 face = mesh->Faces[i];
+		if (face == IMODEL_FACE_UNKNOWN) continue;
+
+		PackedCol col = variant->Cols[face];
+		dst[0].Col = col; dst[1].Col = col; dst[2].Col = col; dst[3].Col = col;
+	}
+	variant->Dirty = true;
+}
+
+static void IModel_InitVariant(struct ModelMesh* mesh, struct ModelMeshVariant* variant) {
+	variant->Vertices = Mem_Alloc(mesh->Count, sizeof(VertexP3fT2fC4b), "model mesh vertices");
+	variant->Vb = NULL;
+
+	/* UVs are in texels, and scaled to the entity's skin by the texture matrix */
+	Int32 i;
+	for (i = 0; i < mesh->Count; i++) {
+		struct ModelVertex v = mesh->Source[i];
+		VertexP3fT2fC4b* dst = &variant->Vertices[i];
+		dst->X = v.X; dst->Y = v.Y; dst->Z = v.Z;
+		dst->U = (v.U & UV_POS_MASK) - (v.U >> UV_MAX_SHIFT) * 0.01f;
+		dst->V = (v.V & UV_POS_MASK) - (v.V >> UV_MAX_SHIFT) * 0.01f;
+	}
+}
+
+static struct ModelMeshVariant* IModel_GetVariant(void) {
+	struct ModelMesh* mesh = IModel_activeMesh;
+	struct ModelMeshVariant* variant = IModel_FindVariant(mesh);
+	Int32 i;
+
+	if (!variant) {
+		if (mesh->VariantsCount < IMODEL_MESH_VARIANTS) {
+			variant = &mesh->Variants[mesh->VariantsCount++];
+			IModel_InitVariant(mesh, variant);
+		} else {
+			variant = &mesh->Variants[0];
+			for (i = 1; i < IMODEL_MESH_VARIANTS; i++) {
+				if (mesh->Variants[i].LastUsed < variant->LastUsed) variant = &mesh->Variants[i];
+			}
+		}
+
+		for (i = 0; i < FACE_COUNT; i++) { variant->Cols[i] = IModel_Cols[i]; }
+		IModel_BakeVariant(mesh, variant, 0, mesh->Count / IMODEL_QUAD_VERTICES);
+	}
+
+	variant->LastUsed = IModel_meshUses;
+	IModel_activeVariant = variant;
+	return variant;
+}
+
+/* Records the faces of a part drawn for the first time, and bakes it into every variant of the mesh */
+static void IModel_AddMeshPart(struct ModelMesh* mesh, struct ModelPart* part) {
+	Int32 i, quad = part->Offset / IMODEL_QUAD_VERTICES, quads = part->Count / IMODEL_QUAD_VERTICES;
+	for (i = 0; i < quads; i++) { mesh->Faces[quad + i] = (UInt8)i; }
+
+	for (i = 0; i < mesh->VariantsCount; i++) {
+		IModel_BakeVariant(mesh, &mesh->Variants[i], quad, quads);
+	}
+}
+
+static void IModel_DrawMeshPart(struct ModelPart* part) {
+	struct ModelMesh* mesh = IModel_activeMesh;
+	if (mesh->Faces[part->Offset / IMODEL_QUAD_VERTICES] == IMODEL_FACE_UNKNOWN) IModel_AddMeshPart(mesh, part);
+
+	struct ModelMeshVariant* variant = IModel_GetVariant();
+	Int32 count = part->Count;
+
+	if (!variant->Vb) {
+		variant->Vb = Gfx_CreateDynamicVb(VERTEX_FORMAT_P3FT2FC4B, IModel_activeMesh->Count);
+		variant->Dirty = true;
+	}
+#if CC_BUILD_GL11
+	/* All dynamic VBs share the one list, which draws from whatever vertices were last set */
+	if (IModel_boundVariant != variant) variant->Dirty = true;
+#endif
+
+	if (variant->Dirty) {
+		Gfx_SetDynamicVbData(variant->Vb, variant->Vertices, IModel_activeMesh->Count);
+		variant->Dirty = false;
+	} else if (IModel_boundVariant != variant) {
+		Gfx_BindVb(variant->Vb);
+	}
+	IModel_boundVariant = variant;
+
+	if (!IModel_texMatrix || IModel_texU != IModel_uScale || IModel_texV != IModel_vScale) {
+		struct Matrix tex; Matrix_Scale(&tex, IModel_uScale, IModel_vScale, 1.0f);
+		Gfx_SetMatrixMode(MATRIX_TYPE_TEXTURE);
+		Gfx_LoadMatrix(&tex);
+		Gfx_SetMatrixMode(MATRIX_TYPE_VIEW);
+
+		IModel_texMatrix = true;
+		IModel_texU = IModel_uScale; IModel_texV = IModel_vScale;
+	}
+	Gfx_DrawVb_IndexedTris_Range(count, part->Offset);
+}
+
+static void IModel_EndMesh(void) {
+	if (!IModel_texMatrix) return;
+	Gfx_SetMatrixMode(MATRIX_TYPE_TEXTURE);
+	Gfx_LoadIdentityMatrix();
+	Gfx_SetMatrixMode(MATRIX_TYPE_VIEW);
+	IModel_texMatrix = false;
+}
+
+void IModel_DeleteMeshVbs(void) {
+	Int32 i, j;
+	for (i = 0; i < IModel_meshesCount; i++) {
+		struct ModelMesh* mesh = &IModel_meshes[i];
+		for (j = 0; j < mesh->VariantsCount; j++) {
+			Gfx_DeleteVb(&mesh->Variants[j].Vb);
+		}
+	}
+	IModel_boundVariant = NULL;
+}
+
+void IModel_FreeMeshes(void) {
+	IModel_DeleteMeshVbs();
+	Int32 i, j;
+	for (i = 0; i < IModel_meshesCount; i++) {
+		struct ModelMesh* mesh = &IModel_meshes[i];
+		for (j = 0; j < mesh->VariantsCount; j++) {
+			Mem_Free(&mesh->Variants[j].Vertices);
+		}
+		Mem_Free(&mesh->Faces);
+		mesh->VariantsCount = 0;
+	}
+	IModel_meshesCount = 0;
+}
+
 
 /*########################################################################################################################*
 *------------------------------------------------------------IModel--------------------------------------------------------*
@@ -88,7 +326,6 @@ Real32 IModel_RenderDistance(struct Entity* entity) {
 	return dx * dx + dy * dy + dz * dz;
 }
 
-struct Matrix IModel_transform;
 void IModel_Render(struct IModel* model, struct Entity* entity) {
 	Vector3 pos = entity->Position;
 	if (model->Bobbing) pos.Y += entity->Anim.BobbingModel;
@@ -96,14 +333,31 @@ void IModel_Render(struct IModel* model, struct Entity* entity) {
 	Gfx_SetBatchFormat(VERTEX_FORMAT_P3FT2FC4B);
 
 	model->GetTransform(entity, pos, &entity->Transform);
-	struct Matrix m;
-	Matrix_Mul(&m, &entity->Transform, &Gfx_View);
+	Matrix_Mul(&IModel_transform, &entity->Transform, &Gfx_View);
 
-	Gfx_LoadMatrix(&m);
+	Gfx_LoadMatrix(&IModel_transform);
 	model->DrawModel(entity);
+	IModel_EndMesh();
 	Gfx_LoadMatrix(&Gfx_View);
 }
 
+/* Entities with colours no variant was baked for yet need a new variant, replacing the least recently used one.
+If many entities in a row need one (e.g. lots of differently lit entities), the variants would just keep replacing
+each other. So past that point, entities whose colours are not cached are drawn without the mesh instead. */
+static struct ModelMesh* IModel_SetupMesh(struct IModel* model) {
+	struct ModelMesh* mesh = IModel_FindMesh(model->vertices);
+	if (!mesh) return NULL;
+
+	if (IModel_FindVariant(mesh)) {
+		mesh->Misses = 0;
+	} else if (mesh->Misses < IMODEL_MESH_VARIANTS) {
+		mesh->Misses++;
+	} else {
+		return NULL;
+	}
+	return mesh;
+}
+
 void IModel_SetupState(struct IModel* model, struct Entity* entity) {
 	model->index = 0;
 	PackedCol col = entity->VTABLE->GetCol(entity);
@@ -130,10 +384,17 @@ void IModel_SetupState(struct IModel* model, struct Entity* entity) {
 	IModel_cosHead = Math_CosF(yawDelta * MATH_DEG2RAD);
 	IModel_sinHead = Math_SinF(yawDelta * MATH_DEG2RAD);
 	IModel_ActiveModel = model;
+
+	IModel_activeVariant = NULL;
+	IModel_boundVariant = NULL;
+	IModel_activeMesh = IModel_SetupMesh(model);
+	IModel_partMatrix = false;
+	IModel_meshUses++;
 }
 
 void IModel_UpdateVB(void) {
 	struct IModel* model = IModel_ActiveModel;
+	if (!model->index) return; /* parts were drawn from the model's mesh */
 	GfxCommon_UpdateDynamicVb_IndexedTris(ModelCache_Vb, ModelCache_Vertices, model->index);
 	model->index = 0;
 }
@@ -156,6 +417,12 @@ void IModel_ApplyTexture(struct Entity* entity) {
 }
 
 void IModel_DrawPart(struct ModelPart* part) {
+	if (IModel_activeMesh) {
+		if (IModel_partMatrix) Gfx_LoadMatrix(&IModel_transform);
+		IModel_partMatrix = false;
+		IModel_DrawMeshPart(part); return;
+	}
+
 	struct IModel* model = IModel_ActiveModel;
 	struct ModelVertex* src = &model->vertices[part->Offset];
 	VertexP3fT2fC4b* dst = &ModelCache_Vertices[model->index];
@@ -173,16 +440,34 @@ void IModel_DrawPart(struct ModelPart* part) {
 	model->index += count;
 }
 
-#define IModel_RotateX t = cosX * v.Y + sinX * v.Z; v.Z = -sinX * v.Y + cosX * v.Z; v.Y = t;
-#define IModel_RotateY t = cosY * v.X - sinY * v.Z; v.Z = sinY * v.X + cosY * v.Z; v.X = t;
-#define IModel_RotateZ t = cosZ * v.X + sinZ * v.Y; v.Y = -sinZ * v.X + cosZ * v.Y; v.X = t;
-
 void IModel_DrawRotate(Real32 angleX, Real32 angleY, Real32 angleZ, struct ModelPart* part, bool head) {
 	struct IModel* model = IModel_ActiveModel;
 	Real32 cosX = Math_CosF(-angleX), sinX = Math_SinF(-angleX);
 	Real32 cosY = Math_CosF(-angleY), sinY = Math_SinF(-angleY);
 	Real32 cosZ = Math_CosF(-angleZ), sinZ = Math_SinF(-angleZ);
 	Real32 x = part->RotX, y = part->RotY, z = part->RotZ;
+	Real32 t = 0;
+
+	if (IModel_activeMesh) {
+		/* Rotating each basis vector gives the rows of the part's rotation, which is applied about its origin */
+		struct Matrix m = Matrix_Identity;
+		struct ModelVertex v;
+		v.X = 1.0f; v.Y = 0.0f; v.Z = 0.0f; IModel_RotateAll
+		m.Row0.X = v.X; m.Row0.Y = v.Y; m.Row0.Z = v.Z;
+		v.X = 0.0f; v.Y = 1.0f; v.Z = 0.0f; IModel_RotateAll
+		m.Row1.X = v.X; m.Row1.Y = v.Y; m.Row1.Z = v.Z;
+		v.X = 0.0f; v.Y = 0.0f; v.Z = 1.0f; IModel_RotateAll
+		m.Row2.X = v.X; m.Row2.Y = v.Y; m.Row2.Z = v.Z;
+
+		m.Row3.X = x - (x * m.Row0.X + y * m.Row1.X + z * m.Row2.X);
+		m.Row3.Y = y - (x * m.Row0.Y + y * m.Row1.Y + z * m.Row2.Y);
+		m.Row3.Z = z - (x * m.Row0.Z + y * m.Row1.Z + z * m.Row2.Z);
+
+		Matrix_Mul(&m, &m, &IModel_transform);
+		Gfx_LoadMatrix(&m);
+		IModel_partMatrix = true;
+		IModel_DrawMeshPart(part); return;
+	}
 
 	struct ModelVertex* src = &model->vertices[part->Offset];
 	VertexP3fT2fC4b* dst = &ModelCache_Vertices[model->index];
@@ -191,27 +476,7 @@ void IModel_DrawRotate(Real32 angleX, Real32 angleY, Real32 angleZ, struct Model
 	for (i = 0; i < count; i++) {
 		struct ModelVertex v = *src;
 		v.X -= x; v.Y -= y; v.Z -= z;
-		Real32 t = 0;
-
-		/* Rotate locally */
-		if (IModel_Rotation == ROTATE_ORDER_ZYX) {
-			IModel_RotateZ
-			IModel_RotateY
-			IModel_RotateX
-		} else if (IModel_Rotation == ROTATE_ORDER_XZY) {
-			IModel_RotateX
-			IModel_RotateZ
-			IModel_RotateY
-		} else if (IModel_Rotation == ROTATE_ORDER_YZX) {
-			IModel_RotateY
-			IModel_RotateZ
-			IModel_RotateX
-		}
-
-		/* Rotate globally */
-		if (head) {
-			t = IModel_cosHead * v.X - IModel_sinHead * v.Z; v.Z = IModel_sinHead * v.X + IModel_cosHead * v.Z; v.X = t; /* Inlined RotY */
-		}
+		IModel_RotateAll
 		dst->X = v.X + x; dst->Y = v.Y + y; dst->Z = v.Z + z;
 		dst->Col = IModel_Cols[i >> 2];
 
@@ -243,12 +508,13 @@ void IModel_RenderArm(struct IModel* model, struct Entity* entity) {
 	struct Matrix m; 
 	Entity_GetTransform(entity, pos, entity->ModelScale, &m);
 	Matrix_Mul(&m, &m,  &Gfx_View);
-	Matrix_Mul(&m, &translate, &m);
+	Matrix_Mul(&IModel_transform, &translate, &m);
 
-	Gfx_LoadMatrix(&m);
+	Gfx_LoadMatrix(&IModel_transform);
 	IModel_Rotation = ROTATE_ORDER_YZX;
 	model->DrawArm(entity);
 	IModel_Rotation = ROTATE_ORDER_ZYX;
+	IModel_EndMesh();
 	Gfx_LoadMatrix(&Gfx_View);
 }
 
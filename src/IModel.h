@@ -80,6 +80,10 @@ void IModel_DrawPart(struct ModelPart* part);
 void IModel_DrawRotate(Real32 angleX, Real32 angleY, Real32 angleZ, struct ModelPart* part, bool head);
 void IModel_RenderArm(struct IModel* model, struct Entity* entity);
 void IModel_DrawArmPart(struct ModelPart* part);
+/* Registers the model's vertices (if not already) to have its parts drawn from a static mesh. */
+void IModel_InitMesh(struct IModel* model);
+void IModel_DeleteMeshVbs(void);
+void IModel_FreeMeshes(void);
 
 /* Describes data for a box being built. */
 struct BoxDesc {
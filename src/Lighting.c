@@ -218,6 +218,33 @@ void Lighting_OnBlockChanged(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockI
 	Lighting_RefreshAffected(x, y, z, newBlock, lightH + 1, newHeight);
 }
 
+void Lighting_OnColumnChanged(Int32 x, Int32 z, Int32 maxY) {
+	Int32 index = (z * World_Width) + x;
+	Int32 lightH = Lighting_heightmap[index];
+	/* Since light wasn't checked to begin with, means column never had meshes for any of its chunks built. */
+	if (lightH == Int16_MaxValue) return;
+	/* Blocks changed below the block that stops light can't change the light height */
+	if (maxY < lightH) return;
+
+	/* Nothing above both the highest changed block and old light height blocks light */
+	Int32 startY = min(World_MaxY, max(maxY, lightH + 1));
+	Int32 newH = Lighting_CalcHeightAt(x, startY, z, index);
+	if (newH == lightH) return;
+
+	Int32 cx = x >> 4, cz = z >> 4, bX = x & 0x0F, bZ = z & 0x0F;
+	Int32 newCy = newH < 0 ? 0 : (newH + 1) >> 4;
+	Int32 oldCy = lightH < 0 ? 0 : (lightH + 1) >> 4;
+	Int32 cy, minCy = min(oldCy, newCy), maxCy = max(oldCy, newCy);
+
+	for (cy = minCy; cy <= maxCy; cy++) {
+		MapRenderer_RefreshChunk(cx, cy, cz);
+		if (bX == 0)  MapRenderer_RefreshChunk(cx - 1, cy, cz);
+		if (bX == 15) MapRenderer_RefreshChunk(cx + 1, cy, cz);
+		if (bZ == 0)  MapRenderer_RefreshChunk(cx, cy, cz - 1);
+		if (bZ == 15) MapRenderer_RefreshChunk(cx, cy, cz + 1);
+	}
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Lighting heightmap----------------------------------------------------*
@@ -22,6 +22,9 @@ void Lighting_LightHint(Int32 startX, Int32 startZ);
 /* Called when a block is changed, to update the lighting information.
 NOTE: Implementations ***MUST*** mark all chunks affected by this lighting changeas needing to be refreshed. */
 void Lighting_OnBlockChanged(Int32 x, Int32 y, Int32 z, BlockID oldBlock, BlockID newBlock);
+/* Called after one or more blocks in the given column were changed, with maxY being the highest changed block.
+NOTE: Only marks chunks affected by the change in light height. Chunks containing the blocks must be refreshed by caller. */
+void Lighting_OnColumnChanged(Int32 x, Int32 z, Int32 maxY);
 void Lighting_Refresh(void);
 
 /* Returns whether the block at the given coordinates is fully in sunlight.
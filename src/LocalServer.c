@@ -0,0 +1,401 @@
+#include "LocalServer.h"
+#include "ServerConnection.h"
+#include "Platform.h"
+#include "Stream.h"
+#include "Deflate.h"
+#include "ExtMath.h"
+#include "Options.h"
+#include "BlockID.h"
+#include "Funcs.h"
+#include "Game.h"
+#include "ErrorHandler.h"
+#include "Entity.h"
+
+/*########################################################################################################################*
+*-------------------------------------------------------Packet output-----------------------------------------------------*
+*#########################################################################################################################*/
+/* Packets for the client to read. Reset back to start whenever client has read everything. */
+UInt8* server_out;
+UInt32 server_outCapacity, server_outHead, server_outCount;
+#define SERVER_OUT_INITIAL_SIZE (4096 * 16)
+
+static UInt8* LocalServer_Alloc(UInt32 size) {
+	if (server_outHead == server_outCount) { server_outHead = 0; server_outCount = 0; }
+
+	if (server_outCount + size > server_outCapacity) {
+		UInt32 capacity = server_outCapacity ? server_outCapacity : SERVER_OUT_INITIAL_SIZE;
+		while (capacity < server_outCount + size) capacity *= 2;
+
+		if (server_out) {
+			server_out = Mem_Realloc(server_out, capacity, sizeof(UInt8), "local server output");
+		} else {
+			server_out = Mem_Alloc(capacity, sizeof(UInt8), "local server output");
+		}
+		server_outCapacity = capacity;
+	}
+
+	UInt8* data = &server_out[server_outCount];
+	server_outCount += size;
+	return data;
+}
+
+static void LocalServer_WriteString(UInt8* data, const UChar* src) {
+	Int32 i;
+	for (i = 0; i < STRING_SIZE && src[i]; i++) { data[i] = src[i]; }
+	for (; i < STRING_SIZE; i++) { data[i] = ' '; }
+}
+
+/* Coordinates are in 1/32 block units, with Y being offset by 51 (eye height in 1/32 units) */
+static void LocalServer_WriteLocation(UInt8* data, Vector3 pos, Real32 yaw) {
+	Stream_SetU16_BE(&data[0], (UInt16)(pos.X * 32));
+	Stream_SetU16_BE(&data[2], (UInt16)(pos.Y * 32 + 51));
+	Stream_SetU16_BE(&data[4], (UInt16)(pos.Z * 32));
+	data[6] = Math_Deg2Packed(yaw);
+	data[7] = 0;
+}
+
+static void LocalServer_SendMessage(UInt8 id, STRING_PURE String* text) {
+	UInt8* data = LocalServer_Alloc(66);
+	data[0] = OPCODE_MESSAGE; data[1] = id;
+
+	Int32 i;
+	for (i = 0; i < STRING_SIZE; i++) {
+		UChar c = i < text->length ? text->buffer[i] : ' ';
+		data[2 + i] = c == '%' ? '&' : c;
+	}
+}
+
+static void LocalServer_SendAddEntity(UInt8 id, const UChar* name, Vector3 pos, Real32 yaw) {
+	UInt8* data = LocalServer_Alloc(74);
+	data[0] = OPCODE_ADD_ENTITY; data[1] = id;
+	LocalServer_WriteString(&data[2], name);
+	LocalServer_WriteLocation(&data[66], pos, yaw);
+}
+
+static void LocalServer_SendTeleport(UInt8 id, Vector3 pos, Real32 yaw) {
+	UInt8* data = LocalServer_Alloc(10);
+	data[0] = OPCODE_ENTITY_TELEPORT; data[1] = id;
+	LocalServer_WriteLocation(&data[2], pos, yaw);
+}
+
+static void LocalServer_SendSetBlock(Int32 x, Int32 y, Int32 z, BlockID block) {
+	UInt8* data = LocalServer_Alloc(8);
+	data[0] = OPCODE_SET_BLOCK;
+	Stream_SetU16_BE(&data[1], x);
+	Stream_SetU16_BE(&data[3], y);
+	Stream_SetU16_BE(&data[5], z);
+	data[7] = (UInt8)block;
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------------Map-----------------------------------------------------------*
+*#########################################################################################################################*/
+Int32 server_width, server_height, server_length;
+/* Y coordinate of the top layer of grass */
+Int32 server_groundY;
+Real32 server_mapProgress;
+UInt8 server_chunk[1024];
+UInt32 server_chunkUsed;
+
+static void LocalServer_FlushChunk(void) {
+	UInt8* data = LocalServer_Alloc(1028);
+	data[0] = OPCODE_LEVEL_DATA;
+	Stream_SetU16_BE(&data[1], server_chunkUsed);
+	Mem_Copy(&data[3], server_chunk, server_chunkUsed);
+	Mem_Set(&data[3 + server_chunkUsed], 0, sizeof(server_chunk) - server_chunkUsed);
+	data[1027] = (UInt8)(server_mapProgress * 100);
+	server_chunkUsed = 0;
+}
+
+/* Splits compressed map data into level data chunk packets */
+static ReturnCode LocalServer_WriteMapData(struct Stream* stream, UInt8* data, UInt32 count, UInt32* modified) {
+	*modified = count;
+	while (count) {
+		UInt32 len = min(count, sizeof(server_chunk) - server_chunkUsed);
+		Mem_Copy(&server_chunk[server_chunkUsed], data, len);
+		server_chunkUsed += len; data += len; count -= len;
+		if (server_chunkUsed == sizeof(server_chunk)) LocalServer_FlushChunk();
+	}
+	return 0;
+}
+
+static void LocalServer_SendMap(void) {
+	UInt8* data = LocalServer_Alloc(1);
+	data[0] = OPCODE_LEVEL_BEGIN;
+
+	struct Stream chunks; Stream_Init(&chunks);
+	chunks.Write = LocalServer_WriteMapData;
+	struct Stream compStream; struct GZipState state;
+	GZip_MakeStream(&compStream, &state, &chunks);
+
+	/* Flat map, like the flatgrass generator */
+	Int32 layerSize = server_width * server_length, y;
+	UInt8* layer = Mem_Alloc(layerSize, sizeof(UInt8), "local server map layer");
+	UInt8 volume[4]; Stream_SetU32_BE(volume, layerSize * server_height);
+	ReturnCode res = Stream_Write(&compStream, volume, sizeof(volume));
+
+	for (y = 0; y < server_height && !res; y++) {
+		BlockID block = BLOCK_AIR;
+		if (y < server_groundY) block = BLOCK_DIRT;
+		if (y == server_groundY) block = BLOCK_GRASS;
+
+		server_mapProgress = (Real32)y / server_height;
+		Mem_Set(layer, (UInt8)block, layerSize);
+		res = Stream_Write(&compStream, layer, layerSize);
+	}
+
+	Mem_Free(&layer);
+	if (!res) res = compStream.Close(&compStream);
+	if (res) ErrorHandler_FailWithCode(res, "Local server - compressing map");
+	if (server_chunkUsed) LocalServer_FlushChunk();
+
+	data = LocalServer_Alloc(7);
+	data[0] = OPCODE_LEVEL_END;
+	Stream_SetU16_BE(&data[1], server_width);
+	Stream_SetU16_BE(&data[3], server_height);
+	Stream_SetU16_BE(&data[5], server_length);
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------------------Bots-----------------------------------------------------------*
+*#########################################################################################################################*/
+struct LocalBot { Vector3 Pos; Real32 Yaw; };
+/* ID 255 is reserved for the player themselves */
+struct LocalBot server_bots[255];
+Int32 server_botsCount, server_chatCount;
+Real32 server_blockRate, server_chatRate;
+Real64 server_moveAcc, server_blockAcc, server_chatAcc;
+bool server_cpe, server_spawned;
+Random server_rnd;
+#define SERVER_MOVE_INTERVAL (1.0 / 20.0)
+#define SERVER_BOT_SPEED 4.3f
+
+static void LocalServer_SpawnBots(void) {
+	Vector3 spawn = VECTOR3_CONST(server_width * 0.5f, server_groundY + 1.0f, server_length * 0.5f);
+	LocalServer_SendAddEntity(ENTITIES_SELF_ID, "Player", spawn, 0.0f);
+
+	UChar nameBuffer[String_BufferSize(STRING_SIZE)];
+	Int32 i;
+	for (i = 0; i < server_botsCount; i++) {
+		struct LocalBot* bot = &server_bots[i];
+		bot->Pos.X = Random_Float(&server_rnd) * server_width;
+		bot->Pos.Y = server_groundY + 1.0f;
+		bot->Pos.Z = Random_Float(&server_rnd) * server_length;
+		bot->Yaw   = Random_Float(&server_rnd) * 360.0f;
+
+		String name = String_InitAndClearArray(nameBuffer);
+		String_Format1(&name, "Bot%i", &i);
+		LocalServer_SendAddEntity((UInt8)i, name.buffer, bot->Pos, bot->Yaw);
+	}
+	server_spawned = true;
+}
+
+static void LocalServer_MoveBots(void) {
+	Real32 dist = (Real32)(SERVER_BOT_SPEED * SERVER_MOVE_INTERVAL);
+	Int32 i;
+	for (i = 0; i < server_botsCount; i++) {
+		struct LocalBot* bot = &server_bots[i];
+		bot->Yaw += (Random_Float(&server_rnd) - 0.5f) * 30.0f;
+
+		Real32 yawRad = bot->Yaw * MATH_DEG2RAD;
+		bot->Pos.X += (Real32)Math_Sin(yawRad) * dist;
+		bot->Pos.Z -= (Real32)Math_Cos(yawRad) * dist;
+
+		/* Turn around when walking off the edge of the map */
+		if (bot->Pos.X < 0.0f || bot->Pos.X >= server_width || bot->Pos.Z < 0.0f || bot->Pos.Z >= server_length) {
+			Math_Clamp(bot->Pos.X, 0.0f, server_width  - 0.01f);
+			Math_Clamp(bot->Pos.Z, 0.0f, server_length - 0.01f);
+			bot->Yaw += 180.0f;
+		}
+		if (bot->Yaw >= 360.0f) bot->Yaw -= 360.0f;
+		if (bot->Yaw < 0.0f)    bot->Yaw += 360.0f;
+
+		LocalServer_SendTeleport((UInt8)i, bot->Pos, bot->Yaw);
+	}
+}
+
+static void LocalServer_ChangeBlocks(Int32 count) {
+	/* Randomly build up and tear down a few layers above the ground */
+	static BlockID blocks[5] = { BLOCK_AIR, BLOCK_STONE, BLOCK_COBBLE, BLOCK_WOOD, BLOCK_BRICK };
+	Int32 maxY = min(server_groundY + 4, server_height - 1);
+
+	while (count > 0) {
+		Int32 i, batch = server_cpe ? min(count, 256) : 1;
+		UInt8* data = NULL;
+		if (server_cpe) {
+			data = LocalServer_Alloc(1282);
+			Mem_Set(data, 0, 1282);
+			data[0] = OPCODE_BULK_BLOCK_UPDATE;
+			data[1] = (UInt8)(batch - 1);
+		}
+
+		for (i = 0; i < batch; i++) {
+			Int32 x = Random_Next(&server_rnd, server_width);
+			Int32 y = Random_Range(&server_rnd, server_groundY + 1, maxY + 1);
+			Int32 z = Random_Next(&server_rnd, server_length);
+			BlockID block = blocks[Random_Next(&server_rnd, Array_Elems(blocks))];
+
+			if (server_cpe) {
+				Stream_SetU32_BE(&data[2 + i * 4], (y * server_length + z) * server_width + x);
+				data[2 + 256 * 4 + i] = (UInt8)block;
+			} else {
+				LocalServer_SendSetBlock(x, y, z, block);
+			}
+		}
+		count -= batch;
+	}
+}
+
+static void LocalServer_BotChat(void) {
+	UChar msgBuffer[String_BufferSize(STRING_SIZE)];
+	String msg = String_InitAndClearArray(msgBuffer);
+	Int32 id = Random_Next(&server_rnd, server_botsCount);
+
+	server_chatCount++;
+	String_Format2(&msg, "&7Bot%i: &fTest message %i", &id, &server_chatCount);
+	LocalServer_SendMessage((UInt8)id, &msg);
+}
+
+void LocalServer_Tick(Real64 delta) {
+	if (!server_spawned) return;
+
+	server_moveAcc += delta;
+	while (server_moveAcc >= SERVER_MOVE_INTERVAL) {
+		LocalServer_MoveBots();
+		server_moveAcc -= SERVER_MOVE_INTERVAL;
+	}
+
+	server_blockAcc += server_blockRate * delta;
+	Int32 blocks = (Int32)server_blockAcc;
+	LocalServer_ChangeBlocks(blocks);
+	server_blockAcc -= blocks;
+
+	if (!server_botsCount) return;
+	server_chatAcc += server_chatRate * delta;
+	for (; server_chatAcc >= 1.0; server_chatAcc -= 1.0) {
+		LocalServer_BotChat();
+	}
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------------Protocol--------------------------------------------------------*
+*#########################################################################################################################*/
+const UChar* server_extensions[2] = { "BulkBlockUpdate", "TwoWayPing" };
+
+static void LocalServer_SendExtensions(void) {
+	UInt8* data = LocalServer_Alloc(67);
+	data[0] = OPCODE_EXT_INFO;
+	LocalServer_WriteString(&data[1], "Local server");
+	Stream_SetU16_BE(&data[65], Array_Elems(server_extensions));
+
+	Int32 i;
+	for (i = 0; i < Array_Elems(server_extensions); i++) {
+		data = LocalServer_Alloc(69);
+		data[0] = OPCODE_EXT_ENTRY;
+		LocalServer_WriteString(&data[1], server_extensions[i]);
+		Stream_SetU32_BE(&data[65], 1);
+	}
+}
+
+static void LocalServer_HandleLogin(UInt8* data) {
+	server_cpe = Game_UseCPE && data[130] == 0x42;
+	if (server_cpe) LocalServer_SendExtensions();
+
+	data = LocalServer_Alloc(131);
+	data[0] = OPCODE_HANDSHAKE; data[1] = 7;
+	LocalServer_WriteString(&data[2],  "Local server");
+	LocalServer_WriteString(&data[66], "Simulated players for benchmarking");
+	data[130] = 0x64; /* op */
+
+	LocalServer_SendMap();
+	LocalServer_SpawnBots();
+}
+
+static void LocalServer_HandleSetBlock(UInt8* data) {
+	Int32 x = Stream_GetU16_BE(&data[1]);
+	Int32 y = Stream_GetU16_BE(&data[3]);
+	Int32 z = Stream_GetU16_BE(&data[5]);
+	BlockID block = data[7] ? data[8] : BLOCK_AIR;
+	LocalServer_SendSetBlock(x, y, z, block);
+}
+
+static void LocalServer_HandleMessage(UInt8* data) {
+	UChar msgBuffer[String_BufferSize(STRING_SIZE * 2)];
+	String msg  = String_InitAndClearArray(msgBuffer);
+	String text = String_Init(&data[2], STRING_SIZE, STRING_SIZE);
+	String_UNSAFE_TrimEnd(&text);
+
+	String_AppendConst(&msg, "Player: ");
+	String_AppendString(&msg, &text);
+	/* NOTE: Not using 255 here, as that makes the client show it as a server message */
+	LocalServer_SendMessage(0, &msg);
+}
+
+void LocalServer_Write(UInt8* buffer, UInt32 count) {
+	while (count) {
+		UInt32 size = 0;
+		switch (buffer[0]) {
+		case OPCODE_HANDSHAKE:          size = 131; break;
+		case OPCODE_SET_BLOCK_CLIENT:   size = 9;   break;
+		case OPCODE_ENTITY_TELEPORT:    size = 10;  break;
+		case OPCODE_MESSAGE:            size = 66;  break;
+		case OPCODE_EXT_INFO:           size = 67;  break;
+		case OPCODE_EXT_ENTRY:          size = 69;  break;
+		case OPCODE_CUSTOM_BLOCK_LEVEL: size = 2;   break;
+		case OPCODE_PLAYER_CLICK:       size = 15;  break;
+		case OPCODE_TWO_WAY_PING:       size = 4;   break;
+		}
+		if (!size || size > count) {
+			Platform_LogConst("Local server - client sent invalid packet"); return;
+		}
+
+		switch (buffer[0]) {
+		case OPCODE_HANDSHAKE:        LocalServer_HandleLogin(buffer);    break;
+		case OPCODE_SET_BLOCK_CLIENT: LocalServer_HandleSetBlock(buffer); break;
+		case OPCODE_MESSAGE:          LocalServer_HandleMessage(buffer);  break;
+		case OPCODE_TWO_WAY_PING:
+			Mem_Copy(LocalServer_Alloc(size), buffer, size); break; /* echo back */
+		}
+		buffer += size; count -= size;
+	}
+}
+
+
+/*########################################################################################################################*
+*------------------------------------------------------Local server-------------------------------------------------------*
+*#########################################################################################################################*/
+UInt32 LocalServer_Available(void) { return server_outCount - server_outHead; }
+
+void LocalServer_Read(UInt8* buffer, UInt32 count, UInt32* read) {
+	count = min(count, server_outCount - server_outHead);
+	Mem_Copy(buffer, &server_out[server_outHead], count);
+	server_outHead += count;
+	*read = count;
+}
+
+void LocalServer_Start(void) {
+	server_outHead = 0; server_outCount = 0;
+	server_spawned = false; server_chatCount = 0;
+	server_moveAcc = 0.0; server_blockAcc = 0.0; server_chatAcc = 0.0;
+	/* Fixed seed, so that bots do the same thing every run */
+	Random_Init(&server_rnd, 1234567);
+
+	Int32 size     = Options_GetInt(OPT_LOCAL_SERVER_SIZE, 16, 1024, 256);
+	server_width   = size; server_length = size;
+	server_height  = 64;
+	server_groundY = server_height / 2 - 1;
+
+	server_botsCount = Options_GetInt(OPT_LOCAL_SERVER_BOTS, 0, Array_Elems(server_bots), 10);
+	server_blockRate = (Real32)Options_GetInt(OPT_LOCAL_SERVER_BLOCKS, 0, 1000000, 100);
+	server_chatRate  = (Real32)Options_GetInt(OPT_LOCAL_SERVER_CHAT,   0, 1000, 1);
+}
+
+void LocalServer_Stop(void) {
+	Mem_Free(&server_out);
+	server_outCapacity = 0;
+	server_outHead = 0; server_outCount = 0;
+	server_spawned = false;
+}
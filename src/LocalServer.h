@@ -0,0 +1,19 @@
+#ifndef CC_LOCALSERVER_H
+#define CC_LOCALSERVER_H
+#include "Core.h"
+/* Minimal in-process server speaking the classic + CPE protocol, used in place of a socket for benchmarking.
+   Serves a flat map, then simulates bots that move, chat and change blocks at configurable rates.
+   Copyright 2014-2017 ClassicalSharp | Licensed under BSD-3
+*/
+
+void LocalServer_Start(void);
+void LocalServer_Stop(void);
+/* Simulates bots, queueing up packets for the client to read. */
+void LocalServer_Tick(Real64 delta);
+/* Number of bytes of packets queued for the client to read. */
+UInt32 LocalServer_Available(void);
+/* Reads up to count bytes of queued packets. */
+void LocalServer_Read(UInt8* buffer, UInt32 count, UInt32* read);
+/* Handles complete packets sent by the client. */
+void LocalServer_Write(UInt8* buffer, UInt32 count);
+#endif
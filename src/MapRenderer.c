@@ -62,9 +62,7 @@ static void MapRenderer_RenderNormalBatch(UInt32 batch) {
 
 		Int32 offset = part.Offset + part.SpriteCount;
 		if (drawXMin && drawXMax) {
-			Gfx_SetFaceCulling(true);
 			Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[FACE_XMIN] + part.Counts[FACE_XMAX], offset);
-			Gfx_SetFaceCulling(false);
 			Game_Vertices += part.Counts[FACE_XMIN] + part.Counts[FACE_XMAX];
 		} else if (drawXMin) {
 			Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[FACE_XMIN], offset);
@@ -76,9 +74,7 @@ static void MapRenderer_RenderNormalBatch(UInt32 batch) {
 		offset += part.Counts[FACE_XMIN] + part.Counts[FACE_XMAX];
 
 		if (drawZMin && drawZMax) {
-			Gfx_SetFaceCulling(true);
 			Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[FACE_ZMIN] + part.Counts[FACE_ZMAX], offset);
-			Gfx_SetFaceCulling(false);
 			Game_Vertices += part.Counts[FACE_ZMIN] + part.Counts[FACE_ZMAX];
 		} else if (drawZMin) {
 			Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[FACE_ZMIN], offset);
@@ -90,9 +86,7 @@ static void MapRenderer_RenderNormalBatch(UInt32 batch) {
 		offset += part.Counts[FACE_ZMIN] + part.Counts[FACE_ZMAX];
 
 		if (drawYMin && drawYMax) {
-			Gfx_SetFaceCulling(true);
 			Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[FACE_YMIN] + part.Counts[FACE_YMAX], offset);
-			Gfx_SetFaceCulling(false);
 			Game_Vertices += part.Counts[FACE_YMAX] + part.Counts[FACE_YMIN];
 		} else if (drawYMin) {
 			Gfx_DrawIndexedVb_TrisT2fC4b(part.Counts[FACE_YMIN], offset);
@@ -106,7 +100,6 @@ static void MapRenderer_RenderNormalBatch(UInt32 batch) {
 		offset = part.Offset;
 		Int32 count = part.SpriteCount >> 2; /* 4 per sprite */
 
-		Gfx_SetFaceCulling(true);
 		if (info->DrawXMax || info->DrawZMin) {
 			Gfx_DrawIndexedVb_TrisT2fC4b(count, offset); Game_Vertices += count;
 		} offset += count;
@@ -122,7 +115,6 @@ static void MapRenderer_RenderNormalBatch(UInt32 batch) {
 		if (info->DrawXMax || info->DrawZMax) {
 			Gfx_DrawIndexedVb_TrisT2fC4b(count, offset); Game_Vertices += count;
 		}
-		Gfx_SetFaceCulling(false);
 	}
 }
 
@@ -134,6 +126,9 @@ void MapRenderer_RenderNormal(Real64 deltaTime) {
 
 	Int32 batch;
 	Gfx_EnableMipmaps();
+	/* Faces drawn when only one of a pair is visible all face the camera anyway, */
+	/* so face culling can be left on for the whole pass instead of toggled per chunk */
+	Gfx_SetFaceCulling(true);
 	for (batch = 0; batch < MapRenderer_1DUsedCount; batch++) {
 		if (MapRenderer_NormalPartsCount[batch] <= 0) continue;
 		if (MapRenderer_HasNormalParts[batch] || MapRenderer_CheckingNormalParts[batch]) {
@@ -142,6 +137,7 @@ void MapRenderer_RenderNormal(Real64 deltaTime) {
 			MapRenderer_CheckingNormalParts[batch] = false;
 		}
 	}
+	Gfx_SetFaceCulling(false);
 	Gfx_DisableMipmaps();
 
 	MapRenderer_CheckWeather(deltaTime);
@@ -30,6 +30,7 @@ UInt32 ModelCache_texCount, ModelCache_modelCount;
 
 static void ModelCache_ContextLost(void* obj) {
 	Gfx_DeleteVb(&ModelCache_Vb);
+	IModel_DeleteMeshVbs();
 }
 
 static void ModelCache_ContextRecreated(void* obj) {
@@ -40,6 +41,7 @@ static void ModelCache_InitModel(struct IModel* model) {
 	struct IModel* active = IModel_ActiveModel;
 	IModel_ActiveModel = model;
 	model->CreateParts();
+	IModel_InitMesh(model);
 
 	model->initalised = true;
 	model->index = 0;
@@ -1339,6 +1341,7 @@ void ModelCache_Free(void) {
 		Gfx_DeleteTexture(&tex->TexID);
 	}
 	ModelCache_ContextLost(NULL);
+	IModel_FreeMeshes();
 
 	Event_UnregisterEntry(&TextureEvents_FileChanged, NULL, ModelCache_TextureChanged);
 	Event_UnregisterVoid(&GfxEvents_ContextLost,      NULL, ModelCache_ContextLost);
@@ -8,7 +8,11 @@
 #include "Event.h"
 #include "Stream.h"
 #include <X11/Xlib.h>
+#if CC_BUILD_NULLGFX
+#include <X11/Xutil.h>
+#else
 #include <GL/glx.h>
+#endif
 
 #define _NET_WM_STATE_REMOVE 0
 #define _NET_WM_STATE_ADD    1
@@ -664,6 +668,18 @@ void Window_SetCursorVisible(bool visible) {
 	}
 }
 
+#if CC_BUILD_NULLGFX
+/* No OpenGL context is ever created, so any visual the window can be created with will do */
+static XVisualInfo GLContext_SelectVisual(struct GraphicsMode* mode) {
+	XVisualInfo info = { 0 };
+	Int32 depth = DefaultDepth(win_display, win_screen);
+	if (XMatchVisualInfo(win_display, win_screen, depth, TrueColor, &info)) return info;
+
+	info.visual = DefaultVisual(win_display, win_screen);
+	info.depth  = depth;
+	return info;
+}
+#else
 GLXContext ctx_Handle;
 typedef int (*FN_GLXSWAPINTERVAL)(int interval);
 FN_GLXSWAPINTERVAL glXSwapIntervalSGI;
@@ -775,3 +791,4 @@ static XVisualInfo GLContext_SelectVisual(struct GraphicsMode* mode) {
 	return info;
 }
 #endif
+#endif
@@ -0,0 +1,227 @@
+#include "GraphicsAPI.h"
+#include "GraphicsCommon.h"
+#include "Platform.h"
+#include "Funcs.h"
+#include "Chat.h"
+#include "Utils.h"
+
+#if CC_BUILD_NULLGFX
+/* Implements the graphics API entirely in memory, for profiling the CPU side of rendering without a GPU.
+   Nothing is drawn, but draw calls, state changes and buffer uploads are recorded and reported on exit. */
+Int32 Gfx_strideSizes[2] = GFX_STRIDE_SIZES;
+
+struct NullGfxStats {
+	Int64 Frames, DrawCalls, Vertices, StateChanges, StateChangesSkipped;
+	Int64 VbBytes, DynamicVbBytes, IbBytes, TextureBytes;
+	Int64 LiveBytes, PeakBytes;
+};
+struct NullGfxStats null_stats;
+Int64 null_startMs;
+
+struct NullTexture { Int32 Width, Height; };
+struct Matrix null_matrices[3];
+Int32 null_matrixType, null_batchStride;
+GfxResourceID null_boundVb;
+bool null_fogEnable;
+
+/* Resources are allocated with their size in bytes stored just before their data */
+#define NULL_HEADER_SIZE 8
+static GfxResourceID NullGfx_Alloc(UInt32 size, const UChar* place) {
+	UInt8* mem = Mem_Alloc(size + NULL_HEADER_SIZE, sizeof(UInt8), place);
+	*((UInt32*)mem) = size;
+
+	null_stats.LiveBytes += size;
+	null_stats.PeakBytes = max(null_stats.PeakBytes, null_stats.LiveBytes);
+	return mem + NULL_HEADER_SIZE;
+}
+
+static void NullGfx_Free(GfxResourceID* resource) {
+	if (resource == NULL || *resource == NULL) return;
+	UInt8* mem = (UInt8*)(*resource) - NULL_HEADER_SIZE;
+
+	null_stats.LiveBytes -= *((UInt32*)mem);
+	Mem_Free(&mem);
+	*resource = NULL;
+}
+#define NullGfx_Size(resource) *((UInt32*)((UInt8*)(resource) - NULL_HEADER_SIZE))
+
+static Int64 NullGfx_CurrentMs(void) {
+	DateTime now; DateTime_CurrentUTC(&now);
+	return DateTime_TotalMs(&now);
+}
+
+void Gfx_Init(void) {
+	Gfx_MinZNear = 0.1f;
+	Gfx_MaxTexWidth = 4096; Gfx_MaxTexHeight = 4096;
+	Gfx_CustomMipmapsLevels = true;
+
+	null_startMs = NullGfx_CurrentMs();
+	GfxCommon_Init();
+}
+
+static void NullGfx_Report(void) {
+	Int32 elapsedMs = (Int32)(NullGfx_CurrentMs() - null_startMs);
+	Int32 frames = (Int32)null_stats.Frames;
+	Int32 fps = elapsedMs ? (Int32)(null_stats.Frames * 1000 / elapsedMs) : 0;
+	Platform_LogConst("-- Null graphics backend report --");
+	Platform_Log3("%i frames in %i ms (%i fps)", &frames, &elapsedMs, &fps);
+	if (!frames) return;
+
+	Int32 drawCalls = (Int32)(null_stats.DrawCalls / frames);
+	Int32 vertices  = (Int32)(null_stats.Vertices  / frames);
+	Int32 changes   = (Int32)(null_stats.StateChanges / frames);
+	Int32 skipped   = (Int32)(null_stats.StateChangesSkipped / frames);
+	Platform_Log4("Per frame: %i draw calls, %i vertices, %i state changes (%i skipped)", &drawCalls, &vertices, &changes, &skipped);
+
+	Int32 vbKB = (Int32)(null_stats.VbBytes / 1024), dynamicKB = (Int32)(null_stats.DynamicVbBytes / 1024);
+	Int32 ibKB = (Int32)(null_stats.IbBytes / 1024), textureKB = (Int32)(null_stats.TextureBytes / 1024);
+	Platform_Log4("Uploaded: %i KB static vertices, %i KB dynamic vertices, %i KB indices, %i KB textures", &vbKB, &dynamicKB, &ibKB, &textureKB);
+
+	Int32 peakKB = (Int32)(null_stats.PeakBytes / 1024);
+	Platform_Log1("Peak size of buffers and textures: %i KB", &peakKB);
+}
+
+void Gfx_Free(void) {
+	NullGfx_Report();
+	GfxCommon_Free();
+}
+
+
+GfxResourceID Gfx_CreateTexture(struct Bitmap* bmp, bool managedPool, bool mipmaps) {
+	UInt32 size = Bitmap_DataSize(bmp->Width, bmp->Height);
+	GfxResourceID texId = NullGfx_Alloc(sizeof(struct NullTexture) + size, "null texture");
+	struct NullTexture* tex = (struct NullTexture*)texId;
+
+	tex->Width = bmp->Width; tex->Height = bmp->Height;
+	Mem_Copy(tex + 1, bmp->Scan0, size);
+	null_stats.TextureBytes += size;
+	return texId;
+}
+
+void Gfx_UpdateTexturePart(GfxResourceID texId, Int32 x, Int32 y, struct Bitmap* part, bool mipmaps) {
+	struct NullTexture* tex = (struct NullTexture*)texId;
+	UInt32* pixels = (UInt32*)(tex + 1);
+	Int32 row, stride = part->Width * BITMAP_SIZEOF_PIXEL;
+
+	for (row = 0; row < part->Height; row++) {
+		Mem_Copy(&pixels[(y + row) * tex->Width + x], Bitmap_GetRow(part, row), stride);
+	}
+	null_stats.TextureBytes += Bitmap_DataSize(part->Width, part->Height);
+}
+
+void GfxBackend_BindTexture(GfxResourceID texId) { }
+void Gfx_DeleteTexture(GfxResourceID* texId) { NullGfx_Free(texId); }
+void GfxBackend_SetTexturing(bool enabled) { }
+void Gfx_EnableMipmaps(void) { }
+void Gfx_DisableMipmaps(void) { }
+
+
+bool Gfx_GetFog(void) { return null_fogEnable; }
+void Gfx_SetFog(bool enabled) { null_fogEnable = enabled; }
+void Gfx_SetFogCol(PackedCol col) { }
+void Gfx_SetFogDensity(Real32 value) { }
+void Gfx_SetFogEnd(Real32 value) { }
+void Gfx_SetFogMode(Int32 fogMode) { }
+
+void GfxBackend_SetFaceCulling(bool enabled) { }
+void GfxBackend_SetAlphaTest(bool enabled) { }
+void Gfx_SetAlphaTestFunc(Int32 compareFunc, Real32 refValue) { }
+void GfxBackend_SetAlphaBlending(bool enabled) { }
+void Gfx_SetAlphaBlendFunc(Int32 srcBlendFunc, Int32 dstBlendFunc) { }
+void Gfx_SetAlphaArgBlend(bool enabled) { }
+
+void Gfx_Clear(void) { }
+void Gfx_ClearCol(PackedCol col) { }
+void GfxBackend_SetDepthTest(bool enabled) { }
+void Gfx_SetDepthTestFunc(Int32 compareFunc) { }
+void Gfx_SetColourWriteMask(bool r, bool g, bool b, bool a) { }
+void GfxBackend_SetDepthWrite(bool enabled) { }
+
+
+GfxResourceID Gfx_CreateDynamicVb(Int32 vertexFormat, Int32 maxVertices) {
+	return NullGfx_Alloc(maxVertices * Gfx_strideSizes[vertexFormat], "null dynamic vb");
+}
+
+GfxResourceID Gfx_CreateVb(void* vertices, Int32 vertexFormat, Int32 count) {
+	UInt32 size = count * Gfx_strideSizes[vertexFormat];
+	GfxResourceID vb = NullGfx_Alloc(size, "null vb");
+	Mem_Copy(vb, vertices, size);
+	null_stats.VbBytes += size;
+	return vb;
+}
+
+GfxResourceID Gfx_CreateIb(void* indices, Int32 indicesCount) {
+	UInt32 size = indicesCount * sizeof(UInt16);
+	GfxResourceID ib = NullGfx_Alloc(size, "null ib");
+	Mem_Copy(ib, indices, size);
+	null_stats.IbBytes += size;
+	return ib;
+}
+
+void Gfx_BindVb(GfxResourceID vb) { null_boundVb = vb; }
+void Gfx_BindIb(GfxResourceID ib) { }
+void Gfx_DeleteVb(GfxResourceID* vb) { NullGfx_Free(vb); }
+void Gfx_DeleteIb(GfxResourceID* ib) { NullGfx_Free(ib); }
+
+void GfxBackend_SetBatchFormat(Int32 vertexFormat) {
+	null_batchStride = Gfx_strideSizes[vertexFormat];
+}
+
+void Gfx_SetDynamicVbData(GfxResourceID vb, void* vertices, Int32 vCount) {
+	UInt32 size = min(vCount * null_batchStride, NullGfx_Size(vb));
+	Mem_Copy(vb, vertices, size);
+	null_stats.DynamicVbBytes += size;
+	null_boundVb = vb;
+}
+
+#define NullGfx_RecordDraw(verticesCount) null_stats.DrawCalls++; null_stats.Vertices += verticesCount;
+void Gfx_DrawVb_Lines(Int32 verticesCount) { NullGfx_RecordDraw(verticesCount); }
+void Gfx_DrawVb_IndexedTris_Range(Int32 verticesCount, Int32 startVertex) { NullGfx_RecordDraw(verticesCount); }
+void Gfx_DrawVb_IndexedTris(Int32 verticesCount) { NullGfx_RecordDraw(verticesCount); }
+void Gfx_DrawIndexedVb_TrisT2fC4b(Int32 verticesCount, Int32 startVertex) { NullGfx_RecordDraw(verticesCount); }
+
+
+void Gfx_SetMatrixMode(Int32 matrixType) { null_matrixType = matrixType; }
+void Gfx_LoadMatrix(struct Matrix* matrix) { null_matrices[null_matrixType] = *matrix; }
+void Gfx_LoadIdentityMatrix(void) { null_matrices[null_matrixType] = Matrix_Identity; }
+
+void Gfx_CalcOrthoMatrix(Real32 width, Real32 height, struct Matrix* matrix) {
+	Matrix_OrthographicOffCenter(matrix, 0.0f, width, height, 0.0f, -10000.0f, 10000.0f);
+}
+void Gfx_CalcPerspectiveMatrix(Real32 fov, Real32 aspect, Real32 zNear, Real32 zFar, struct Matrix* matrix) {
+	Matrix_PerspectiveFieldOfView(matrix, fov, aspect, zNear, zFar);
+}
+
+
+ReturnCode Gfx_TakeScreenshot(struct Stream* output, Int32 width, Int32 height) {
+	/* Nothing is drawn, so the screenshot is entirely black */
+	struct Bitmap bmp; Bitmap_Allocate(&bmp, width, height);
+	Mem_Set(bmp.Scan0, 0, Bitmap_DataSize(width, height));
+
+	ReturnCode res = Bitmap_EncodePng(&bmp, output);
+	Mem_Free(&bmp.Scan0);
+	return res;
+}
+
+void Gfx_MakeApiInfo(void) {
+	String_AppendConst(&Gfx_ApiInfo[0],"-- Using null graphics --");
+	String_AppendConst(&Gfx_ApiInfo[1],"Nothing is drawn, draw calls are only recorded");
+	String_Format2(&Gfx_ApiInfo[2],    "Max texture size: (%i, %i)", &Gfx_MaxTexWidth, &Gfx_MaxTexHeight);
+}
+
+bool Gfx_WarnIfNecessary(void) {
+	Chat_AddRaw("&cYou are using the null graphics backend, so nothing will be drawn.");
+	return false;
+}
+
+
+void Gfx_SetVSync(bool value) { }
+void Gfx_BeginFrame(void) { }
+void Gfx_EndFrame(void) {
+	/* Game resets these counters at the start of every frame */
+	null_stats.Frames++;
+	null_stats.StateChanges        += GfxCommon_StateChanges;
+	null_stats.StateChangesSkipped += GfxCommon_StateChangesSkipped;
+}
+void Gfx_OnWindowResize(void) { }
+#endif
@@ -0,0 +1,150 @@
+#include "OcclusionCulling.h"
+#include "ExtMath.h"
+#include "Funcs.h"
+
+struct Matrix occlusion_clip;
+Vector3 occlusion_camPos;
+/* Points closer to the camera than this are treated as being behind it. */
+#define OCCLUSION_MIN_W 0.01f
+#define OCCLUSION_EMPTY_DEPTH 1e30f
+
+struct OcclusionVertex { Real32 X, Y, Z; };
+/* Corners of each face of a box, where bit 0 of a corner is X max, bit 1 is Y max, bit 2 is Z max */
+UInt8 occlusion_faces[6][4] = {
+	{ 0, 2, 6, 4 }, { 1, 3, 7, 5 }, /* X min, X max */
+	{ 0, 1, 5, 4 }, { 2, 3, 7, 6 }, /* Y min, Y max */
+	{ 0, 1, 3, 2 }, { 4, 5, 7, 6 }, /* Z min, Z max */
+};
+
+void OcclusionCulling_Begin(struct Matrix* projection, struct Matrix* view, Vector3 cameraPos) {
+	Matrix_Mul(&occlusion_clip, view, projection);
+	occlusion_camPos = cameraPos;
+
+	Int32 i;
+	for (i = 0; i < OCCLUSION_WIDTH * OCCLUSION_HEIGHT; i++) {
+		OcclusionCulling_Depth[i] = OCCLUSION_EMPTY_DEPTH;
+	}
+}
+
+/* Projects the 8 corners of the box into depth buffer coordinates. Returns false if any are behind the camera. */
+static bool OcclusionCulling_ProjectBox(Vector3 min, Vector3 max, struct OcclusionVertex* verts) {
+	struct Matrix* m = &occlusion_clip;
+	Int32 i;
+
+	for (i = 0; i < 8; i++) {
+		Real32 x = (i & 1) ? max.X : min.X;
+		Real32 y = (i & 2) ? max.Y : min.Y;
+		Real32 z = (i & 4) ? max.Z : min.Z;
+
+		Real32 w = x * m->Row0.W + y * m->Row1.W + z * m->Row2.W + m->Row3.W;
+		if (w < OCCLUSION_MIN_W) return false;
+		Real32 invW = 1.0f / w;
+
+		Real32 clipX = x * m->Row0.X + y * m->Row1.X + z * m->Row2.X + m->Row3.X;
+		Real32 clipY = x * m->Row0.Y + y * m->Row1.Y + z * m->Row2.Y + m->Row3.Y;
+		Real32 clipZ = x * m->Row0.Z + y * m->Row1.Z + z * m->Row2.Z + m->Row3.Z;
+		verts[i].X = (1.0f + clipX * invW) * (0.5f * OCCLUSION_WIDTH);
+		verts[i].Y = (1.0f - clipY * invW) * (0.5f * OCCLUSION_HEIGHT);
+		verts[i].Z = clipZ * invW;
+	}
+	return true;
+}
+
+static Int32 OcclusionCulling_ClampX(Real32 x) {
+	if (x < 0.0f) return 0;
+	return x >= OCCLUSION_WIDTH  ? OCCLUSION_WIDTH  - 1 : (Int32)x;
+}
+
+static Int32 OcclusionCulling_ClampY(Real32 y) {
+	if (y < 0.0f) return 0;
+	return y >= OCCLUSION_HEIGHT ? OCCLUSION_HEIGHT - 1 : (Int32)y;
+}
+
+static void OcclusionCulling_DrawTriangle(struct OcclusionVertex* a, struct OcclusionVertex* b, struct OcclusionVertex* c) {
+	Real32 area = (b->X - a->X) * (c->Y - a->Y) - (b->Y - a->Y) * (c->X - a->X);
+	if (Math_AbsF(area) < 0.0001f) return;
+	/* Ensure edge functions are positive inside the triangle */
+	if (area < 0.0f) { struct OcclusionVertex* tmp = b; b = c; c = tmp; area = -area; }
+
+	Real32 minX = min(a->X, min(b->X, c->X)), maxX = max(a->X, max(b->X, c->X));
+	Real32 minY = min(a->Y, min(b->Y, c->Y)), maxY = max(a->Y, max(b->Y, c->Y));
+	if (maxX < 0.0f || maxY < 0.0f || minX >= OCCLUSION_WIDTH || minY >= OCCLUSION_HEIGHT) return;
+	Int32 x1 = OcclusionCulling_ClampX(minX), x2 = OcclusionCulling_ClampX(maxX);
+	Int32 y1 = OcclusionCulling_ClampY(minY), y2 = OcclusionCulling_ClampY(maxY);
+
+	/* Edge function of each edge is A * x + B * y + C */
+	Real32 a0 = a->Y - b->Y, b0 = b->X - a->X, c0 = -(a0 * a->X + b0 * a->Y);
+	Real32 a1 = b->Y - c->Y, b1 = c->X - b->X, c1 = -(a1 * b->X + b1 * b->Y);
+	Real32 a2 = c->Y - a->Y, b2 = a->X - c->X, c2 = -(a2 * c->X + b2 * c->Y);
+
+	Real32 dzdx = ((b->Z - a->Z) * (c->Y - a->Y) - (c->Z - a->Z) * (b->Y - a->Y)) / area;
+	Real32 dzdy = ((c->Z - a->Z) * (b->X - a->X) - (b->Z - a->Z) * (c->X - a->X)) / area;
+	/* Depth is sampled at the pixel centre, but the triangle may be further away elsewhere in the pixel */
+	Real32 bias = 0.5f * (Math_AbsF(dzdx) + Math_AbsF(dzdy));
+	Int32 x, y;
+
+	for (y = y1; y <= y2; y++) {
+		Real32 px = x1 + 0.5f, py = y + 0.5f;
+		Real32 e0Row = a0 * px + b0 * py + c0;
+		Real32 e1Row = a1 * px + b1 * py + c1;
+		Real32 e2Row = a2 * px + b2 * py + c2;
+		Real32 zRow  = a->Z + dzdx * (px - a->X) + dzdy * (py - a->Y) + bias;
+		Real32* row  = &OcclusionCulling_Depth[y * OCCLUSION_WIDTH + x1];
+		Int32 count  = x2 - x1;
+
+		/* Kept branch free, and each value is computed from x instead of being stepped, */
+		/* so that iterations don't depend on each other and the compiler can vectorise it */
+		for (x = 0; x <= count; x++) {
+			Real32 dx = (Real32)x, cur = row[x];
+			Real32 z  = zRow + dzdx * dx;
+			bool write = (e0Row + a0 * dx >= 0.0f) & (e1Row + a1 * dx >= 0.0f) & (e2Row + a2 * dx >= 0.0f) & (z < cur);
+			row[x] = write ? z : cur;
+		}
+	}
+}
+
+void OcclusionCulling_DrawOccluder(Vector3 min, Vector3 max) {
+	struct OcclusionVertex verts[8];
+	/* Clipping against the near plane is not worth it for the few boxes this affects */
+	if (!OcclusionCulling_ProjectBox(min, max, verts)) return;
+	Vector3 cam = occlusion_camPos;
+
+	bool visible[6];
+	visible[0] = cam.X < min.X; visible[1] = cam.X > max.X;
+	visible[2] = cam.Y < min.Y; visible[3] = cam.Y > max.Y;
+	visible[4] = cam.Z < min.Z; visible[5] = cam.Z > max.Z;
+	Int32 i;
+
+	for (i = 0; i < 6; i++) {
+		if (!visible[i]) continue;
+		UInt8* face = occlusion_faces[i];
+		OcclusionCulling_DrawTriangle(&verts[face[0]], &verts[face[1]], &verts[face[2]]);
+		OcclusionCulling_DrawTriangle(&verts[face[0]], &verts[face[2]], &verts[face[3]]);
+	}
+}
+
+bool OcclusionCulling_TestBox(Vector3 min, Vector3 max) {
+	struct OcclusionVertex verts[8];
+	if (!OcclusionCulling_ProjectBox(min, max, verts)) return true;
+
+	Real32 minX = verts[0].X, maxX = verts[0].X, minY = verts[0].Y, maxY = verts[0].Y, minZ = verts[0].Z;
+	Int32 i, x, y;
+	for (i = 1; i < 8; i++) {
+		minX = min(minX, verts[i].X); maxX = max(maxX, verts[i].X);
+		minY = min(minY, verts[i].Y); maxY = max(maxY, verts[i].Y);
+		minZ = min(minZ, verts[i].Z);
+	}
+	if (maxX < 0.0f || maxY < 0.0f || minX >= OCCLUSION_WIDTH || minY >= OCCLUSION_HEIGHT) return true;
+
+	/* Occluders only cover the pixels whose centres they cover, so also check the surrounding pixels */
+	Int32 x1 = OcclusionCulling_ClampX(minX - 1.0f), x2 = OcclusionCulling_ClampX(maxX + 1.0f);
+	Int32 y1 = OcclusionCulling_ClampY(minY - 1.0f), y2 = OcclusionCulling_ClampY(maxY + 1.0f);
+
+	for (y = y1; y <= y2; y++) {
+		Real32* row = &OcclusionCulling_Depth[y * OCCLUSION_WIDTH];
+		bool visible = false;
+		for (x = x1; x <= x2; x++) { visible |= row[x] >= minZ; }
+		if (visible) return true;
+	}
+	return false;
+}
@@ -0,0 +1,20 @@
+#ifndef CC_OCCLUSIONCULLING_H
+#define CC_OCCLUSIONCULLING_H
+#include "Vectors.h"
+/* Software occlusion culling, by rasterising boxes into a small depth buffer on the CPU.
+   Copyright 2014-2017 ClassicalSharp | Licensed under BSD-3
+*/
+
+#define OCCLUSION_WIDTH 256
+#define OCCLUSION_HEIGHT 128
+/* Depth of the nearest occluder at each pixel of the depth buffer. */
+Real32 OcclusionCulling_Depth[OCCLUSION_WIDTH * OCCLUSION_HEIGHT];
+
+/* Clears the depth buffer, and sets the matrices and camera position used to project boxes. */
+void OcclusionCulling_Begin(struct Matrix* projection, struct Matrix* view, Vector3 cameraPos);
+/* Rasterises the faces of the given box that face the camera into the depth buffer. */
+/* NOTE: The box must be entirely solid, as everything behind it is treated as hidden. */
+void OcclusionCulling_DrawOccluder(Vector3 min, Vector3 max);
+/* Returns whether any part of the given box might not be hidden behind occluders drawn so far. */
+bool OcclusionCulling_TestBox(Vector3 min, Vector3 max);
+#endif
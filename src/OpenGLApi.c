@@ -17,7 +17,7 @@
 #endif
 #include <GL/gl.h>
 
-#if !CC_BUILD_D3D9
+#if !CC_BUILD_D3D9 && !CC_BUILD_NULLGFX
 /* Extensions from later than OpenGL 1.1 */
 #define GL_TEXTURE_MAX_LEVEL    0x813D
 #define GL_ARRAY_BUFFER         0x8892
@@ -157,6 +157,7 @@ GfxResourceID Gfx_CreateTexture(struct Bitmap* bmp, bool managedPool, bool mipma
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bmp->Width, bmp->Height, 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, bmp->Scan0);
 
 	if (mipmaps) GL_DoMipmaps(texId, 0, 0, bmp, false);
+	GfxCommon_ResetBoundTexture();
 	return texId;
 }
 
@@ -164,9 +165,10 @@ void Gfx_UpdateTexturePart(GfxResourceID texId, Int32 x, Int32 y, struct Bitmap*
 	glBindTexture(GL_TEXTURE_2D, texId);
 	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, part->Width, part->Height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, part->Scan0);
 	if (mipmaps) GL_DoMipmaps(texId, x, y, part, true);
+	GfxCommon_ResetBoundTexture();
 }
 
-void Gfx_BindTexture(GfxResourceID texId) {
+void GfxBackend_BindTexture(GfxResourceID texId) {
 	glBindTexture(GL_TEXTURE_2D, texId);
 }
 
@@ -174,9 +176,11 @@ void Gfx_DeleteTexture(GfxResourceID* texId) {
 	if (texId == NULL || *texId == NULL) return;
 	glDeleteTextures(1, texId);
 	*texId = NULL;
+	/* Deleting the bound texture binds texture 0 instead */
+	GfxCommon_ResetBoundTexture();
 }
 
-void Gfx_SetTexturing(bool enabled) { gl_Toggle(GL_TEXTURE_2D); }
+void GfxBackend_SetTexturing(bool enabled) { gl_Toggle(GL_TEXTURE_2D); }
 void Gfx_EnableMipmaps(void) { }
 void Gfx_DisableMipmaps(void) { }
 
@@ -217,13 +221,13 @@ void Gfx_SetFogMode(Int32 mode) {
 }
 
 
-void Gfx_SetFaceCulling(bool enabled) { gl_Toggle(GL_CULL_FACE); }
-void Gfx_SetAlphaTest(bool enabled) { gl_Toggle(GL_ALPHA_TEST); }
+void GfxBackend_SetFaceCulling(bool enabled) { gl_Toggle(GL_CULL_FACE); }
+void GfxBackend_SetAlphaTest(bool enabled) { gl_Toggle(GL_ALPHA_TEST); }
 void Gfx_SetAlphaTestFunc(Int32 func, Real32 value) {
 	glAlphaFunc(gl_compare[func], value);
 }
 
-void Gfx_SetAlphaBlending(bool enabled) { gl_Toggle(GL_BLEND); }
+void GfxBackend_SetAlphaBlending(bool enabled) { gl_Toggle(GL_BLEND); }
 void Gfx_SetAlphaBlendFunc(Int32 srcFunc, Int32 dstFunc) {
 	glBlendFunc(gl_blend[srcFunc], gl_blend[dstFunc]);
 }
@@ -245,11 +249,11 @@ void Gfx_SetColourWriteMask(bool r, bool g, bool b, bool a) {
 	glColorMask(r, g, b, a);
 }
 
-void Gfx_SetDepthWrite(bool enabled) {
+void GfxBackend_SetDepthWrite(bool enabled) {
 	glDepthMask(enabled);
 }
 
-void Gfx_SetDepthTest(bool enabled) { gl_Toggle(GL_DEPTH_TEST); }
+void GfxBackend_SetDepthTest(bool enabled) { gl_Toggle(GL_DEPTH_TEST); }
 void Gfx_SetDepthTestFunc(Int32 compareFunc) {
 	glDepthFunc(gl_compare[compareFunc]);
 }
@@ -379,9 +383,7 @@ void GL_SetupVbPos3fTex2fCol4b_Range(Int32 startVertex) {
 	glTexCoordPointer(2, GL_FLOAT,        sizeof(VertexP3fT2fC4b), (void*)(offset + 16));
 }
 
-void Gfx_SetBatchFormat(Int32 vertexFormat) {
-	if (vertexFormat == gl_batchFormat) return;
-
+void GfxBackend_SetBatchFormat(Int32 vertexFormat) {
 	if (gl_batchFormat == VERTEX_FORMAT_P3FT2FC4B) {
 		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	}
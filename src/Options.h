@@ -19,6 +19,9 @@ extern const UChar* FpsLimit_Names[FpsLimit_Count];
 
 #define OPT_VIEW_DISTANCE "viewdist"
 #define OPT_BLOCK_PHYSICS "singleplayerphysics"
+#define OPT_PHYSICS_THREADS "singleplayerphysics-threads"
+#define OPT_PHYSICS_BUDGET "singleplayerphysics-budget"
+#define OPT_PHYSICS_ASYNC "singleplayerphysics-async"
 #define OPT_NAMES_MODE "namesmode"
 #define OPT_INVERT_MOUSE "invertmouse"
 #define OPT_SENSITIVITY "mousesensitivity"
@@ -69,6 +72,11 @@ extern const UChar* FpsLimit_Names[FpsLimit_Count];
 #define OPT_CLASSIC_HACKS "nostalgia-hacks"
 #define OPT_CLASSIC_ARM_MODEL "nostalgia-classicarm"
 #define OPT_MAX_CHUNK_UPDATES "gfx-maxchunkupdates"
+#define OPT_RECORD_PACKETS "net-recordpackets"
+#define OPT_LOCAL_SERVER_BOTS "localserver-bots"
+#define OPT_LOCAL_SERVER_BLOCKS "localserver-blockrate"
+#define OPT_LOCAL_SERVER_CHAT "localserver-chatrate"
+#define OPT_LOCAL_SERVER_SIZE "localserver-mapsize"
 
 StringsBuffer Options_Keys;
 StringsBuffer Options_Values;
@@ -29,6 +29,8 @@
 *-----------------------------------------------------Common handlers-----------------------------------------------------*
 *#########################################################################################################################*/
 UInt8 classicTabList[256 >> 3];
+/* Whether edge/clouds height was derived from guessed map height, and not yet set by server */
+bool mapGuessedEdge, mapGuessedClouds;
 #define Handlers_ReadBlock(data) *data++;
 
 static String Handlers_ReadString(UInt8** ptr, STRING_REF UChar* strBuffer) {
@@ -115,7 +117,7 @@ static void Handlers_AddEntity(UInt8* data, EntityID id, STRING_TRANSIENT String
 
 		struct NetPlayer* player = &NetPlayers_List[id];
 		NetPlayer_Init(player, displayName, skinName);
-		Entities_List[id] = &player->Base;
+		Entities_Add(id, &player->Base);
 		Event_RaiseInt(&EntityEvents_Added, id);
 	} else {
 		p->Base.VTABLE->Despawn(&p->Base);
@@ -269,6 +271,7 @@ static void WoM_ParseConfig(STRING_PURE String* page) {
 			Int32 waterLevel;
 			if (Convert_TryParseInt32(&value, &waterLevel)) {
 				WorldEnv_SetEdgeHeight(waterLevel);
+				mapGuessedEdge = false;
 			}
 		} else if (String_CaselessEqualsConst(&key, "user.detail") && !cpe_useMessageTypes) {
 			Chat_AddOf(&value, MSG_TYPE_STATUS_2);
@@ -308,6 +311,8 @@ UInt8* map;
 struct Stream mapPartStream;
 struct Screen* prevScreen;
 bool receivedFirstPosition;
+Int32 mapLastWidth, mapLastHeight, mapLastLength, mapRowsLoaded;
+bool mapProgressive;
 
 void Classic_WriteChat(STRING_PURE String* text, bool partial) {
 	UInt8* data = ServerConnection_WriteBuffer;
@@ -389,6 +394,9 @@ static void Classic_Handshake(UInt8* data) {
 static void Classic_Ping(UInt8* data) { }
 
 static void Classic_StartLoading(void) {
+	/* Map blocks are owned by the world when the map was being shown progressively */
+	if (mapProgressive) { map = NULL; mapProgressive = false; }
+	Mem_Free(&map);
 	World_Reset();
 	Event_RaiseVoid(&WorldEvents_NewMap);
 	Stream_ReadonlyMemory(&mapPartStream, NULL, 0);
@@ -413,6 +421,31 @@ static void Classic_StartLoading(void) {
 	DateTime_CurrentUTC(&mapReceiveStart);
 }
 
+/* Map dimensions are only sent at the end in LevelFinalise. However, when the new map has the same volume as
+the last map (e.g. rejoining or reloading a level), the dimensions can be reasonably guessed up front.
+This allows rendering the bottom of the map, while the rest of the map is still being received. */
+static void Classic_BeginProgressive(void) {
+	if (!mapLastWidth || mapVolume != mapLastWidth * mapLastHeight * mapLastLength) return;
+	mapProgressive = true;
+	mapRowsLoaded  = 0;
+
+	/* World_SetNewMap derives unset edge/clouds heights from the guessed height */
+	mapGuessedEdge   = WorldEnv_EdgeHeight   == -1;
+	mapGuessedClouds = WorldEnv_CloudsHeight == -1;
+	World_SetNewMap(map, mapVolume, mapLastWidth, mapLastHeight, mapLastLength);
+	World_Streaming = true;
+	Event_RaiseVoid(&WorldEvents_MapLoaded);
+}
+
+static void Classic_UpdateProgressive(void) {
+	/* Only update whole layers of chunks at once, otherwise same chunk would be rebuilt up to 16 times */
+	Int32 rows = (mapIndex / World_OneY) & ~CHUNK_MAX;
+	if (rows <= mapRowsLoaded) return;
+
+	Game_UpdateRows(mapRowsLoaded, rows - 1);
+	mapRowsLoaded = rows;
+}
+
 static void Classic_LevelInit(UInt8* data) {
 	if (!mapInflateInited) Classic_StartLoading();
 
@@ -421,7 +454,8 @@ static void Classic_LevelInit(UInt8* data) {
 		mapVolume = Stream_GetU32_BE(data);
 		gzHeader.Done = true;
 		mapSizeIndex = sizeof(UInt32);
-		map = Mem_Alloc(mapVolume, sizeof(BlockID), "map blocks");
+		map = Mem_AllocCleared(mapVolume, sizeof(BlockID), "map blocks");
+		Classic_BeginProgressive();
 	}
 }
 
@@ -454,13 +488,15 @@ static void Classic_LevelDataChunk(UInt8* data) {
 		if (mapSizeIndex == sizeof(UInt32)) {
 			if (!map) {
 				mapVolume = Stream_GetU32_BE(mapSize);
-				map = Mem_Alloc(mapVolume, sizeof(BlockID), "map blocks");
+				map = Mem_AllocCleared(mapVolume, sizeof(BlockID), "map blocks");
+				Classic_BeginProgressive();
 			}
 
 			UInt8* src = map + mapIndex;
 			UInt32 count = mapVolume - mapIndex, modified = 0;
 			mapInflateStream.Read(&mapInflateStream, src, count, &modified);
 			mapIndex += modified;
+			if (mapProgressive) Classic_UpdateProgressive();
 		}
 	}
 
@@ -482,11 +518,28 @@ static void Classic_LevelFinalise(UInt8* data) {
 	Int32 loadingMs = (Int32)DateTime_MsBetween(&mapReceiveStart, &now);
 	Platform_Log1("map loading took: %i", &loadingMs);
 
-	World_SetNewMap(map, mapVolume, mapWidth, mapHeight, mapLength);
-	Event_RaiseVoid(&WorldEvents_MapLoaded);
+	bool sameDims = mapWidth == World_Width && mapHeight == World_Height && mapLength == World_Length;
+	if (mapProgressive && sameDims) {
+		if (mapRowsLoaded < World_Height) Game_UpdateRows(mapRowsLoaded, World_MaxY);
+	} else {
+		/* Guessed dimensions were wrong, so need to throw away everything built for them */
+		if (mapProgressive) {
+			Event_RaiseVoid(&WorldEvents_NewMap);
+			/* Let World_SetNewMap derive these again from the real height, unless server has set them since */
+			if (mapGuessedEdge)   WorldEnv_EdgeHeight   = -1;
+			if (mapGuessedClouds) WorldEnv_CloudsHeight = -1;
+		}
+		World_SetNewMap(map, mapVolume, mapWidth, mapHeight, mapLength);
+		Event_RaiseVoid(&WorldEvents_MapLoaded);
+	}
+	World_Streaming = false;
 	WoM_CheckSendWomID();
 
+	mapLastWidth = mapWidth; mapLastHeight = mapHeight; mapLastLength = mapLength;
 	map = NULL;
+	mapProgressive   = false;
+	mapGuessedEdge   = false;
+	mapGuessedClouds = false;
 	mapInflateInited = false;
 }
 
@@ -654,6 +707,7 @@ static void Classic_Tick(void) {
 	if (!receivedFirstPosition) return;
 	struct Entity* entity = &LocalPlayer_Instance.Base;
 	Classic_WritePosition(entity->Position, entity->HeadY, entity->HeadX);
+	Net_SendPacket();
 }
 
 
@@ -983,10 +1037,12 @@ static void CPE_EnvSetMapAppearance(UInt8* data) {
 	WorldEnv_SetSidesBlock(data[64]);
 	WorldEnv_SetEdgeBlock(data[65]);
 	WorldEnv_SetEdgeHeight((Int16)Stream_GetU16_BE(&data[66]));
+	mapGuessedEdge = false;
 	if (cpe_envMapVer == 1) return;
 
 	/* Version 2 */
 	WorldEnv_SetCloudsHeight((Int16)Stream_GetU16_BE(&data[68]));
+	mapGuessedClouds = false;
 	Int16 maxViewDist = (Int16)Stream_GetU16_BE(&data[70]);
 	Game_MaxViewDistance = maxViewDist <= 0 ? 32768 : maxViewDist;
 	Game_SetViewDistance(Game_UserViewDistance, false);
@@ -1039,6 +1095,7 @@ static void CPE_BulkBlockUpdate(UInt8* data) {
 	data += (BULK_MAX_BLOCKS - count) * sizeof(Int32);
 
 	Int32 x, y, z;
+	Game_BeginBlockUpdates();
 	for (i = 0; i < count; i++) {
 		Int32 index = indices[i];
 		if (index < 0 || index >= World_BlocksSize) continue;
@@ -1048,6 +1105,7 @@ static void CPE_BulkBlockUpdate(UInt8* data) {
 			Game_UpdateBlock(x, y, z, data[i]);
 		}
 	}
+	Game_EndBlockUpdates();
 }
 
 static void CPE_SetTextColor(UInt8* data) {
@@ -1091,9 +1149,11 @@ static void CPE_SetMapEnvProperty(UInt8* data) {
 		Math_Clamp(value, 0, maxBlock);
 		WorldEnv_SetEdgeBlock((BlockID)value); break;
 	case 2:
-		WorldEnv_SetEdgeHeight(value); break;
+		WorldEnv_SetEdgeHeight(value);
+		mapGuessedEdge = false; break;
 	case 3:
-		WorldEnv_SetCloudsHeight(value); break;
+		WorldEnv_SetCloudsHeight(value);
+		mapGuessedClouds = false; break;
 	case 4:
 		Math_Clamp(value, -0x7FFF, 0x7FFF);
 		Game_MaxViewDistance = value <= 0 ? 32768 : value;
@@ -1215,6 +1275,7 @@ static void CPE_Tick(void) {
 	cpe_pingTicks++;
 	if (cpe_pingTicks >= 20 && cpe_twoWayPing) {
 		CPE_WriteTwoWayPing(false, PingList_NextPingData());
+		Net_SendPacket();
 		cpe_pingTicks = 0;
 	}
 }
@@ -11,15 +11,28 @@
 #include "Game.h"
 #include "Event.h"
 #include "GameStructs.h"
+#include "Platform.h"
 
 
 /*########################################################################################################################*
 *------------------------------------------------------Particle base------------------------------------------------------*
 *#########################################################################################################################*/
 GfxResourceID Particles_TexId, Particles_VB;
-#define PARTICLES_MAX 600
+/* Max particles of each type. All of a type's particles must fit in one dynamic vertex buffer. */
+#define PARTICLES_MAX (GFX_MAX_VERTICES / 4)
 Random rnd;
 bool particle_hitTerrain;
+VertexP3fT2fC4b particles_vertices[PARTICLES_MAX * 4];
+
+/* Particles are stored as separate arrays, so the compiler can vectorise integrating them. */
+struct ParticleList {
+	Real32 LastX[PARTICLES_MAX], LastY[PARTICLES_MAX], LastZ[PARTICLES_MAX];
+	Real32 NextX[PARTICLES_MAX], NextY[PARTICLES_MAX], NextZ[PARTICLES_MAX];
+	Real32 VelX[PARTICLES_MAX],  VelY[PARTICLES_MAX],  VelZ[PARTICLES_MAX];
+	Real32 Life[PARTICLES_MAX];
+	UInt8 Size[PARTICLES_MAX];
+	Int32 Count, Evict;
+};
 
 void Particle_DoRender(Vector2* size, Vector3* pos, struct TextureRec* rec, PackedCol col, VertexP3fT2fC4b* vertices) {
 	Real32 sX = size->X * 0.5f, sY = size->Y * 0.5f;
@@ -44,10 +57,50 @@ void Particle_DoRender(Vector2* size, Vector3* pos, struct TextureRec* rec, Pack
 				   v.V = rec->V2; vertices[3] = v;
 }
 
-static void Particle_Reset(struct Particle* p, Vector3 pos, Vector3 velocity, Real32 lifetime) {
-	p->LastPos = pos; p->NextPos = pos;
-	p->Velocity = velocity;
-	p->Lifetime = lifetime;
+static Int32 ParticleList_Add(struct ParticleList* l, Vector3 pos, Vector3 velocity, Real32 lifetime, UInt8 size) {
+	Int32 i;
+	if (l->Count < PARTICLES_MAX) {
+		i = l->Count++;
+	} else {
+		/* Removal swaps particles around, so replace slots in turn instead of the oldest particle */
+		i = l->Evict; l->Evict = (l->Evict + 1) % PARTICLES_MAX;
+	}
+
+	l->LastX[i] = pos.X;      l->LastY[i] = pos.Y;      l->LastZ[i] = pos.Z;
+	l->NextX[i] = pos.X;      l->NextY[i] = pos.Y;      l->NextZ[i] = pos.Z;
+	l->VelX[i]  = velocity.X; l->VelY[i]  = velocity.Y; l->VelZ[i]  = velocity.Z;
+	l->Life[i]  = lifetime;   l->Size[i]  = size;
+	return i;
+}
+
+static void ParticleList_RemoveAt(struct ParticleList* l, Int32 i) {
+	Int32 last = --l->Count;
+	l->LastX[i] = l->LastX[last]; l->LastY[i] = l->LastY[last]; l->LastZ[i] = l->LastZ[last];
+	l->NextX[i] = l->NextX[last]; l->NextY[i] = l->NextY[last]; l->NextZ[i] = l->NextZ[last];
+	l->VelX[i]  = l->VelX[last];  l->VelY[i]  = l->VelY[last];  l->VelZ[i]  = l->VelZ[last];
+	l->Life[i]  = l->Life[last];  l->Size[i]  = l->Size[last];
+}
+
+static void ParticleList_GetPos(struct ParticleList* l, Int32 i, Real32 t, Vector3* pos) {
+	pos->X = t * (l->NextX[i] - l->LastX[i]) + l->LastX[i];
+	pos->Y = t * (l->NextY[i] - l->LastY[i]) + l->LastY[i];
+	pos->Z = t * (l->NextZ[i] - l->LastZ[i]) + l->LastZ[i];
+}
+
+static void ParticleList_Integrate(struct ParticleList* l, Real32 gravity, Real64 delta) {
+	Real32 dt = (Real32)delta, scale = dt * 3.0f, gravityDelta = gravity * dt;
+	Int32 i, count = l->Count;
+
+	/* No branches, so compilers can turn this into SIMD */
+	for (i = 0; i < count; i++) {
+		l->LastX[i] = l->NextX[i]; l->LastY[i] = l->NextY[i]; l->LastZ[i] = l->NextZ[i];
+		l->VelY[i] -= gravityDelta;
+
+		l->NextX[i] += l->VelX[i] * scale;
+		l->NextY[i] += l->VelY[i] * scale;
+		l->NextZ[i] += l->VelZ[i] * scale;
+		l->Life[i]  -= dt;
+	}
 }
 
 static bool Particle_CanPass(BlockID block, bool throughLiquids) {
@@ -55,12 +108,10 @@ static bool Particle_CanPass(BlockID block, bool throughLiquids) {
 	return draw == DRAW_GAS || draw == DRAW_SPRITE || (throughLiquids && Block_IsLiquid[block]);
 }
 
-static bool Particle_CollideHor(Vector3* nextPos, BlockID block) {
-	Vector3 horPos = Vector3_Create3((Real32)Math_Floor(nextPos->X), 0.0f, (Real32)Math_Floor(nextPos->Z));
-	Vector3 min, max;
-	Vector3_Add(&min, &Block_MinBB[block], &horPos);
-	Vector3_Add(&max, &Block_MaxBB[block], &horPos);
-	return nextPos->X >= min.X && nextPos->Z >= min.Z && nextPos->X < max.X && nextPos->Z < max.Z;
+static bool Particle_CollideHor(Real32 x, Real32 z, BlockID block) {
+	Real32 blockX = (Real32)Math_Floor(x), blockZ = (Real32)Math_Floor(z);
+	return x >= blockX + Block_MinBB[block].X && z >= blockZ + Block_MinBB[block].Z
+		&& x <  blockX + Block_MaxBB[block].X && z <  blockZ + Block_MaxBB[block].Z;
 }
 
 static BlockID Particle_GetBlock(Int32 x, Int32 y, Int32 z) {
@@ -71,81 +122,124 @@ static BlockID Particle_GetBlock(Int32 x, Int32 y, Int32 z) {
 	return WorldEnv_SidesBlock;
 }
 
-static bool Particle_TestY(struct Particle* p, Int32 y, bool topFace, bool throughLiquids) {
+
+/*########################################################################################################################*
+*-----------------------------------------------------Particle columns----------------------------------------------------*
+*#########################################################################################################################*/
+/* Caches the highest solid block in recently used columns, so particles falling through open air skip block lookups */
+struct ParticleColumn { Int32 X, Z, Top[2]; };
+#define PARTICLE_COLUMN_UNKNOWN -2
+struct ParticleColumn particle_columns[32 * 32];
+
+void Particles_ClearColumns(void) {
+	Int32 i;
+	for (i = 0; i < Array_Elems(particle_columns); i++) {
+		particle_columns[i].X = Int32_MinValue;
+	}
+}
+
+static struct ParticleColumn* Particles_GetColumn(Int32 x, Int32 z) {
+	return &particle_columns[(x & 0x1F) | ((z & 0x1F) << 5)];
+}
+
+void Particles_InvalidateColumn(Int32 x, Int32 z) {
+	struct ParticleColumn* col = Particles_GetColumn(x, z);
+	if (col->X == x && col->Z == z) col->X = Int32_MinValue;
+}
+
+/* Returns highest y in the column that particles can't pass through, or -1 if there is no such block */
+static Int32 Particles_ColumnTop(Int32 x, Int32 z, bool throughLiquids) {
+	struct ParticleColumn* col = Particles_GetColumn(x, z);
+	if (col->X != x || col->Z != z) {
+		col->X = x; col->Z = z;
+		col->Top[0] = PARTICLE_COLUMN_UNKNOWN; col->Top[1] = PARTICLE_COLUMN_UNKNOWN;
+	}
+
+	Int32* top = &col->Top[throughLiquids];
+	if (*top == PARTICLE_COLUMN_UNKNOWN) {
+		Int32 y;
+		for (y = World_MaxY; y >= 0 && Particle_CanPass(World_GetBlock(x, y, z), throughLiquids); y--) {}
+		*top = y;
+	}
+	return *top;
+}
+
+/* Whether all blocks from minY to maxY in the given column are known to be passable */
+static bool Particles_ColumnClear(Int32 x, Int32 z, Int32 minY, Int32 maxY, bool throughLiquids) {
+	if (x < 0 || z < 0 || x >= World_Width || z >= World_Length || maxY >= World_Height) return false;
+	return minY > Particles_ColumnTop(x, z, throughLiquids);
+}
+
+
+/*########################################################################################################################*
+*----------------------------------------------------Particle physics-----------------------------------------------------*
+*#########################################################################################################################*/
+static bool ParticleList_TestY(struct ParticleList* l, Int32 i, Int32 y, bool topFace, bool throughLiquids) {
 	if (y < 0) {
-		p->NextPos.Y = ENTITY_ADJUSTMENT; p->LastPos.Y = ENTITY_ADJUSTMENT;
-		Vector3 zero = Vector3_Zero; p->Velocity = zero;
+		l->NextY[i] = ENTITY_ADJUSTMENT; l->LastY[i] = ENTITY_ADJUSTMENT;
+		l->VelX[i] = 0.0f; l->VelY[i] = 0.0f; l->VelZ[i] = 0.0f;
 		particle_hitTerrain = true;
 		return false;
 	}
 
-	BlockID block = Particle_GetBlock((Int32)p->NextPos.X, y, (Int32)p->NextPos.Z);
+	BlockID block = Particle_GetBlock((Int32)l->NextX[i], y, (Int32)l->NextZ[i]);
 	if (Particle_CanPass(block, throughLiquids)) return true;
 	Vector3 minBB = Block_MinBB[block];
 	Vector3 maxBB = Block_MaxBB[block];
 	Real32 collideY = y + (topFace ? maxBB.Y : minBB.Y);
-	bool collideVer = topFace ? (p->NextPos.Y < collideY) : (p->NextPos.Y > collideY);
+	bool collideVer = topFace ? (l->NextY[i] < collideY) : (l->NextY[i] > collideY);
 
-	if (collideVer && Particle_CollideHor(&p->NextPos, block)) {
+	if (collideVer && Particle_CollideHor(l->NextX[i], l->NextZ[i], block)) {
 		Real32 adjust = topFace ? ENTITY_ADJUSTMENT : -ENTITY_ADJUSTMENT;
-		p->LastPos.Y = collideY + adjust;
-		p->NextPos.Y = p->LastPos.Y;
-		Vector3 zero = Vector3_Zero; p->Velocity = zero;
+		l->LastY[i] = collideY + adjust;
+		l->NextY[i] = l->LastY[i];
+		l->VelX[i] = 0.0f; l->VelY[i] = 0.0f; l->VelZ[i] = 0.0f;
 		particle_hitTerrain = true;
 		return false;
 	}
 	return true;
 }
 
-static bool Particle_PhysicsTick(struct Particle* p, Real32 gravity, bool throughLiquids, Real64 delta) {
-	p->LastPos = p->NextPos;
-
-	BlockID cur = Particle_GetBlock((Int32)p->NextPos.X, (Int32)p->NextPos.Y, (Int32)p->NextPos.Z);
-	Real32 minY = Math_Floor(p->NextPos.Y) + Block_MinBB[cur].Y;
-	Real32 maxY = Math_Floor(p->NextPos.Y) + Block_MaxBB[cur].Y;
-	if (!Particle_CanPass(cur, throughLiquids) && p->NextPos.Y >= minY
-		&& p->NextPos.Y < maxY && Particle_CollideHor(&p->NextPos, cur)) {
-		return true;
+/* Resolves collisions for a particle that was moved by ParticleList_Integrate. */
+/* Returns whether the particle was already stuck inside a block, and so should be removed. */
+static bool ParticleList_Collide(struct ParticleList* l, Int32 i, bool throughLiquids) {
+	Real32 lastY = l->LastY[i];
+	Int32 x = (Int32)l->LastX[i], y = (Int32)lastY, z = (Int32)l->LastZ[i];
+
+	if (!Particles_ColumnClear(x, z, y, y, throughLiquids)) {
+		BlockID cur = Particle_GetBlock(x, y, z);
+		Real32 minY = Math_Floor(lastY) + Block_MinBB[cur].Y;
+		Real32 maxY = Math_Floor(lastY) + Block_MaxBB[cur].Y;
+		if (!Particle_CanPass(cur, throughLiquids) && lastY >= minY
+			&& lastY < maxY && Particle_CollideHor(l->LastX[i], l->LastZ[i], cur)) {
+			return true;
+		}
 	}
 
-	p->Velocity.Y -= gravity * (Real32)delta;
-	Int32 startY = Math_Floor(p->NextPos.Y);
-	Vector3 velocity;
-	Vector3_Mul1(&velocity, &p->Velocity, (Real32)delta * 3.0f);
-	Vector3_Add(&p->NextPos, &p->NextPos, &velocity);
-	Int32 endY = Math_Floor(p->NextPos.Y);
+	Int32 startY = Math_Floor(lastY), endY = Math_Floor(l->NextY[i]);
+	x = (Int32)l->NextX[i]; z = (Int32)l->NextZ[i];
+	if (Particles_ColumnClear(x, z, min(startY, endY), max(startY, endY), throughLiquids)) return false;
 
-	Int32 y;
-	if (p->Velocity.Y > 0.0f) {
+	if (l->VelY[i] > 0.0f) {
 		/* don't test block we are already in */
-		for (y = startY + 1; y <= endY && Particle_TestY(p, y, false, throughLiquids); y++) {}
+		for (y = startY + 1; y <= endY && ParticleList_TestY(l, i, y, false, throughLiquids); y++) {}
 	} else {
-		for (y = startY; y >= endY && Particle_TestY(p, y, true, throughLiquids); y--) {}
+		for (y = startY; y >= endY && ParticleList_TestY(l, i, y, true, throughLiquids); y--) {}
 	}
-
-	p->Lifetime -= (Real32)delta;
-	return p->Lifetime < 0.0f;
+	return false;
 }
 
 
 /*########################################################################################################################*
 *-------------------------------------------------------Rain particle-----------------------------------------------------*
 *#########################################################################################################################*/
-struct RainParticle { struct Particle Base; };
-
-struct RainParticle Rain_Particles[PARTICLES_MAX];
-Int32 Rain_Count;
-
-static bool RainParticle_Tick(struct RainParticle* p, Real64 delta) {
-	particle_hitTerrain = false;
-	return Particle_PhysicsTick(&p->Base, 3.5f, false, delta) || particle_hitTerrain;
-}
+struct ParticleList Rain_Particles;
 
 struct TextureRec Rain_Rec = { 2.0f / 128.0f, 14.0f / 128.0f, 5.0f / 128.0f, 16.0f / 128.0f };
-static void RainParticle_Render(struct RainParticle* p, Real32 t, VertexP3fT2fC4b* vertices) {
+static void RainParticle_Render(Int32 i, Real32 t, VertexP3fT2fC4b* vertices) {
 	Vector3 pos;
-	Vector3_Lerp(&pos, &p->Base.LastPos, &p->Base.NextPos, t);
-	Vector2 size; size.X = (Real32)p->Base.Size * 0.015625f; size.Y = size.X;
+	ParticleList_GetPos(&Rain_Particles, i, t, &pos);
+	Vector2 size; size.X = (Real32)Rain_Particles.Size[i] * 0.015625f; size.Y = size.X;
 
 	Int32 x = Math_Floor(pos.X), y = Math_Floor(pos.Y), z = Math_Floor(pos.Z);
 	PackedCol col = World_IsValidPos(x, y, z) ? Lighting_Col(x, y, z) : Lighting_Outside;
@@ -153,34 +247,29 @@ static void RainParticle_Render(struct RainParticle* p, Real32 t, VertexP3fT2fC4
 }
 
 static void Rain_Render(Real32 t) {
-	if (!Rain_Count) return;
-	VertexP3fT2fC4b vertices[PARTICLES_MAX * 4];
-	Int32 i;
-	VertexP3fT2fC4b* ptr = vertices;
-	for (i = 0; i < Rain_Count; i++) {
-		RainParticle_Render(&Rain_Particles[i], t, ptr);
+	Int32 i, count = Rain_Particles.Count;
+	if (!count) return;
+	VertexP3fT2fC4b* ptr = particles_vertices;
+	for (i = 0; i < count; i++) {
+		RainParticle_Render(i, t, ptr);
 		ptr += 4;
 	}
 
 	Gfx_BindTexture(Particles_TexId);
-	GfxCommon_UpdateDynamicVb_IndexedTris(Particles_VB, vertices, Rain_Count * 4);
-}
-
-static void Rain_RemoveAt(Int32 index) {
-	struct RainParticle removed = Rain_Particles[index];
-	Int32 i;
-	for (i = index; i < Rain_Count - 1; i++) {
-		Rain_Particles[i] = Rain_Particles[i + 1];
-	}
-	Rain_Particles[Rain_Count - 1] = removed;
-	Rain_Count--;
+	GfxCommon_UpdateDynamicVb_IndexedTris(Particles_VB, particles_vertices, count * 4);
 }
 
 static void Rain_Tick(Real64 delta) {
+	struct ParticleList* l = &Rain_Particles;
+	ParticleList_Integrate(l, 3.5f, delta);
 	Int32 i;
-	for (i = 0; i < Rain_Count; i++) {
-		if (RainParticle_Tick(&Rain_Particles[i], delta)) {
-			Rain_RemoveAt(i); i--;
+
+	for (i = 0; i < l->Count; i++) {
+		particle_hitTerrain = false;
+		bool stuck = ParticleList_Collide(l, i, false);
+
+		if (stuck || particle_hitTerrain || l->Life[i] < 0.0f) {
+			ParticleList_RemoveAt(l, i); i--;
 		}
 	}
 }
@@ -189,40 +278,32 @@ static void Rain_Tick(Real64 delta) {
 /*########################################################################################################################*
 *------------------------------------------------------Terrain particle---------------------------------------------------*
 *#########################################################################################################################*/
-struct TerrainParticle {
-	struct Particle Base;
-	struct TextureRec Rec;
-	TextureLoc TexLoc;
-	BlockID Block;
-};
-
-struct TerrainParticle Terrain_Particles[PARTICLES_MAX];
-Int32 Terrain_Count;
-UInt16 Terrain_1DCount[ATLAS1D_MAX_ATLASES];
-UInt16 Terrain_1DIndices[ATLAS1D_MAX_ATLASES];
-
-static bool TerrainParticle_Tick(struct TerrainParticle* p, Real64 delta) {
-	return Particle_PhysicsTick(&p->Base, 5.4f, true, delta);
-}
-
-static void TerrainParticle_Render(struct TerrainParticle* p, Real32 t, VertexP3fT2fC4b* vertices) {
+struct ParticleList Terrain_Particles;
+struct TextureRec Terrain_Recs[PARTICLES_MAX];
+TextureLoc Terrain_TexLocs[PARTICLES_MAX];
+BlockID Terrain_Blocks[PARTICLES_MAX];
+Int32 Terrain_1DCount[ATLAS1D_MAX_ATLASES];
+Int32 Terrain_1DIndices[ATLAS1D_MAX_ATLASES];
+
+static void TerrainParticle_Render(Int32 i, Real32 t, VertexP3fT2fC4b* vertices) {
 	Vector3 pos;
-	Vector3_Lerp(&pos, &p->Base.LastPos, &p->Base.NextPos, t);
-	Vector2 size; size.X = (Real32)p->Base.Size * 0.015625f; size.Y = size.X;
+	ParticleList_GetPos(&Terrain_Particles, i, t, &pos);
+	Vector2 size; size.X = (Real32)Terrain_Particles.Size[i] * 0.015625f; size.Y = size.X;
+	BlockID block = Terrain_Blocks[i];
 
 	PackedCol col = PACKEDCOL_WHITE;
-	if (!Block_FullBright[p->Block]) {
+	if (!Block_FullBright[block]) {
 		Int32 x = Math_Floor(pos.X), y = Math_Floor(pos.Y), z = Math_Floor(pos.Z);
 		col = World_IsValidPos(x, y, z) ? Lighting_Col_XSide(x, y, z) : Lighting_OutsideXSide;
 	}
 
-	if (Block_Tinted[p->Block]) {
-		PackedCol tintCol = Block_FogCol[p->Block];
+	if (Block_Tinted[block]) {
+		PackedCol tintCol = Block_FogCol[block];
 		col.R = (UInt8)(col.R * tintCol.R / 255);
 		col.G = (UInt8)(col.G * tintCol.G / 255);
 		col.B = (UInt8)(col.B * tintCol.B / 255);
 	}
-	Particle_DoRender(&size, &pos, &p->Rec, col, vertices);
+	Particle_DoRender(&size, &pos, &Terrain_Recs[i], col, vertices);
 }
 
 static void Terrain_Update1DCounts(void) {
@@ -231,8 +312,8 @@ static void Terrain_Update1DCounts(void) {
 		Terrain_1DCount[i]   = 0;
 		Terrain_1DIndices[i] = 0;
 	}
-	for (i = 0; i < Terrain_Count; i++) {
-		Int32 index = Atlas1D_Index(Terrain_Particles[i].TexLoc);
+	for (i = 0; i < Terrain_Particles.Count; i++) {
+		Int32 index = Atlas1D_Index(Terrain_TexLocs[i]);
 		Terrain_1DCount[index] += 4;
 	}
 	for (i = 1; i < Atlas1D_Count; i++) {
@@ -241,18 +322,17 @@ static void Terrain_Update1DCounts(void) {
 }
 
 static void Terrain_Render(Real32 t) {
-	if (!Terrain_Count) return;
-	VertexP3fT2fC4b vertices[PARTICLES_MAX * 4];
+	Int32 i, count = Terrain_Particles.Count;
+	if (!count) return;
 	Terrain_Update1DCounts();
-	Int32 i;
-	for (i = 0; i < Terrain_Count; i++) {
-		Int32 index = Atlas1D_Index(Terrain_Particles[i].TexLoc);
-		VertexP3fT2fC4b* ptr = &vertices[Terrain_1DIndices[index]];
-		TerrainParticle_Render(&Terrain_Particles[i], t, ptr);
+	for (i = 0; i < count; i++) {
+		Int32 index = Atlas1D_Index(Terrain_TexLocs[i]);
+		VertexP3fT2fC4b* ptr = &particles_vertices[Terrain_1DIndices[index]];
+		TerrainParticle_Render(i, t, ptr);
 		Terrain_1DIndices[index] += 4;
 	}
 
-	Gfx_SetDynamicVbData(Particles_VB, vertices, Terrain_Count * 4);
+	Gfx_SetDynamicVbData(Particles_VB, particles_vertices, count * 4);
 	Int32 offset = 0;
 	for (i = 0; i < Atlas1D_Count; i++) {
 		Int32 partCount = Terrain_1DCount[i];
@@ -264,20 +344,21 @@ static void Terrain_Render(Real32 t) {
 	}
 }
 
-static void Terrain_RemoveAt(Int32 index) {
-	struct TerrainParticle removed = Terrain_Particles[index];
-	Int32 i;
-	for (i = index; i < Terrain_Count - 1; i++) {
-		Terrain_Particles[i] = Terrain_Particles[i + 1];
-	}
-	Terrain_Particles[Terrain_Count - 1] = removed;
-	Terrain_Count--;
+static void Terrain_RemoveAt(Int32 i) {
+	Int32 last = Terrain_Particles.Count - 1;
+	Terrain_Recs[i]    = Terrain_Recs[last];
+	Terrain_TexLocs[i] = Terrain_TexLocs[last];
+	Terrain_Blocks[i]  = Terrain_Blocks[last];
+	ParticleList_RemoveAt(&Terrain_Particles, i);
 }
 
 static void Terrain_Tick(Real64 delta) {
+	struct ParticleList* l = &Terrain_Particles;
+	ParticleList_Integrate(l, 5.4f, delta);
 	Int32 i;
-	for (i = 0; i < Terrain_Count; i++) {
-		if (TerrainParticle_Tick(&Terrain_Particles[i], delta)) {
+
+	for (i = 0; i < l->Count; i++) {
+		if (ParticleList_Collide(l, i, true) || l->Life[i] < 0.0f) {
 			Terrain_RemoveAt(i); i--;
 		}
 	}
@@ -300,6 +381,8 @@ static void Particles_ContextRecreated(void* obj) {
 	Particles_VB = Gfx_CreateDynamicVb(VERTEX_FORMAT_P3FT2FC4B, PARTICLES_MAX * 4);
 }
 
+static void Particles_WorldChanged(void* obj) { Particles_ClearColumns(); }
+
 static void Particles_BreakBlockEffect_Handler(void* obj, Vector3I coords, BlockID oldBlock, BlockID block) {
 	Particles_BreakBlockEffect(coords, oldBlock, block);
 }
@@ -307,14 +390,21 @@ static void Particles_BreakBlockEffect_Handler(void* obj, Vector3I coords, Block
 static void Particles_Init(void) {
 	Random_InitFromCurrentTime(&rnd);
 	Particles_ContextRecreated(NULL);
+	Particles_ClearColumns();
 
 	Event_RegisterBlock(&UserEvents_BlockChanged,   NULL, Particles_BreakBlockEffect_Handler);
 	Event_RegisterEntry(&TextureEvents_FileChanged, NULL, Particles_FileChanged);
 	Event_RegisterVoid(&GfxEvents_ContextLost,      NULL, Particles_ContextLost);
 	Event_RegisterVoid(&GfxEvents_ContextRecreated, NULL, Particles_ContextRecreated);
+	Event_RegisterVoid(&BlockEvents_BlockDefChanged, NULL, Particles_WorldChanged);
+	Event_RegisterVoid(&WorldEvents_MapLoaded,       NULL, Particles_WorldChanged);
 }
 
-static void Particles_Reset(void) { Rain_Count = 0; Terrain_Count = 0; }
+static void Particles_Reset(void) {
+	Rain_Particles.Count = 0;    Rain_Particles.Evict = 0;
+	Terrain_Particles.Count = 0; Terrain_Particles.Evict = 0;
+	Particles_ClearColumns();
+}
 
 static void Particles_Free(void) {
 	Gfx_DeleteTexture(&Particles_TexId);
@@ -324,6 +414,8 @@ static void Particles_Free(void) {
 	Event_UnregisterEntry(&TextureEvents_FileChanged, NULL, Particles_FileChanged);
 	Event_UnregisterVoid(&GfxEvents_ContextLost,      NULL, Particles_ContextLost);
 	Event_UnregisterVoid(&GfxEvents_ContextRecreated, NULL, Particles_ContextRecreated);
+	Event_UnregisterVoid(&BlockEvents_BlockDefChanged, NULL, Particles_WorldChanged);
+	Event_UnregisterVoid(&WorldEvents_MapLoaded,       NULL, Particles_WorldChanged);
 }
 
 void Particles_MakeComponent(struct IGameComponent* comp) {
@@ -334,7 +426,7 @@ void Particles_MakeComponent(struct IGameComponent* comp) {
 }
 
 void Particles_Render(Real64 delta, Real32 t) {
-	if (!Terrain_Count && !Rain_Count) return;
+	if (!Terrain_Particles.Count && !Rain_Particles.Count) return;
 	if (Gfx_LostContext) return;
 
 	Gfx_SetTexturing(true);
@@ -404,18 +496,16 @@ void Particles_BreakBlockEffect(Vector3I coords, BlockID oldBlock, BlockID block
 				rec.U2 = min(rec.U2, maxU2) - 0.01f * uScale;
 				rec.V2 = min(rec.V2, maxV2) - 0.01f * vScale;
 
-				if (Terrain_Count == PARTICLES_MAX) Terrain_RemoveAt(0);
-				struct TerrainParticle* p = &Terrain_Particles[Terrain_Count++];
 				Real32 life = 0.3f + Random_Float(&rnd) * 1.2f;
+				Int32 type = Random_Range(&rnd, 0, 30);
+				UInt8 size = (UInt8)(type >= 28 ? 12 : (type >= 25 ? 10 : 8));
 
 				Vector3 pos;
 				Vector3_Add(&pos, &worldPos, &cell);
-				Particle_Reset(&p->Base, pos, velocity, life);
-				p->Rec = rec;
-				p->TexLoc = (TextureLoc)texLoc;
-				p->Block = block;
-				Int32 type = Random_Range(&rnd, 0, 30);
-				p->Base.Size = (UInt8)(type >= 28 ? 12 : (type >= 25 ? 10 : 8));
+				Int32 i = ParticleList_Add(&Terrain_Particles, pos, velocity, life, size);
+				Terrain_Recs[i]    = rec;
+				Terrain_TexLocs[i] = (TextureLoc)texLoc;
+				Terrain_Blocks[i]  = block;
 			}
 		}
 	}
@@ -435,12 +525,35 @@ void Particles_RainSnowEffect(Vector3 pos) {
 		offset.Y = Random_Float(&rnd) * 0.1f + 0.01f;
 		offset.Z = Random_Float(&rnd);
 
-		if (Rain_Count == PARTICLES_MAX) Rain_RemoveAt(0);
-		struct RainParticle* p = &Rain_Particles[Rain_Count++];
-
 		Vector3_Add(&pos, &startPos, &offset);
-		Particle_Reset(&p->Base, pos, velocity, 40.0f);
 		Int32 type = Random_Range(&rnd, 0, 30);
-		p->Base.Size = (UInt8)(type >= 28 ? 2 : (type >= 25 ? 4 : 3));
+		UInt8 size = (UInt8)(type >= 28 ? 2 : (type >= 25 ? 4 : 3));
+		ParticleList_Add(&Rain_Particles, pos, velocity, 40.0f, size);
+	}
+}
+
+Int32 Particles_Benchmark(Vector3 pos, Int32 count, Int32 ticks) {
+	Int32 i;
+	/* Spread out particles like a large explosion, with heavy weather around it */
+	for (i = 0; i < count / 64; i++) {
+		Vector3I coords;
+		coords.X = (Int32)pos.X + Random_Range(&rnd, -16, 16);
+		coords.Y = (Int32)pos.Y + Random_Range(&rnd, -4, 12);
+		coords.Z = (Int32)pos.Z + Random_Range(&rnd, -16, 16);
+		Particles_BreakBlockEffect(coords, BLOCK_STONE, BLOCK_AIR);
+	}
+	for (i = 0; i < count / 2; i++) {
+		Vector3 rainPos = pos;
+		rainPos.X += Random_Float(&rnd) * 64.0f - 32.0f;
+		rainPos.Y += Random_Float(&rnd) * 32.0f;
+		rainPos.Z += Random_Float(&rnd) * 64.0f - 32.0f;
+		Particles_RainSnowEffect(rainPos);
+	}
+
+	struct Stopwatch stopwatch; Stopwatch_Start(&stopwatch);
+	for (i = 0; i < ticks; i++) {
+		Terrain_Tick(1.0 / 20);
+		Rain_Tick(1.0 / 20);
 	}
+	return Stopwatch_ElapsedMicroseconds(&stopwatch);
 }
@@ -9,12 +9,6 @@
 
 struct IGameComponent;
 struct ScheduledTask;
-struct Particle {
-	Vector3 Velocity;
-	Real32 Lifetime;
-	Vector3 LastPos, NextPos;
-	UInt8 Size;
-};
 
 /* http://www.opengl-tutorial.org/intermediate-tutorials/billboards-particles/billboards/ */
 void Particle_DoRender(Vector2* size, Vector3* pos, struct TextureRec* rec, PackedCol col, VertexP3fT2fC4b* vertices);
@@ -23,4 +17,11 @@ void Particles_Render(Real64 delta, Real32 t);
 void Particles_Tick(struct ScheduledTask* task);
 void Particles_BreakBlockEffect(Vector3I coords, BlockID oldBlock, BlockID block);
 void Particles_RainSnowEffect(Vector3 pos);
+/* Forgets the cached highest solid block in the given column, as a block in it changed. */
+void Particles_InvalidateColumn(Int32 x, Int32 z);
+/* Forgets the cached highest solid block in every column, as many blocks changed. */
+void Particles_ClearColumns(void);
+/* Spawns count terrain and count rain particles around pos, then simulates ticks physics ticks.
+Returns total time taken by the physics ticks, in microseconds. */
+Int32 Particles_Benchmark(Vector3 pos, Int32 count, Int32 ticks);
 #endif
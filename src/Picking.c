@@ -8,6 +8,7 @@
 #include "BlockID.h"
 #include "Block.h"
 #include "ErrorHandler.h"
+#include "MapRenderer.h"
 
 Real32 PickedPos_dist;
 static void PickedPos_TestAxis(struct PickedPos* pos, Real32 dAxis, Face fAxis) {
@@ -107,6 +108,38 @@ void RayTracer_Step(struct RayTracer* t) {
 	}
 }
 
+/* Number of cell boundaries along an axis the ray must cross to leave the current chunk */
+#define RayTracer_ChunkCrossings(step, coord) ((step) > 0 ? 16 - ((coord) & 0x0F) : ((coord) & 0x0F) + 1)
+
+/* Time at which the ray crosses the last boundary along an axis before leaving the chunk */
+static Real32 RayTracer_ExitTime(Real32 tMax, Real32 tDelta, Int32 crossings) {
+	Int32 i;
+	/* Accumulate the same way as RayTracer_Step, so both visit the same cells */
+	for (i = 1; i < crossings; i++) { tMax += tDelta; }
+	return tMax;
+}
+
+static void RayTracer_SkipAxis(Int32* coord, Real32* tMax, Int32 step, Real32 tDelta, Real32 tExit, bool crossTies) {
+	while (*tMax < tExit || (crossTies && *tMax == tExit)) {
+		*coord += step; *tMax += tDelta;
+	}
+}
+
+/* Moves the ray directly to the first cell it enters outside its current 16x16x16 chunk */
+static void RayTracer_SkipChunk(struct RayTracer* t) {
+	Real32 exitX = RayTracer_ExitTime(t->tMax.X, t->tDelta.X, RayTracer_ChunkCrossings(t->step.X, t->X));
+	Real32 exitY = RayTracer_ExitTime(t->tMax.Y, t->tDelta.Y, RayTracer_ChunkCrossings(t->step.Y, t->Y));
+	Real32 exitZ = RayTracer_ExitTime(t->tMax.Z, t->tDelta.Z, RayTracer_ChunkCrossings(t->step.Z, t->Z));
+
+	/* On ties, RayTracer_Step crosses the boundary of the later axis first */
+	Int32 axis = (exitX < exitY && exitX < exitZ) ? 0 : (exitY < exitZ ? 1 : 2);
+	Real32 tExit = axis == 0 ? exitX : (axis == 1 ? exitY : exitZ);
+
+	RayTracer_SkipAxis(&t->X, &t->tMax.X, t->step.X, t->tDelta.X, tExit, axis <= 0);
+	RayTracer_SkipAxis(&t->Y, &t->tMax.Y, t->step.Y, t->tDelta.Y, tExit, axis <= 1);
+	RayTracer_SkipAxis(&t->Z, &t->tMax.Z, t->step.Z, t->tDelta.Z, tExit, axis <= 2);
+}
+
 struct RayTracer tracer;
 #define PICKING_BORDER BLOCK_BEDROCK
 typedef bool(*IntersectTest)(struct PickedPos* pos);
@@ -141,6 +174,14 @@ static BlockID Picking_OutsideGetBlock(Int32 x, Int32 y, Int32 z, Vector3I origi
 	return BLOCK_AIR;
 }
 
+/* Whether the given cell is in a chunk which only contains air, according to the map renderer */
+static bool Picking_InAirChunk(Int32 x, Int32 y, Int32 z) {
+	if (!MapRenderer_Chunks || !World_IsValidPos(x, y, z)) return false;
+	Int32 cx = x >> 4, cy = y >> 4, cz = z >> 4;
+	if (cx >= MapRenderer_ChunksX || cy >= MapRenderer_ChunksY || cz >= MapRenderer_ChunksZ) return false;
+	return MapRenderer_GetChunk(cx, cy, cz)->AllAir;
+}
+
 static bool Picking_RayTrace(Vector3 origin, Vector3 dir, Real32 reach, struct PickedPos* pos, IntersectTest intersect) {
 	RayTracer_SetVectors(&tracer, origin, dir);
 	Real32 reachSq = reach * reach;
@@ -151,6 +192,9 @@ static bool Picking_RayTrace(Vector3 origin, Vector3 dir, Real32 reach, struct P
 	Vector3 coords;
 	for (i = 0; i < 10000; i++) {
 		Int32 x = tracer.X, y = tracer.Y, z = tracer.Z;
+		/* Air can never be intersected, so jump past chunks that are entirely air */
+		if (Picking_InAirChunk(x, y, z)) { RayTracer_SkipChunk(&tracer); continue; }
+
 		coords.X = (Real32)x; coords.Y = (Real32)y; coords.Z = (Real32)z;
 		tracer.Block = insideMap ?
 			Picking_InsideGetBlock(x, y, z) : Picking_OutsideGetBlock(x, y, z, pOrigin);
@@ -217,17 +261,53 @@ static bool Picking_ClipCamera(struct PickedPos* pos) {
 	return true;
 }
 
+/* Result of the last ray trace, reused while the ray and the world are unchanged */
+struct PickCache {
+	Vector3 Origin, Dir;
+	Real32 Reach;
+	UInt32 Version;
+	bool Mode, HasResult;
+	struct PickedPos Result;
+};
+struct PickCache picking_blockCache, picking_cameraCache;
+UInt32 picking_version;
+
+void Picking_Invalidate(void) { picking_version++; }
+
+static bool PickCache_Get(struct PickCache* cache, Vector3 origin, Vector3 dir, Real32 reach, bool mode, struct PickedPos* pos) {
+	if (!cache->HasResult || cache->Version != picking_version || cache->Mode != mode) return false;
+	if (cache->Reach != reach) return false;
+	if (!Vector3_Equals(&cache->Origin, &origin) || !Vector3_Equals(&cache->Dir, &dir)) return false;
+
+	*pos = cache->Result;
+	return true;
+}
+
+static void PickCache_Set(struct PickCache* cache, Vector3 origin, Vector3 dir, Real32 reach, bool mode, struct PickedPos* pos) {
+	cache->Origin = origin; cache->Dir = dir; cache->Reach = reach;
+	cache->Version = picking_version; cache->Mode = mode;
+	cache->HasResult = true; cache->Result = *pos;
+}
+
 void Picking_CalculatePickedBlock(Vector3 origin, Vector3 dir, Real32 reach, struct PickedPos* pos) {
+	/* Breakable liquids changes which blocks can be picked */
+	bool mode = Game_BreakableLiquids;
+	if (PickCache_Get(&picking_blockCache, origin, dir, reach, mode, pos)) return;
+
 	if (!Picking_RayTrace(origin, dir, reach, pos, Picking_ClipBlock)) {
 		PickedPos_SetAsInvalid(pos);
 	}
+	PickCache_Set(&picking_blockCache, origin, dir, reach, mode, pos);
 }
 
 void Picking_ClipCameraPos(Vector3 origin, Vector3 dir, Real32 reach, struct PickedPos* pos) {
 	bool noClip = !Game_CameraClipping || LocalPlayer_Instance.Hacks.Noclip;
+	if (PickCache_Get(&picking_cameraCache, origin, dir, reach, noClip, pos)) return;
+
 	if (noClip || !Picking_RayTrace(origin, dir, reach, pos, Picking_ClipCamera)) {
 		PickedPos_SetAsInvalid(pos);
 		Vector3_Mul1(&pos->Intersect, &dir, reach);             /* intersect = dir * reach */
 		Vector3_Add(&pos->Intersect, &origin, &pos->Intersect); /* intersect = origin + dir * reach */
 	}
+	PickCache_Set(&picking_cameraCache, origin, dir, reach, noClip, pos);
 }
@@ -46,4 +46,7 @@ void RayTracer_Step(struct RayTracer* t);
    or not being able to find a suitable candiate within the given reach distance.*/
 void Picking_CalculatePickedBlock(Vector3 origin, Vector3 dir, Real32 reach, struct PickedPos* pos);
 void Picking_ClipCameraPos(Vector3 origin, Vector3 dir, Real32 reach, struct PickedPos* pos);
+/* Discards cached picking results, as the world or how blocks are picked has changed.
+   Results are otherwise reused while the ray's origin, direction and reach are the same. */
+void Picking_Invalidate(void);
 #endif
@@ -56,7 +56,6 @@ ReturnCode ReturnCode_SocketWouldBlock = WSAEWOULDBLOCK;
 #define Socket__Error() errno
 #define Nix_Return(success) ((success) ? 0 : errno)
 
-pthread_mutex_t event_mutex;
 
 UChar* Platform_NewLine = "\n";
 UChar Directory_Separator = '/';
@@ -435,7 +434,7 @@ ReturnCode File_GetModifiedTime(STRING_PURE String* path, DateTime* time) {
 	struct stat sb;
 	if (stat(data, &sb) == -1) return errno;
 
-	DateTime_FromTotalMs(time, UNIX_EPOCH + sb.st_mtime); 
+	DateTime_FromTotalMs(time, (UNIX_EPOCH + sb.st_mtime) * 1000);
 	return 0;
 }
 
@@ -513,6 +512,11 @@ void Thread_Join(void* handle) {
 	WaitForSingleObject((HANDLE)handle, INFINITE);
 }
 
+void Thread_JoinAndFree(void* handle) {
+	Thread_Join(handle);
+	Thread_FreeHandle(handle);
+}
+
 void Thread_FreeHandle(void* handle) {
 	if (!CloseHandle((HANDLE)handle)) {
 		ErrorHandler_FailWithCode(GetLastError(), "Freeing thread handle");
@@ -561,14 +565,12 @@ void* Thread_StartCallback(void* lpParam) {
 	return NULL;
 }
 
-pthread_t threadList[3]; Int32 threadIndex;
 void* Thread_Start(Thread_StartFunc* func) {
-	if (threadIndex == Array_Elems(threadList)) ErrorHandler_Fail("Cannot allocate thread");
-	pthread_t* ptr = &threadList[threadIndex];
+	pthread_t* ptr = Mem_Alloc(1, sizeof(pthread_t), "thread");
 	int result = pthread_create(ptr, NULL, Thread_StartCallback, func);
 
 	ErrorHandler_CheckOrFail(result, "Creating thread");
-	threadIndex++; return ptr;
+	return ptr;
 }
 
 void Thread_Join(void* handle) {
@@ -576,9 +578,15 @@ void Thread_Join(void* handle) {
 	ErrorHandler_CheckOrFail(result, "Joining thread");
 }
 
+void Thread_JoinAndFree(void* handle) {
+	Thread_Join(handle);
+	Mem_Free(&handle);
+}
+
 void Thread_FreeHandle(void* handle) {
 	int result = pthread_detach(*((pthread_t*)handle));
 	ErrorHandler_CheckOrFail(result, "Detaching thread");
+	Mem_Free(&handle);
 }
 
 pthread_mutex_t mutexList[3]; Int32 mutexIndex;
@@ -606,30 +614,68 @@ void Mutex_Unlock(void* handle) {
 	ErrorHandler_CheckOrFail(result, "Unlocking mutex");
 }
 
-pthread_cond_t condList[2]; Int32 condIndex;
+/* Behaves like an auto reset event on Windows: a signal is remembered until one waiter consumes it */
+struct WaitData { pthread_cond_t Cond; pthread_mutex_t Mutex; bool Signalled; };
 void* Waitable_Create(void) {
-	if (condIndex == Array_Elems(condList)) ErrorHandler_Fail("Cannot allocate event");
-	pthread_cond_t* ptr = &condList[condIndex];
-	int result = pthread_cond_init(ptr, NULL);
-
+	struct WaitData* ptr = Mem_Alloc(1, sizeof(struct WaitData), "waitable");
+	int result = pthread_cond_init(&ptr->Cond, NULL);
 	ErrorHandler_CheckOrFail(result, "Creating event");
-	condIndex++; return ptr;
+
+	result = pthread_mutex_init(&ptr->Mutex, NULL);
+	ErrorHandler_CheckOrFail(result, "Creating event mutex");
+	ptr->Signalled = false;
+	return ptr;
 }
 
 void Waitable_Free(void* handle) {
-	int result = pthread_cond_destroy((pthread_cond_t*)handle);
+	struct WaitData* ptr = (struct WaitData*)handle;
+	int result = pthread_cond_destroy(&ptr->Cond);
 	ErrorHandler_CheckOrFail(result, "Destroying event");
+
+	result = pthread_mutex_destroy(&ptr->Mutex);
+	ErrorHandler_CheckOrFail(result, "Destroying event mutex");
+	Mem_Free(&handle);
 }
 
 void Waitable_Signal(void* handle) {
-	int result = pthread_cond_signal((pthread_cond_t*)handle);
+	struct WaitData* ptr = (struct WaitData*)handle;
+	Mutex_Lock(&ptr->Mutex);
+	ptr->Signalled = true;
+	int result = pthread_cond_signal(&ptr->Cond);
+	Mutex_Unlock(&ptr->Mutex);
 	ErrorHandler_CheckOrFail(result, "Signalling event");
 }
 
 void Waitable_Wait(void* handle) {
-	int result = pthread_cond_wait((pthread_cond_t*)handle, &event_mutex);
+	struct WaitData* ptr = (struct WaitData*)handle;
+	int result = 0;
+	Mutex_Lock(&ptr->Mutex);
+	while (!ptr->Signalled && !result) {
+		result = pthread_cond_wait(&ptr->Cond, &ptr->Mutex);
+	}
+	ptr->Signalled = false;
+	Mutex_Unlock(&ptr->Mutex);
 	ErrorHandler_CheckOrFail(result, "Waiting event");
 }
+
+void Waitable_WaitFor(void* handle, UInt32 milliseconds) {
+	struct WaitData* ptr = (struct WaitData*)handle;
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec  += milliseconds / 1000;
+	ts.tv_nsec += (milliseconds % 1000) * 1000000;
+	if (ts.tv_nsec >= 1000000000) { ts.tv_sec++; ts.tv_nsec -= 1000000000; }
+
+	int result = 0;
+	Mutex_Lock(&ptr->Mutex);
+	while (!ptr->Signalled && !result) {
+		result = pthread_cond_timedwait(&ptr->Cond, &ptr->Mutex, &ts);
+	}
+	ptr->Signalled = false;
+	Mutex_Unlock(&ptr->Mutex);
+	if (result == ETIMEDOUT) return;
+	ErrorHandler_CheckOrFail(result, "Waiting timed event");
+}
 #endif
 
 
@@ -923,6 +969,14 @@ ReturnCode Http_GetRequestHeaders(struct AsyncRequest* request, void* handle, UI
 	bufferLen = etag.capacity;
 	Http_Query(HTTP_QUERY_ETAG, etag.buffer);
 
+	UChar cacheBuffer[String_BufferSize(STRING_SIZE)];
+	String cache = String_InitAndClearArray(cacheBuffer);
+	bufferLen = cache.capacity;
+	request->MaxAge = -1;
+	if (Http_Query(HTTP_QUERY_CACHE_CONTROL, cache.buffer)) {
+		cache.length = (UInt16)bufferLen;
+		request->MaxAge = AsyncDownloader_ParseMaxAge(&cache);
+	}
 	return 0;
 }
 
@@ -1190,12 +1244,9 @@ static void Platform_InitDisplay(void) {
 
 void Platform_Init(void) {
 	Platform_InitDisplay();
-	pthread_mutex_init(&event_mutex, NULL);
 }
 
-void Platform_Free(void) {
-	pthread_mutex_destroy(&event_mutex);
-}
+void Platform_Free(void) { }
 
 void Platform_Exit(ReturnCode code) { exit(code); }
 
@@ -76,6 +76,8 @@ void Thread_Sleep(UInt32 milliseconds);
 typedef void Thread_StartFunc(void);
 void* Thread_Start(Thread_StartFunc* func);
 void Thread_Join(void* handle);
+/* Waits for the thread to exit, then frees handle to it */
+void Thread_JoinAndFree(void* handle);
 /* Frees handle to thread - NOT THE THREAD ITSELF */
 void Thread_FreeHandle(void* handle);
 
@@ -13,6 +13,7 @@
 #include "AsyncDownloader.h"
 #include "ExtMath.h"
 #include "Utils.h"
+#include "ServerConnection.h"
 
 //#define CC_TEST_VORBIS
 #ifdef CC_TEST_VORBIS
@@ -45,6 +46,37 @@ int main_imdct() {
 }
 #endif
 
+/* Parses '--replay [path] [speed]', where flag is the '--replay' argument as it was typed. Path may contain */
+/*  spaces when wrapped in quotes, otherwise the rest of the line is used as the path (and so speed can't be given) */
+static bool Program_ParseReplayArgs(STRING_PURE String* rawArgs, STRING_PURE String* flag) {
+	Int32 start = String_IndexOfString(rawArgs, flag);
+	if (start == -1) { Platform_LogConst("Missing --replay in command line"); return false; }
+
+	String args = String_UNSAFE_SubstringAt(rawArgs, start + flag->length);
+	String path, speed = String_MakeNull();
+	String_UNSAFE_TrimStart(&args);
+	String_UNSAFE_TrimEnd(&args);
+
+	if (args.length && args.buffer[0] == '"') {
+		Int32 end = String_IndexOf(&args, '"', 1);
+		if (end == -1) { Platform_LogConst("Missing closing \" in replay path"); return false; }
+
+		path  = String_UNSAFE_Substring(&args, 1, end - 1);
+		speed = String_UNSAFE_SubstringAt(&args, end + 1);
+		String_UNSAFE_TrimStart(&speed);
+	} else {
+		path = args;
+	}
+
+	if (!path.length) { Platform_LogConst("Missing replay path"); return false; }
+	String_Set(&ServerConnection_ReplayPath, &path);
+
+	if (speed.length && (!Convert_TryParseReal32(&speed, &ServerConnection_ReplaySpeed) || ServerConnection_ReplaySpeed <= 0.0f)) {
+		Platform_LogConst("Invalid replay speed"); return false;
+	}
+	return true;
+}
+
 int main(void) {
 	Platform_SetWorkingDir();
 	ErrorHandler_Init("client.log");
@@ -97,7 +129,19 @@ int main(void) {
 	String args[5]; Int32 argsCount = Array_Elems(args);
 	String_UNSAFE_Split(&rawArgs, ' ', args, &argsCount);
 
-	if (argsCount == 1) {
+	if (String_CaselessEqualsConst(&args[0], "--replay")) {
+		/* Re-parse from the raw line, as splitting on spaces breaks paths with spaces */
+		String name = String_FromConst("Replay");
+		String_Set(&Game_Username, &name);
+		if (!Program_ParseReplayArgs(&rawArgs, &args[0])) return 1;
+	} else if (String_CaselessEqualsConst(&args[0], "--localserver")) {
+		String name = String_FromConst("Player");
+		String ip   = String_FromConst("127.0.0.1");
+		String_Set(&Game_Username,  &name);
+		String_Set(&Game_IPAddress, &ip);
+		Game_Port = 25565;
+		ServerConnection_UseLocalServer = true;
+	} else if (argsCount == 1) {
 		String name = args[0];
 		if (!name.length) name = String_FromReadonly("Singleplayer");
 		String_Set(&Game_Username, &name);
@@ -20,6 +20,7 @@
 #include "Block.h"
 #include "Menus.h"
 #include "World.h"
+#include "BlockPhysics.h"
 
 struct InventoryScreen {
 	Screen_Layout
@@ -285,11 +286,19 @@ static void StatusScreen_MakeText(struct StatusScreen* screen, STRING_TRANSIENT
 		}
 		Int32 indices = ICOUNT(Game_Vertices);
 		String_Format1(status, "%i vertices", &indices);
+		String_Format2(status, ", %i state changes (%i skipped)", &GfxCommon_StateChanges, &GfxCommon_StateChangesSkipped);
 
 		Int32 ping = PingList_AveragePingMs();
 		if (ping) {
 			String_Format1(status, ", ping %i ms", &ping);
 		}
+		if (Net_SendQueueDepth) {
+			Int32 latency = (Int32)Net_SendLatencyMs;
+			String_Format2(status, ", %i queued (%i ms)", &Net_SendQueueDepth, &latency);
+		}
+		if (Physics_Backlog) {
+			String_Format2(status, ", physics %i tps (%i behind)", &Physics_TicksPerSecond, &Physics_Backlog);
+		}
 	}
 }
 
@@ -477,6 +486,12 @@ static void LoadingScreen_MapLoading(void* obj, Real32 progress) {
 	screen->Progress = progress;
 }
 
+static void LoadingScreen_MapLoaded(void* obj) {
+	struct LoadingScreen* screen = (struct LoadingScreen*)obj;
+	/* Map is being shown while the rest of it is still being received */
+	screen->BlocksWorld = false;
+}
+
 static void LoadingScreen_OnResize(struct GuiElem* elem) {
 	struct LoadingScreen* screen = (struct LoadingScreen*)elem;
 	Widget_Reposition(&screen->Title);
@@ -566,6 +581,7 @@ static void LoadingScreen_Init(struct GuiElem* elem) {
 	LoadingScreen_ContextRecreated(screen);
 
 	Event_RegisterReal(&WorldEvents_Loading,        screen, LoadingScreen_MapLoading);
+	Event_RegisterVoid(&WorldEvents_MapLoaded,      screen, LoadingScreen_MapLoaded);
 	Event_RegisterVoid(&GfxEvents_ContextLost,      screen, LoadingScreen_ContextLost);
 	Event_RegisterVoid(&GfxEvents_ContextRecreated, screen, LoadingScreen_ContextRecreated);
 }
@@ -575,7 +591,7 @@ static void LoadingScreen_Init(struct GuiElem* elem) {
 static void LoadingScreen_Render(struct GuiElem* elem, Real64 delta) {
 	struct LoadingScreen* screen = (struct LoadingScreen*)elem;
 	Gfx_SetTexturing(true);
-	LoadingScreen_DrawBackground();
+	if (screen->BlocksWorld) LoadingScreen_DrawBackground();
 	Elem_Render(&screen->Title, delta);
 	Elem_Render(&screen->Message, delta);
 	Gfx_SetTexturing(false);
@@ -596,6 +612,7 @@ static void LoadingScreen_Free(struct GuiElem* elem) {
 	LoadingScreen_ContextLost(screen);
 
 	Event_UnregisterReal(&WorldEvents_Loading,        screen, LoadingScreen_MapLoading);
+	Event_UnregisterVoid(&WorldEvents_MapLoaded,      screen, LoadingScreen_MapLoaded);
 	Event_UnregisterVoid(&GfxEvents_ContextLost,      screen, LoadingScreen_ContextLost);
 	Event_UnregisterVoid(&GfxEvents_ContextRecreated, screen, LoadingScreen_ContextRecreated);
 }
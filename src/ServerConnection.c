@@ -20,6 +20,10 @@
 #include "Inventory.h"
 #include "Platform.h"
 #include "GameStructs.h"
+#include "Stream.h"
+#include "Options.h"
+#include "Errors.h"
+#include "LocalServer.h"
 
 /*########################################################################################################################*
 *-----------------------------------------------------Common handlers-----------------------------------------------------*
@@ -211,7 +215,6 @@ static void SPConnection_SendPlayerClick(MouseButton button, bool isDown, Entity
 static void SPConnection_Tick(struct ScheduledTask* task) {
 	if (ServerConnection_Disconnected) return;
 	if ((ServerConnection_Ticks % 3) == 0) {
-		Physics_Tick();
 		ServerConnection_CheckAsyncResources();
 	}
 	ServerConnection_Ticks++;
@@ -234,13 +237,152 @@ void ServerConnection_InitSingleplayer(void) {
 }
 
 
+/*########################################################################################################################*
+*----------------------------------------------------Packet statistics----------------------------------------------------*
+*#########################################################################################################################*/
+/* Bucket i counts handler calls taking less than 2^i microseconds (last bucket counts everything slower) */
+#define NETSTATS_BUCKETS 20
+struct NetStat {
+	UInt32 Packets, Bytes, MaxMicros;
+	Int64 TotalMicros;
+	UInt32 Buckets[NETSTATS_BUCKETS];
+};
+struct NetStat netStats[OPCODE_COUNT];
+
+const UChar* netStats_Names[OPCODE_COUNT] = {
+	"Handshake", "Ping", "LevelBegin", "LevelData", "LevelEnd", "SetBlockClient", "SetBlock",
+	"AddEntity", "EntityTeleport", "RelPosAndOriUpdate", "RelPosUpdate", "OriUpdate", "RemoveEntity",
+	"Message", "Kick", "SetPermission", "ExtInfo", "ExtEntry", "SetReach", "CustomBlockLevel",
+	"HoldThis", "SetTextHotkey", "ExtAddPlayerName", "ExtAddEntity", "ExtRemovePlayerName",
+	"EnvSetColor", "MakeSelection", "RemoveSelection", "SetBlockPermission", "SetModel",
+	"EnvSetMapAppearance", "EnvSetWeather", "HackControl", "ExtAddEntity2", "PlayerClick",
+	"DefineBlock", "UndefineBlock", "DefineBlockExt", "BulkBlockUpdate", "SetTextColor",
+	"EnvSetMapUrl", "EnvSetMapProperty", "SetEntityProperty", "TwoWayPing", "SetInventoryOrder",
+};
+
+void NetStats_Reset(void) { Mem_Set(netStats, 0, sizeof(netStats)); }
+
+static void NetStats_Add(UInt8 opcode, UInt32 size, Int32 micros) {
+	struct NetStat* stat = &netStats[opcode];
+	UInt32 elapsed = (UInt32)max(0, micros);
+	stat->Packets++; stat->Bytes += size;
+	stat->TotalMicros += elapsed;
+	stat->MaxMicros = max(stat->MaxMicros, elapsed);
+
+	Int32 bucket = 0;
+	while (elapsed && bucket < NETSTATS_BUCKETS - 1) { elapsed >>= 1; bucket++; }
+	stat->Buckets[bucket]++;
+}
+
+/* Estimates a percentile, using the upper bound of the bucket it falls into */
+static Int32 NetStats_Percentile(struct NetStat* stat, Real32 percentile) {
+	UInt32 target = (UInt32)(stat->Packets * percentile), count = 0;
+	Int32 i;
+	for (i = 0; i < NETSTATS_BUCKETS - 1; i++) {
+		count += stat->Buckets[i];
+		if (count > target) return 1 << i;
+	}
+	return stat->MaxMicros;
+}
+
+void NetStats_Print(void) {
+	UInt8 order[OPCODE_COUNT];
+	Int32 i, j, count = 0;
+
+	/* Insertion sort used opcodes by total handler time, slowest first */
+	for (i = 0; i < OPCODE_COUNT; i++) {
+		if (!netStats[i].Packets) continue;
+		for (j = count; j > 0 && netStats[order[j - 1]].TotalMicros < netStats[i].TotalMicros; j--) {
+			order[j] = order[j - 1];
+		}
+		order[j] = (UInt8)i; count++;
+	}
+
+	if (!count) { Chat_AddRaw("&eNo packets have been received yet"); return; }
+	UChar lineBuffer[String_BufferSize(STRING_SIZE * 2)];
+	for (i = 0; i < count && i < 8; i++) {
+		struct NetStat* stat = &netStats[order[i]];
+		String line = String_InitAndClearArray(lineBuffer);
+		Real32 totalMs = stat->TotalMicros / 1000.0f;
+		Int32 p50 = NetStats_Percentile(stat, 0.50f), p99 = NetStats_Percentile(stat, 0.99f);
+
+		String_Format3(&line, "&a%c&f: %i packets, %i bytes, ", netStats_Names[order[i]], &stat->Packets, &stat->Bytes);
+		String_Format4(&line, "%f2 ms total, p50 <%i us, p99 <%i us, max %i us", &totalMs, &p50, &p99, &stat->MaxMicros);
+		Chat_Add(&line);
+	}
+}
+
+ReturnCode NetStats_Export(STRING_PURE String* path) {
+	void* file; ReturnCode res = File_Create(&file, path);
+	if (res) return res;
+	struct Stream stream; Stream_FromFile(&stream, file);
+
+	UChar lineBuffer[String_BufferSize(2048)];
+	String line = String_InitAndClearArray(lineBuffer);
+	Int32 i, j;
+
+	String_AppendConst(&line, "opcode,name,packets,bytes,total_ms,max_us");
+	for (j = 0; j < NETSTATS_BUCKETS - 1; j++) {
+		Int32 bound = 1 << j;
+		String_Format1(&line, ",lt%ius", &bound);
+	}
+	String_AppendConst(&line, ",slower");
+	res = Stream_WriteLine(&stream, &line);
+
+	for (i = 0; i < OPCODE_COUNT && !res; i++) {
+		struct NetStat* stat = &netStats[i];
+		Real32 totalMs = stat->TotalMicros / 1000.0f;
+		String_Clear(&line);
+
+		String_Format4(&line, "%i,%c,%i,%i,", &i, netStats_Names[i], &stat->Packets, &stat->Bytes);
+		String_Format2(&line, "%f3,%i", &totalMs, &stat->MaxMicros);
+		for (j = 0; j < NETSTATS_BUCKETS; j++) {
+			String_Format1(&line, ",%i", &stat->Buckets[j]);
+		}
+		res = Stream_WriteLine(&stream, &line);
+	}
+
+	ReturnCode closeRes = stream.Close(&stream);
+	return res ? res : closeRes;
+}
+
+static void Net_HandlePacket(UInt8* data, UInt32 size) {
+	UInt8 opcode = data[0];
+	if (!NetStats_Enabled) { Net_Handlers[opcode](data + 1); return; }
+
+	struct Stopwatch timer; Stopwatch_Start(&timer);
+	Net_Handlers[opcode](data + 1); /* skip opcode */
+	NetStats_Add(opcode, size, Stopwatch_ElapsedMicroseconds(&timer));
+}
+
+
 /*########################################################################################################################*
 *--------------------------------------------------Multiplayer connection-------------------------------------------------*
 *#########################################################################################################################*/
 SocketPtr net_socket;
-UInt8 net_readBuffer[4096 * 5];
-UInt8 net_writeBuffer[131];
-UInt8* net_readCurrent;
+UInt8 net_writeBuffer[NET_MAX_SEND_SIZE];
+
+/* Packets written by the client are queued, then sent with non-blocking writes as the socket allows. */
+/* Position updates are kept aside in a single slot, which newer positions replace until it is sent. */
+/* The slot is only moved into the queue once everything else (block changes, clicks, chat) has been sent. */
+struct NetSendEntry { struct Stopwatch QueuedAt; UInt8 Size; UInt8 Data[NET_MAX_SEND_SIZE]; };
+struct NetSendEntry* net_sendQueue;
+UInt32 net_sendCapacity, net_sendHead, net_sendCount;
+/* Number of bytes of the entry at the head of the queue which have already been written */
+UInt32 net_sendOffset;
+struct NetSendEntry net_pendingPos;
+bool net_hasPendingPos;
+#define NET_SEND_INITIAL_SIZE 64
+
+/* Received data is stored in a ring buffer, so unprocessed bytes never need to be moved back to the start. */
+/* Capacity is always a power of two, and grows when more data is pending than there is free space for. */
+UInt8* net_readBuffer;
+UInt32 net_readCapacity, net_readHead, net_readCount;
+/* Packets that wrap around the end of the ring buffer are joined back together in here */
+UInt8 net_packetBuffer[NET_MAX_PACKET_SIZE];
+#define NET_READ_INITIAL_SIZE (4096 * 8)
+/* Stop reading after this many bytes in one tick, so a flooding server can't stall the game forever */
+#define NET_READ_MAX_PER_TICK (1024 * 1024 * 4)
 
 bool net_writeFailed;
 Int32 net_ticks;
@@ -251,6 +393,20 @@ Real64 net_discAccumulator;
 bool net_connecting;
 Int64 net_connectTimeout;
 #define NET_TIMEOUT_MS (15 * 1000)
+/* Whether packets are being read from a recorded file, instead of from a socket */
+bool net_replaying;
+
+/* Received packets are recorded as: [U32 BE ms since connecting] [U16 BE size] [size bytes, including opcode] */
+struct Stream net_recordStream;
+UInt8 net_recordBuffer[4096 * 16];
+UInt32 net_recordUsed;
+DateTime net_recordStart;
+UChar net_recordPathBuffer[String_BufferSize(FILENAME_SIZE)];
+String net_recordPath = String_FromEmptyArray(net_recordPathBuffer);
+/* File starts with: [U32 BE magic] [U16 BE version] */
+#define NET_RECORD_MAGIC 0x43434E52UL /* CCNR */
+#define NET_RECORD_VERSION 1
+#define NET_RECORD_HEADER_SIZE 6
 
 static void MPConnection_BlockChanged(void* obj, Vector3I coords, BlockID oldBlock, BlockID block) {
 	Vector3I p = coords;
@@ -263,17 +419,69 @@ static void MPConnection_BlockChanged(void* obj, Vector3I coords, BlockID oldBlo
 	Net_SendPacket();
 }
 
+static void MPConnection_StopRecording(void) {
+	if (!net_recordStream.Meta.File) return;
+	ReturnCode res = 0;
+	if (net_recordUsed) res = Stream_Write(&net_recordStream, net_recordBuffer, net_recordUsed);
+	net_recordUsed = 0;
+
+	if (res) Chat_LogError(res, "writing to", &net_recordPath);
+	res = net_recordStream.Close(&net_recordStream);
+	if (res) Chat_LogError(res, "closing", &net_recordPath);
+}
+
+static void MPConnection_StartRecording(void) {
+	if (!Utils_EnsureDirectory("packets")) return;
+	DateTime now; DateTime_CurrentLocal(&now);
+	Int32 year = now.Year, month = now.Month, day = now.Day;
+	Int32 hour = now.Hour, minute = now.Minute, second = now.Second;
+
+	String_Clear(&net_recordPath);
+	String_Format4(&net_recordPath, "packets%r%p4-%p2-%p2", &Directory_Separator, &year, &month, &day);
+	String_Format3(&net_recordPath, "_%p2-%p2-%p2.ccnet", &hour, &minute, &second);
+
+	void* file; ReturnCode res = File_Create(&file, &net_recordPath);
+	if (res) { Chat_LogError(res, "creating", &net_recordPath); return; }
+	Stream_FromFile(&net_recordStream, file);
+
+	Stream_SetU32_BE(&net_recordBuffer[0], NET_RECORD_MAGIC);
+	Stream_SetU16_BE(&net_recordBuffer[4], NET_RECORD_VERSION);
+	net_recordUsed = 6;
+	DateTime_CurrentUTC(&net_recordStart);
+}
+
+static void MPConnection_RecordPacket(UInt8* data, UInt32 size) {
+	if (net_recordUsed + NET_RECORD_HEADER_SIZE + size > sizeof(net_recordBuffer)) {
+		ReturnCode res = Stream_Write(&net_recordStream, net_recordBuffer, net_recordUsed);
+		net_recordUsed = 0;
+		if (res) { Chat_LogError(res, "writing to", &net_recordPath); MPConnection_StopRecording(); return; }
+	}
+
+	UInt8* ptr = &net_recordBuffer[net_recordUsed];
+	Stream_SetU32_BE(ptr,     (UInt32)DateTime_MsBetween(&net_recordStart, &net_lastPacket));
+	Stream_SetU16_BE(ptr + 4, (UInt16)size);
+	Mem_Copy(ptr + NET_RECORD_HEADER_SIZE, data, size);
+	net_recordUsed += NET_RECORD_HEADER_SIZE + size;
+}
+
 static void ServerConnection_Free(void);
 static void MPConnection_FinishConnect(void) {
 	net_connecting = false;
 	Event_RaiseReal(&WorldEvents_Loading, 0.0f);
-	net_readCurrent = net_readBuffer;
+	net_readHead = 0; net_readCount = 0;
+	net_sendHead = 0; net_sendCount = 0; net_sendOffset = 0;
+	net_hasPendingPos = false; Net_SendQueueDepth = 0;
+	if (!net_readBuffer) {
+		net_readCapacity = NET_READ_INITIAL_SIZE;
+		net_readBuffer   = Mem_Alloc(net_readCapacity, sizeof(UInt8), "network read buffer");
+	}
 	ServerConnection_WriteBuffer = net_writeBuffer;
 
 	Handlers_Reset();
 	Classic_WriteLogin(&Game_Username, &Game_Mppass);
 	Net_SendPacket();
 	DateTime_CurrentUTC(&net_lastPacket);
+	if (Options_GetBool(OPT_RECORD_PACKETS, false)) MPConnection_StartRecording();
 }
 
 static void MPConnection_FailConnect(ReturnCode result) {
@@ -309,8 +517,8 @@ static void MPConnection_TickConnect(void) {
 	bool poll_write = false;
 	Socket_Select(net_socket, SOCKET_SELECT_WRITE, &poll_write);
 
+	/* Socket is left non-blocking, so sending packets never stalls the game */
 	if (poll_write) {
-		Socket_SetBlocking(net_socket, true);
 		MPConnection_FinishConnect();
 	} else if (nowMS > net_connectTimeout) {
 		MPConnection_FailConnect(0);
@@ -321,9 +529,14 @@ static void MPConnection_TickConnect(void) {
 }
 
 static void MPConnection_BeginConnect(void) {
-	Socket_Create(&net_socket);
 	Event_RegisterBlock(&UserEvents_BlockChanged, NULL, MPConnection_BlockChanged);
 	ServerConnection_Disconnected = false;
+	if (ServerConnection_UseLocalServer) {
+		LocalServer_Start();
+		MPConnection_FinishConnect(); return;
+	}
+
+	Socket_Create(&net_socket);
 
 	Socket_SetBlocking(net_socket, false);
 	net_connecting = true;
@@ -377,25 +590,146 @@ static void MPConnection_CheckDisconnection(Real64 delta) {
 	}
 }
 
+static void MPConnection_GrowReadBuffer(UInt32 required) {
+	UInt32 capacity = net_readCapacity;
+	while (capacity < required) capacity *= 2;
+	UInt8* buffer = Mem_Alloc(capacity, sizeof(UInt8), "network read buffer");
+
+	/* Unwrap the existing data to the start of the new buffer */
+	UInt32 first = min(net_readCount, net_readCapacity - net_readHead);
+	Mem_Copy(buffer, &net_readBuffer[net_readHead], first);
+	Mem_Copy(buffer + first, net_readBuffer, net_readCount - first);
+
+	Mem_Free(&net_readBuffer);
+	net_readBuffer   = buffer;
+	net_readCapacity = capacity;
+	net_readHead     = 0;
+}
+
+static ReturnCode MPConnection_Available(UInt32* pending) {
+	if (!ServerConnection_UseLocalServer) return Socket_Available(net_socket, pending);
+	*pending = LocalServer_Available(); return 0;
+}
+
+static ReturnCode MPConnection_Read(UInt8* buffer, UInt32 count, UInt32* read) {
+	if (!ServerConnection_UseLocalServer) return Socket_Read(net_socket, buffer, count, read);
+	LocalServer_Read(buffer, count, read); return 0;
+}
+
+static ReturnCode MPConnection_Write(UInt8* buffer, UInt32 count, UInt32* wrote) {
+	if (!ServerConnection_UseLocalServer) return Socket_Write(net_socket, buffer, count, wrote);
+	LocalServer_Write(buffer, count); *wrote = count; return 0;
+}
+
+static ReturnCode MPConnection_ReadSocket(void) {
+	UInt32 total = 0;
+	while (total < NET_READ_MAX_PER_TICK) {
+		UInt32 pending = 0;
+		ReturnCode res = MPConnection_Available(&pending);
+		if (res || !pending) return res;
+
+		if (pending > net_readCapacity - net_readCount) {
+			MPConnection_GrowReadBuffer(net_readCount + pending);
+		}
+
+		/* Read into the contiguous free space that follows the used data */
+		UInt32 tail = (net_readHead + net_readCount) & (net_readCapacity - 1);
+		UInt32 space = tail >= net_readHead ? net_readCapacity - tail : net_readHead - tail;
+		UInt32 read = 0;
+
+		res = MPConnection_Read(&net_readBuffer[tail], min(pending, space), &read);
+		if (res || !read) return res;
+		net_readCount += read; total += read;
+	}
+	return 0;
+}
+
+static void MPConnection_GrowSendQueue(void) {
+	UInt32 capacity = net_sendCapacity ? net_sendCapacity * 2 : NET_SEND_INITIAL_SIZE;
+	struct NetSendEntry* queue = Mem_Alloc(capacity, sizeof(struct NetSendEntry), "network send queue");
+
+	UInt32 i;
+	for (i = 0; i < net_sendCount; i++) {
+		queue[i] = net_sendQueue[(net_sendHead + i) & (net_sendCapacity - 1)];
+	}
+
+	Mem_Free(&net_sendQueue);
+	net_sendQueue    = queue;
+	net_sendCapacity = capacity;
+	net_sendHead     = 0;
+}
+
+static void MPConnection_Enqueue(struct NetSendEntry* src) {
+	if (net_sendCount == net_sendCapacity) MPConnection_GrowSendQueue();
+	net_sendQueue[(net_sendHead + net_sendCount) & (net_sendCapacity - 1)] = *src;
+	net_sendCount++;
+}
+
+static void MPConnection_ConsumeSent(UInt32 wrote) {
+	while (wrote) {
+		struct NetSendEntry* entry = &net_sendQueue[net_sendHead];
+		UInt32 left = entry->Size - net_sendOffset;
+		if (wrote < left) { net_sendOffset += wrote; return; }
+
+		wrote -= left; net_sendOffset = 0;
+		Real32 latencyMs = Stopwatch_ElapsedMicroseconds(&entry->QueuedAt) / 1000.0f;
+		/* Smoothed, so a single slow packet doesn't dominate */
+		Net_SendLatencyMs = Net_SendLatencyMs * 0.9f + latencyMs * 0.1f;
+
+		net_sendHead = (net_sendHead + 1) & (net_sendCapacity - 1);
+		net_sendCount--;
+	}
+}
+
+static void MPConnection_FlushSendQueue(void) {
+	UInt8 data[4096];
+	while (!net_writeFailed) {
+		if (!net_sendCount && net_hasPendingPos) {
+			MPConnection_Enqueue(&net_pendingPos);
+			net_hasPendingPos = false;
+		}
+		if (!net_sendCount) break;
+
+		/* Join as many queued packets as fit into one write, resuming from any partially written packet */
+		UInt32 i, size = 0, offset = net_sendOffset;
+		for (i = 0; i < net_sendCount; i++) {
+			struct NetSendEntry* entry = &net_sendQueue[(net_sendHead + i) & (net_sendCapacity - 1)];
+			UInt32 len = entry->Size - offset;
+			if (size + len > sizeof(data)) break;
+
+			Mem_Copy(&data[size], &entry->Data[offset], len);
+			size += len; offset = 0;
+		}
+
+		UInt32 wrote = 0;
+		ReturnCode res = MPConnection_Write(data, size, &wrote);
+		if (res == ReturnCode_SocketWouldBlock) break;
+		/* NOTE: Not immediately disconnecting here, as otherwise we sometimes miss out on kick messages */
+		if (res || !wrote) { net_writeFailed = true; break; }
+
+		MPConnection_ConsumeSent(wrote);
+		/* OS send buffer is full, try again next tick */
+		if (wrote < size) break;
+	}
+	Net_SendQueueDepth = net_sendCount + net_hasPendingPos;
+}
+
 static void MPConnection_Tick(struct ScheduledTask* task) {
 	if (ServerConnection_Disconnected) return;
 	if (net_connecting) { MPConnection_TickConnect(); return; }
 
 	DateTime now; DateTime_CurrentUTC(&now);
-	if (DateTime_MsBetween(&net_lastPacket, &now) >= 30 * 1000) {
+	if (ServerConnection_UseLocalServer) {
+		LocalServer_Tick(task->Interval);
+	} else if (DateTime_MsBetween(&net_lastPacket, &now) >= 30 * 1000) {
 		MPConnection_CheckDisconnection(task->Interval);
 	}
 	if (ServerConnection_Disconnected) return;
 
-	UInt32 pending = 0;
-	ReturnCode res = Socket_Available(net_socket, &pending);
-	UInt8* readEnd = net_readCurrent;
-
-	if (!res && pending) {
-		/* NOTE: Always using a read call that is a multiple of 4096 (appears to?) improve read performance */	
-		res = Socket_Read(net_socket, net_readCurrent, 4096 * 4, &pending);
-		readEnd += pending;
-	}
+	UInt32 oldCount = net_readCount;
+	ReturnCode res = MPConnection_ReadSocket();
+	Net_TickBytesRead   = net_readCount - oldCount;
+	Net_TickPacketsRead = 0;
 
 	if (res) {
 		UChar msgBuffer[String_BufferSize(STRING_SIZE * 2)];
@@ -409,13 +743,14 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		return;
 	}
 
-	net_readCurrent = net_readBuffer;
-	while (net_readCurrent < readEnd) {
-		UInt8 opcode = net_readCurrent[0];
+	UInt32 mask = net_readCapacity - 1;
+	Game_BeginBlockUpdates();
+	while (net_readCount) {
+		UInt8 opcode = net_readBuffer[net_readHead];
 		/* Workaround for older D3 servers which wrote one byte too many for HackControl packets */
 		if (cpe_needD3Fix && net_lastOpcode == OPCODE_HACK_CONTROL && (opcode == 0x00 || opcode == 0xFF)) {
 			Platform_LogConst("Skipping invalid HackControl byte from D3 server");
-			net_readCurrent++;
+			net_readHead = (net_readHead + 1) & mask; net_readCount--;
 
 			struct LocalPlayer* p = &LocalPlayer_Instance;
 			p->Physics.JumpVel = 0.42f; /* assume default jump height */
@@ -426,44 +761,49 @@ static void MPConnection_Tick(struct ScheduledTask* task) {
 		if (opcode >= OPCODE_COUNT) {
 			String title = String_FromConst("Disconnected");
 			String msg   = String_FromConst("Server sent invalid packet!");
-			Game_Disconnect(&title, &msg); return; 
+			Game_Disconnect(&title, &msg); break;
 		}
 
-		if (net_readCurrent + Net_PacketSizes[opcode] > readEnd) break;
+		UInt32 size = Net_PacketSizes[opcode];
+		if (size > net_readCount) break;
 		net_lastOpcode = opcode;
 		DateTime_CurrentUTC(&net_lastPacket);
 
-		Net_Handler handler = Net_Handlers[opcode];
-		if (!handler) { 
+		if (!Net_Handlers[opcode]) { 
 			String title = String_FromConst("Disconnected");
 			String msg = String_FromConst("Server sent invalid packet!");
-			Game_Disconnect(&title, &msg); return;
+			Game_Disconnect(&title, &msg); break;
 		}
 
-		handler(net_readCurrent + 1);  /* skip opcode */
-		net_readCurrent += Net_PacketSizes[opcode];
-	}
+		UInt8* data = &net_readBuffer[net_readHead];
+		if (net_readHead + size > net_readCapacity) {
+			UInt32 first = net_readCapacity - net_readHead;
+			Mem_Copy(net_packetBuffer, data, first);
+			Mem_Copy(net_packetBuffer + first, net_readBuffer, size - first);
+			data = net_packetBuffer;
+		}
 
-	/* Keep last few unprocessed bytes, don't care about rest since they'll be overwritten on socket read */
-	UInt32 i, remaining = (UInt32)(readEnd - net_readCurrent);
-	for (i = 0; i < remaining; i++) {
-		net_readBuffer[i] = net_readCurrent[i];
+		if (net_recordStream.Meta.File) MPConnection_RecordPacket(data, size);
+		Net_HandlePacket(data, size);
+		/* Handler may have disconnected us (e.g. kick packet), which also frees the read buffer */
+		if (ServerConnection_Disconnected) break;
+		net_readHead = (net_readHead + size) & mask; net_readCount -= size;
+		Net_TickPacketsRead++;
 	}
-	net_readCurrent = net_readBuffer + remaining;
+	Game_EndBlockUpdates();
+	if (ServerConnection_Disconnected) return;
 
 	/* Network is ticked 60 times a second. We only send position updates 20 times a second */
 	if ((net_ticks % 3) == 0) {
 		ServerConnection_CheckAsyncResources();
 		Handlers_Tick();
-		/* Have any packets been written? */
-		if (ServerConnection_WriteBuffer != net_writeBuffer) {
-			Net_SendPacket();
-		}
 	}
+	MPConnection_FlushSendQueue();
 	net_ticks++;
 }
 
 void Net_Set(UInt8 opcode, Net_Handler handler, UInt16 packetSize) {
+	if (packetSize > NET_MAX_PACKET_SIZE) ErrorHandler_Fail("Net_Set - packet size too large");
 	Net_Handlers[opcode] = handler;
 	Net_PacketSizes[opcode] = packetSize;
 }
@@ -471,22 +811,29 @@ void Net_Set(UInt8 opcode, Net_Handler handler, UInt16 packetSize) {
 void Net_SendPacket(void) {
 	UInt32 count = (UInt32)(ServerConnection_WriteBuffer - net_writeBuffer);
 	ServerConnection_WriteBuffer = net_writeBuffer;
-	if (ServerConnection_Disconnected) return;
-
-	/* NOTE: Not immediately disconnecting here, as otherwise we sometimes miss out on kick messages */
-	UInt32 wrote = 0;
-	UInt8* ptr = net_writeBuffer;
-
-	while (count) {
-		ReturnCode res = Socket_Write(net_socket, ptr, count, &wrote);
-		if (res || !wrote) { net_writeFailed = true; break; }
-		ptr += wrote; count -= wrote;
+	/* Replays have no server to send to, so just discard client packets */
+	if (ServerConnection_Disconnected || !count || net_replaying) return;
+
+	struct NetSendEntry entry;
+	Stopwatch_Start(&entry.QueuedAt);
+	entry.Size = (UInt8)count;
+	Mem_Copy(entry.Data, net_writeBuffer, count);
+
+	if (entry.Data[0] == OPCODE_ENTITY_TELEPORT) {
+		/* Only the most recent position matters, so it just replaces a position that hasn't been sent yet */
+		if (net_hasPendingPos) Net_PositionsCoalesced++;
+		net_pendingPos = entry; net_hasPendingPos = true;
+		Net_SendQueueDepth = net_sendCount + 1;
+	} else {
+		MPConnection_Enqueue(&entry);
+		MPConnection_FlushSendQueue();
 	}
 }
 
 void ServerConnection_InitMultiplayer(void) {
 	ServerConnection_ResetState();
 	ServerConnection_IsSinglePlayer = false;
+	net_replaying = false;
 
 	ServerConnection_BeginConnect = MPConnection_BeginConnect;
 	ServerConnection_SendChat = MPConnection_SendChat;
@@ -494,11 +841,118 @@ void ServerConnection_InitMultiplayer(void) {
 	ServerConnection_SendPlayerClick = MPConnection_SendPlayerClick;
 	ServerConnection_Tick = MPConnection_Tick;
 
-	net_readCurrent = net_readBuffer;
+	net_readHead = 0; net_readCount = 0;
 	ServerConnection_WriteBuffer = net_writeBuffer;
 }
 
 
+/*########################################################################################################################*
+*------------------------------------------------------Packet replay------------------------------------------------------*
+*#########################################################################################################################*/
+UChar ServerConnection_ReplayPathBuffer[String_BufferSize(FILENAME_SIZE)];
+String ServerConnection_ReplayPath = String_FromEmptyArray(ServerConnection_ReplayPathBuffer);
+Real32 ServerConnection_ReplaySpeed = 1.0f;
+
+struct Stream replay_file, replay_stream;
+UInt8 replay_buffer[4096 * 4];
+UInt8 replay_packet[NET_MAX_PACKET_SIZE];
+UInt32 replay_packetTime, replay_packetSize;
+bool replay_hasPacket;
+/* Time into the recording that has been replayed, advanced by the fixed network tick interval. */
+/* Using tick time rather than wall clock time means the same packets are handled in the same ticks every run. */
+Real64 replay_elapsedMs;
+
+static void ReplayConnection_Fail(const UChar* reason) {
+	String title = String_FromConst("Replay failed");
+	String msg   = String_FromReadonly(reason);
+	Game_Disconnect(&title, &msg);
+}
+
+static void ReplayConnection_ReadNext(void) {
+	UInt8 header[NET_RECORD_HEADER_SIZE];
+	replay_hasPacket = false;
+
+	ReturnCode res = Stream_Read(&replay_stream, header, sizeof(header));
+	if (res == ERR_END_OF_STREAM) {
+		Chat_AddRaw("&eReached end of replay");
+		return;
+	}
+
+	if (!res) {
+		replay_packetTime = Stream_GetU32_BE(header);
+		replay_packetSize = Stream_GetU16_BE(&header[4]);
+		if (!replay_packetSize || replay_packetSize > NET_MAX_PACKET_SIZE) {
+			ReplayConnection_Fail("Replay file is corrupted"); return;
+		}
+		res = Stream_Read(&replay_stream, replay_packet, replay_packetSize);
+	}
+
+	if (res) { Chat_LogError(res, "reading from", &ServerConnection_ReplayPath); return; }
+	replay_hasPacket = true;
+}
+
+static void ReplayConnection_BeginConnect(void) {
+	Event_RegisterBlock(&UserEvents_BlockChanged, NULL, MPConnection_BlockChanged);
+	ServerConnection_Disconnected = false;
+	ServerConnection_WriteBuffer  = net_writeBuffer;
+	Handlers_Reset();
+
+	void* file; ReturnCode res = File_Open(&file, &ServerConnection_ReplayPath);
+	if (res) {
+		Chat_LogError(res, "opening", &ServerConnection_ReplayPath);
+		ReplayConnection_Fail("Failed to open replay file"); return;
+	}
+	Stream_FromFile(&replay_file, file);
+	Stream_ReadonlyBuffered(&replay_stream, &replay_file, replay_buffer, sizeof(replay_buffer));
+
+	UInt8 header[6];
+	res = Stream_Read(&replay_stream, header, sizeof(header));
+	if (res || Stream_GetU32_BE(&header[0]) != NET_RECORD_MAGIC || Stream_GetU16_BE(&header[4]) != NET_RECORD_VERSION) {
+		ReplayConnection_Fail("Not a supported replay file"); return;
+	}
+
+	replay_elapsedMs = 0.0;
+	ReplayConnection_ReadNext();
+}
+
+static void ReplayConnection_Tick(struct ScheduledTask* task) {
+	if (ServerConnection_Disconnected) return;
+	replay_elapsedMs += task->Interval * 1000.0 * ServerConnection_ReplaySpeed;
+	Net_TickBytesRead = 0; Net_TickPacketsRead = 0;
+
+	Game_BeginBlockUpdates();
+	while (replay_hasPacket && replay_packetTime <= replay_elapsedMs) {
+		UInt8 opcode = replay_packet[0];
+		if (opcode >= OPCODE_COUNT || !Net_Handlers[opcode] || Net_PacketSizes[opcode] != replay_packetSize) {
+			ReplayConnection_Fail("Replay contains an invalid packet"); break;
+		}
+
+		net_lastOpcode = opcode;
+		Net_HandlePacket(replay_packet, replay_packetSize);
+		if (ServerConnection_Disconnected) break;
+
+		Net_TickBytesRead += replay_packetSize;
+		Net_TickPacketsRead++;
+		ReplayConnection_ReadNext();
+	}
+	Game_EndBlockUpdates();
+	if (ServerConnection_Disconnected) return;
+
+	if ((net_ticks % 3) == 0) {
+		ServerConnection_CheckAsyncResources();
+		Handlers_Tick();
+	}
+	net_ticks++;
+}
+
+void ServerConnection_InitReplay(void) {
+	ServerConnection_InitMultiplayer();
+	net_replaying = true;
+	ServerConnection_BeginConnect = ReplayConnection_BeginConnect;
+	ServerConnection_Tick         = ReplayConnection_Tick;
+}
+
+
 static void MPConnection_OnNewMap(void) {
 	if (ServerConnection_IsSinglePlayer) return;
 	/* wipe all existing entity states */
@@ -527,7 +981,20 @@ static void ServerConnection_Free(void) {
 	} else {
 		if (ServerConnection_Disconnected) return;
 		Event_UnregisterBlock(&UserEvents_BlockChanged, NULL, MPConnection_BlockChanged);
-		Socket_Close(net_socket);
+		if (net_replaying) {
+			if (replay_file.Meta.File) replay_file.Close(&replay_file);
+			replay_hasPacket = false;
+		} else if (ServerConnection_UseLocalServer) {
+			LocalServer_Stop();
+		} else {
+			Socket_Close(net_socket);
+		}
+		MPConnection_StopRecording();
+		Mem_Free(&net_readBuffer);
+		net_readCount = 0;
+		Mem_Free(&net_sendQueue);
+		net_sendCapacity = 0; net_sendCount = 0;
+		net_hasPendingPos = false; Net_SendQueueDepth = 0;
 		ServerConnection_Disconnected = true;
 	}
 }
@@ -67,11 +67,41 @@ void ServerConnection_RetrieveTexturePack(STRING_PURE String* url);
 void ServerConnection_DownloadTexturePack(STRING_PURE String* url);
 void ServerConnection_InitSingleplayer(void);
 void ServerConnection_InitMultiplayer(void);
+/* Path to a file of packets recorded with the net-recordpackets option, which are replayed instead of connecting. */
+extern String ServerConnection_ReplayPath;
+/* Multiplier for how fast recorded packets are replayed. (e.g. 2 is twice as fast as recorded) */
+Real32 ServerConnection_ReplaySpeed;
+void ServerConnection_InitReplay(void);
+/* Whether to connect to a simulated server running inside the client, instead of over a socket. */
+bool ServerConnection_UseLocalServer;
 void ServerConnection_MakeComponent(struct IGameComponent* comp);
 
+/* Largest size a packet can be. (BulkBlockUpdate is 1282 bytes) */
+#define NET_MAX_PACKET_SIZE 1282
+/* Number of bytes and packets received from the server in the last network tick. */
+UInt32 Net_TickBytesRead, Net_TickPacketsRead;
+/* Largest size a packet sent by the client can be. (Handshake is 131 bytes) */
+#define NET_MAX_SEND_SIZE 131
+/* Number of packets waiting to be sent to the server. */
+UInt32 Net_SendQueueDepth;
+/* Smoothed time between a packet being queued and it being fully written to the socket. */
+Real32 Net_SendLatencyMs;
+/* Number of position updates replaced by a newer position before they were sent. */
+UInt32 Net_PositionsCoalesced;
+
+/* Whether per-opcode counts and handler timings are being collected. */
+bool NetStats_Enabled;
+void NetStats_Reset(void);
+/* Prints the opcodes that took the most total handler time to chat. */
+void NetStats_Print(void);
+/* Writes counts, timings and latency histogram for every opcode to a CSV file. */
+ReturnCode NetStats_Export(STRING_PURE String* path);
+
 typedef void (*Net_Handler)(UInt8* data);
 UInt16 Net_PacketSizes[OPCODE_COUNT];
 Net_Handler Net_Handlers[OPCODE_COUNT];
 void Net_Set(UInt8 opcode, Net_Handler handler, UInt16 size);
+/* Queues the packet(s) written to ServerConnection_WriteBuffer, and sends as much of the queue as possible. */
+/* NOTE: Only one packet should be written per call, as position packets are handled separately. */
 void Net_SendPacket(void);
 #endif
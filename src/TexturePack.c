@@ -289,7 +289,7 @@ static void EntryList_Make(struct EntryList* list, STRING_PURE const UChar* fold
 #define TEXCACHE_FOLDER "texturecache"
 /* Because I didn't store milliseconds in original C# client */
 #define TEXCACHE_TICKS_PER_MS 10000LL
-struct EntryList cache_accepted, cache_denied, cache_eTags, cache_lastModified;
+struct EntryList cache_accepted, cache_denied, cache_eTags, cache_lastModified, cache_maxAges;
 
 #define TexCache_InitAndMakePath(url) \
 UChar pathBuffer[String_BufferSize(FILENAME_SIZE)]; \
@@ -306,6 +306,7 @@ void TextureCache_Init(void) {
 	EntryList_Make(&cache_denied,       TEXCACHE_FOLDER, "deniedurls.txt");
 	EntryList_Make(&cache_eTags,        TEXCACHE_FOLDER, "etags.txt");
 	EntryList_Make(&cache_lastModified, TEXCACHE_FOLDER, "lastmodified.txt");
+	EntryList_Make(&cache_maxAges,      TEXCACHE_FOLDER, "maxages.txt");
 }
 
 bool TextureCache_HasAccepted(STRING_PURE String* url) { return EntryList_Has(&cache_accepted, url); }
@@ -373,20 +374,71 @@ void TextureCache_GetETag(STRING_PURE String* url, STRING_PURE String* etag) {
 	TexturePack_GetFromTags(url, etag, &cache_eTags);
 }
 
-void TextureCache_AddData(STRING_PURE String* url, UInt8* data, UInt32 length) {
+Int32 TextureCache_GetMaxAge(STRING_PURE String* url) {
+	UChar entryBuffer[String_BufferSize(STRING_SIZE)];
+	String entry = String_InitAndClearArray(entryBuffer);
+	TexturePack_GetFromTags(url, &entry, &cache_maxAges);
+
+	Int32 maxAge;
+	return entry.length && Convert_TryParseInt32(&entry, &maxAge) ? maxAge : -1;
+}
+
+bool TextureCache_IsFresh(STRING_PURE String* url, Int64 maxAgeMs) {
+	String path; TexCache_InitAndMakePath(url);
+	DateTime modified, now;
+	/* Modified time of the file is when the data was last downloaded or revalidated */
+	if (File_GetModifiedTime(&path, &modified)) return false;
+
+	DateTime_CurrentUTC(&now);
+	Int64 age = DateTime_MsBetween(&modified, &now);
+	return age >= 0 && age < maxAgeMs;
+}
+
+ReturnCode TextureCache_LoadData(STRING_PURE String* url, void** data, UInt32* length) {
+	String path; TexCache_InitAndMakePath(url);
+	ReturnCode res;
+	*data = NULL; *length = 0;
+
+	void* file; res = File_Open(&file, &path);
+	if (res) return res;
+	struct Stream stream; Stream_FromFile(&stream, file);
+	{
+		res = stream.Length(&stream, length);
+		if (!res && !(*length)) res = ReturnCode_FileNotFound;
+
+		if (!res) {
+			*data = Mem_Alloc(*length, sizeof(UInt8), "cached data");
+			res   = Stream_Read(&stream, *data, *length);
+			if (res) Mem_Free(data);
+		}
+	}
+	ReturnCode closeRes = stream.Close(&stream);
+	return res ? res : closeRes;
+}
+
+ReturnCode TextureCache_SaveData(STRING_PURE String* url, UInt8* data, UInt32 length) {
 	String path; TexCache_InitAndMakePath(url);
 	ReturnCode res;
-	if (!Utils_EnsureDirectory(TEXCACHE_FOLDER)) return;
+
+	String dir = String_FromConst(TEXCACHE_FOLDER);
+	if (!Directory_Exists(&dir)) {
+		res = Directory_Create(&dir);
+		if (res) return res;
+	}
 
 	void* file; res = File_Create(&file, &path);
-	if (res) { Chat_LogError(res, "creating cache for", url); return; }
+	if (res) return res;
 	struct Stream stream; Stream_FromFile(&stream, file);
 	{
 		res = Stream_Write(&stream, data, length);
-		if (res) { Chat_LogError(res, "saving data for", url); }
 	}
-	res = stream.Close(&stream);
-	if (res) { Chat_LogError(res, "closing cache for", url); }
+	ReturnCode closeRes = stream.Close(&stream);
+	return res ? res : closeRes;
+}
+
+void TextureCache_AddData(STRING_PURE String* url, UInt8* data, UInt32 length) {
+	ReturnCode res = TextureCache_SaveData(url, data, length);
+	if (res) { Chat_LogError(res, "saving cache for", url); }
 }
 
 void TextureCache_AddToTags(STRING_PURE String* url, STRING_PURE String* data, struct EntryList* list) {
@@ -421,6 +473,13 @@ void TextureCache_AddLastModified(STRING_PURE String* url, DateTime* lastModifie
 	TextureCache_AddToTags(url, &data, &cache_lastModified);
 }
 
+void TextureCache_AddMaxAge(STRING_PURE String* url, Int32 maxAge) {
+	UChar dataBuffer[String_BufferSize(STRING_SIZE)];
+	String data = String_InitAndClearArray(dataBuffer);
+	String_AppendInt32(&data, maxAge);
+	TextureCache_AddToTags(url, &data, &cache_maxAges);
+}
+
 
 /*########################################################################################################################*
 *-------------------------------------------------------TexturePack-------------------------------------------------------*
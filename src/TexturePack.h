@@ -33,9 +33,18 @@ bool TextureCache_HasUrl(STRING_PURE String* url);
 bool TextureCache_GetStream(STRING_PURE String* url, struct Stream* stream);
 void TextureCache_GetLastModified(STRING_PURE String* url, DateTime* time);
 void TextureCache_GetETag(STRING_PURE String* url, STRING_PURE String* etag);
+/* Returns the max-age in seconds the server gave for the given url, or -1 if none. */
+Int32 TextureCache_GetMaxAge(STRING_PURE String* url);
+/* Whether the cached data for the given url was written or revalidated less than maxAgeMs ago. Safe to call from any thread. */
+bool TextureCache_IsFresh(STRING_PURE String* url, Int64 maxAgeMs);
+/* Reads the cached data for the given url. Safe to call from any thread, as no errors are logged. */
+ReturnCode TextureCache_LoadData(STRING_PURE String* url, void** data, UInt32* length);
+/* Writes the data for the given url to the cache. Safe to call from any thread, as no errors are logged. */
+ReturnCode TextureCache_SaveData(STRING_PURE String* url, UInt8* data, UInt32 length);
 void TextureCache_AddData(STRING_PURE String* url, UInt8* data, UInt32 length);
 void TextureCache_AddETag(STRING_PURE String* url, STRING_PURE String* etag);
 void TextureCache_AddLastModified(STRING_PURE String* url, DateTime* lastModified);
+void TextureCache_AddMaxAge(STRING_PURE String* url, Int32 maxAge);
 
 void TexturePack_ExtractZip_File(STRING_PURE String* filename);
 void TexturePack_ExtractDefault(void);
@@ -327,3 +327,64 @@ void FrustumCulling_CalcFrustumEquations(struct Matrix*  projection, struct Matr
 	frustum43 = clip[15] - clip[14];
 	FrustumCulling_Normalise(&frustum40, &frustum41, &frustum42, &frustum43);
 }
+
+static Int32 FrustumCulling_ClassifyPlane(Real32 a, Real32 b, Real32 c, Real32 d, Vector3* centre, Vector3* half) {
+	Real32 dist   = a * centre->X + b * centre->Y + c * centre->Z + d;
+	Real32 radius = Math_AbsF(a) * half->X + Math_AbsF(b) * half->Y + Math_AbsF(c) * half->Z;
+
+	if (dist <= -radius) return FRUSTUM_OUTSIDE;
+	return dist >= radius ? FRUSTUM_INSIDE : FRUSTUM_INTERSECTS;
+}
+
+Int32 FrustumCulling_ClassifyBox(Vector3* centre, Vector3* half) {
+	Int32 result = FRUSTUM_INSIDE, plane;
+	plane = FrustumCulling_ClassifyPlane(frustum00, frustum01, frustum02, frustum03, centre, half);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_ClassifyPlane(frustum10, frustum11, frustum12, frustum13, centre, half);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_ClassifyPlane(frustum20, frustum21, frustum22, frustum23, centre, half);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_ClassifyPlane(frustum30, frustum31, frustum32, frustum33, centre, half);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+
+	plane = FrustumCulling_ClassifyPlane(frustum40, frustum41, frustum42, frustum43, centre, half);
+	if (plane == FRUSTUM_OUTSIDE) return FRUSTUM_OUTSIDE;
+	result = min(result, plane);
+	/* Don't test NEAR plane, it's pointless */
+	return result;
+}
+
+#define FrustumCulling_BoxPlane(i) \
+(p[i][0] * x + p[i][1] * y + p[i][2] * z + p[i][3] > -(n[i][0] * hX + n[i][1] * hY + n[i][2] * hZ))
+
+void FrustumCulling_BoxesInFrustum(struct FrustumBoxes* boxes, Int32 offset, Int32 count, bool* visible) {
+	Real32* centreX = boxes->CentreX + offset; Real32* halfX = boxes->HalfX + offset;
+	Real32* centreY = boxes->CentreY + offset; Real32* halfY = boxes->HalfY + offset;
+	Real32* centreZ = boxes->CentreZ + offset; Real32* halfZ = boxes->HalfZ + offset;
+	Real32 p[5][4] = {
+		{ frustum00, frustum01, frustum02, frustum03 }, { frustum10, frustum11, frustum12, frustum13 },
+		{ frustum20, frustum21, frustum22, frustum23 }, { frustum30, frustum31, frustum32, frustum33 },
+		{ frustum40, frustum41, frustum42, frustum43 },
+	};
+	Real32 n[5][3];
+	Int32 i, j;
+	for (i = 0; i < 5; i++) {
+		for (j = 0; j < 3; j++) { n[i][j] = Math_AbsF(p[i][j]); }
+	}
+
+	/* Planes are copied into locals and the loop has no branches, so compilers can test several boxes at once with SIMD */
+	for (i = 0; i < count; i++) {
+		Real32 x  = centreX[i], y  = centreY[i], z  = centreZ[i];
+		Real32 hX = halfX[i],   hY = halfY[i],   hZ = halfZ[i];
+
+		visible[i] = FrustumCulling_BoxPlane(0) & FrustumCulling_BoxPlane(1)
+			& FrustumCulling_BoxPlane(2) & FrustumCulling_BoxPlane(3) & FrustumCulling_BoxPlane(4);
+	}
+}
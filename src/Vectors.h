@@ -84,4 +84,12 @@ void Matrix_LookRot(struct Matrix* result, Vector3 pos, Vector2 rot);
 
 bool FrustumCulling_SphereInFrustum(Real32 x, Real32 y, Real32 z, Real32 radius);
 void FrustumCulling_CalcFrustumEquations(struct Matrix* projection, struct Matrix* modelView);
+
+enum FRUSTUM_RESULT { FRUSTUM_OUTSIDE, FRUSTUM_INTERSECTS, FRUSTUM_INSIDE };
+/* Axis aligned boxes stored as separate arrays, so that many can be tested against the frustum at once. */
+struct FrustumBoxes { Real32 *CentreX, *CentreY, *CentreZ, *HalfX, *HalfY, *HalfZ; };
+/* Returns whether the box is entirely outside, partially inside, or entirely inside the frustum. */
+Int32 FrustumCulling_ClassifyBox(Vector3* centre, Vector3* half);
+/* Sets visible[i] to whether box (offset + i) is at least partially inside the frustum. */
+void FrustumCulling_BoxesInFrustum(struct FrustumBoxes* boxes, Int32 offset, Int32 count, bool* visible);
 #endif
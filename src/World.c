@@ -9,12 +9,15 @@
 #include "ExtMath.h"
 #include "Physics.h"
 #include "Game.h"
+#include "BlockPhysics.h"
 
 void World_Reset(void) {
+	Physics_Sync();
 	Mem_Free(&World_Blocks);
 	World_Width = 0; World_Height = 0; World_Length = 0;
 	World_MaxX = 0;  World_MaxY = 0;   World_MaxZ = 0;
 	World_BlocksSize = 0;
+	World_Streaming  = false;
 	WorldEnv_Reset();
 
 	Random rnd;
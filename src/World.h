@@ -17,6 +17,8 @@ Int32 World_Width, World_Height, World_Length;
 Int32 World_MaxX, World_MaxY, World_MaxZ;
 Int32 World_OneY;
 UInt8 World_Uuid[16];
+/* Whether the rest of World_Blocks is still being received from the server. */
+bool World_Streaming;
 extern String World_TextureUrl;
 
 void World_Reset(void);